@@ -77,6 +77,10 @@ uint8_t ICACHE_FLASH_ATTR buffer_write(Buffer_T buffer, Buffer_Type_T data) {
 	if (!buffer) {
 		return 0;
 	}
+	if (buffer->skip) {
+		buffer->skip--;
+		return 1;
+	}
 	if (buffer->write_it < buffer->capacity) {
 		buffer->data[buffer->write_it++] = data;
 		return 1;
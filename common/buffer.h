@@ -31,6 +31,8 @@ struct Buffer_T {
 	uint16_t write_it;
 	uint16_t read_it;
 	uint16_t overflow;
+	/*bytes to drop before writing, used to print a window of a stream*/
+	uint16_t skip;
 	Buffer_Type_T* data;
 	Buffer_Type_T store[0];
 };
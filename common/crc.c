@@ -15,9 +15,24 @@
 
 #include <c_types.h>
 #include "crc.h"
+#include "crc_table.h"
+#include "array_size.h"
+
+typedef struct {
+	uint32_t poly;
+	const uint32_t* table;
+	uint8_t slices;
+} Crc_Table_T;
+
+/*polys with remainders in flash, slices are the input bytes a table covers*/
+static const Crc_Table_T crc_tables[] = {
+	{0x1EDC6F41, crc_table_1edc6f41, 1},
+	{0x741B8CD7, crc_table_741b8cd7, 4}
+};
 
 Crc_T* ICACHE_FLASH_ATTR crc_init(Crc_T* crc, uint64_t poly, uint64_t init_value) {
 	uint8_t len;
+	uint8_t i;
 	if (!crc || !poly) {
 		return NULL;
 	}
@@ -29,15 +44,21 @@ Crc_T* ICACHE_FLASH_ATTR crc_init(Crc_T* crc, uint64_t poly, uint64_t init_value
 	crc->power = len;
 	crc->init_value = init_value;
 	crc->last_value = crc->init_value;
+	crc->table = NULL;
+	crc->slices = 0;
+	for (i = 0; i < ARRAY_SIZE(crc_tables); i++) {
+		if ((crc_tables[i].poly == poly) && !(init_value >> len)) {
+			crc->table = crc_tables[i].table;
+			crc->slices = crc_tables[i].slices;
+			break;
+		}
+	}
 	return crc;
 }
 
-uint64_t ICACHE_FLASH_ATTR crc_calculate(Crc_T* crc, uint64_t value) {
+static uint64_t ICACHE_FLASH_ATTR crc_calculate_bits(Crc_T* crc, uint64_t value) {
 	uint64_t poly;
 	uint8_t i;
-	if (!crc) {
-		return 0;
-	}
 	poly = crc->poly << (crc->power - 1);
 	value <<= crc->power;
 	value |= crc->last_value;
@@ -51,6 +72,28 @@ uint64_t ICACHE_FLASH_ATTR crc_calculate(Crc_T* crc, uint64_t value) {
 	return crc->last_value;
 }
 
+/*the remainder of a value is independent of the previous one, so each input*/
+/*byte is looked up on its own and the results are xored into the state.*/
+/*input bits from power on are never reduced and stick above 2 * power*/
+uint64_t ICACHE_FLASH_ATTR crc_calculate(Crc_T* crc, uint64_t value) {
+	uint32_t rem = 0;
+	uint8_t i;
+	if (!crc) {
+		return 0;
+	}
+	if (!crc->table || (value >> (crc->slices * 8))) {
+		return crc_calculate_bits(crc, value);
+	}
+	for (i = 0; i < crc->slices; i++) {
+		rem ^= crc->table[(i << 8) | ((value >> (i * 8)) & 0xFF)];
+	}
+	if (value >> crc->power) {
+		crc->last_value |= (value << crc->power) & ~(((uint64_t)1 << (crc->power * 2)) - 1);
+	}
+	crc->last_value ^= rem;
+	return crc->last_value;
+}
+
 void ICACHE_FLASH_ATTR crc_reset(Crc_T* crc) {
 	if (!crc) {
 		return;
@@ -70,8 +113,26 @@ uint64_t ICACHE_FLASH_ATTR crc_check(Crc_T* crc, const uint8_t* buffer, uint16_t
 	if (!crc || !buffer || !length) {
 		return 0;
 	}
+	if (crc->table) {
+		for (i = 0; i < length; i++) {
+			crc->last_value ^= crc->table[buffer[i]];
+		}
+		return crc_last(crc);
+	}
 	for (i = 0; i < length; i++) {
 		crc_calculate(crc, buffer[i]);
 	}
 	return crc_last(crc);
 }
+
+/*word aligned buffers, e.g. read from flash, use all slices of the table*/
+uint64_t ICACHE_FLASH_ATTR crc_check_words(Crc_T* crc, const uint32_t* buffer, uint16_t count) {
+	uint16_t i;
+	if (!crc || !buffer || !count) {
+		return 0;
+	}
+	for (i = 0; i < count; i++) {
+		crc_calculate(crc, buffer[i]);
+	}
+	return crc_last(crc);
+}
@@ -22,6 +22,8 @@ typedef struct {
 	uint64_t poly;
 	uint64_t last_value;
 	uint64_t init_value;
+	const uint32_t* table;
+	uint8_t slices;
 	uint8_t power;
 } Crc_T;
 
@@ -30,5 +32,6 @@ uint64_t crc_calculate(Crc_T* crc, uint64_t value);
 void crc_reset(Crc_T* crc);
 uint64_t crc_last(Crc_T* crc);
 uint64_t crc_check(Crc_T* crc, const uint8_t* buffer, uint16_t length);
+uint64_t crc_check_words(Crc_T* crc, const uint32_t* buffer, uint16_t count);
 
 #endif
@@ -0,0 +1,240 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <inttypes.h>
+#include <c_types.h>
+#include "crc_table.h"
+
+/*remainders of (byte << (8 * slice)) * x^28 mod 0x1EDC6F41, 1 slice(s)*/
+const uint32_t crc_table_1edc6f41[256] ICACHE_RODATA_ATTR __attribute__((aligned(4))) = {
+	0x00000000, 0x0EDC6F41, 0x0364B1C3, 0x0DB8DE82, 0x06C96386, 0x08150CC7,
+	0x05ADD245, 0x0B71BD04, 0x0D92C70C, 0x034EA84D, 0x0EF676CF, 0x002A198E,
+	0x0B5BA48A, 0x0587CBCB, 0x083F1549, 0x06E37A08, 0x05F9E159, 0x0B258E18,
+	0x069D509A, 0x08413FDB, 0x033082DF, 0x0DECED9E, 0x0054331C, 0x0E885C5D,
+	0x086B2655, 0x06B74914, 0x0B0F9796, 0x05D3F8D7, 0x0EA245D3, 0x007E2A92,
+	0x0DC6F410, 0x031A9B51, 0x0BF3C2B2, 0x052FADF3, 0x08977371, 0x064B1C30,
+	0x0D3AA134, 0x03E6CE75, 0x0E5E10F7, 0x00827FB6, 0x066105BE, 0x08BD6AFF,
+	0x0505B47D, 0x0BD9DB3C, 0x00A86638, 0x0E740979, 0x03CCD7FB, 0x0D10B8BA,
+	0x0E0A23EB, 0x00D64CAA, 0x0D6E9228, 0x03B2FD69, 0x08C3406D, 0x061F2F2C,
+	0x0BA7F1AE, 0x057B9EEF, 0x0398E4E7, 0x0D448BA6, 0x00FC5524, 0x0E203A65,
+	0x05518761, 0x0B8DE820, 0x063536A2, 0x08E959E3, 0x093BEA25, 0x07E78564,
+	0x0A5F5BE6, 0x048334A7, 0x0FF289A3, 0x012EE6E2, 0x0C963860, 0x024A5721,
+	0x04A92D29, 0x0A754268, 0x07CD9CEA, 0x0911F3AB, 0x02604EAF, 0x0CBC21EE,
+	0x0104FF6C, 0x0FD8902D, 0x0CC20B7C, 0x021E643D, 0x0FA6BABF, 0x017AD5FE,
+	0x0A0B68FA, 0x04D707BB, 0x096FD939, 0x07B3B678, 0x0150CC70, 0x0F8CA331,
+	0x02347DB3, 0x0CE812F2, 0x0799AFF6, 0x0945C0B7, 0x04FD1E35, 0x0A217174,
+	0x02C82897, 0x0C1447D6, 0x01AC9954, 0x0F70F615, 0x04014B11, 0x0ADD2450,
+	0x0765FAD2, 0x09B99593, 0x0F5AEF9B, 0x018680DA, 0x0C3E5E58, 0x02E23119,
+	0x09938C1D, 0x074FE35C, 0x0AF73DDE, 0x042B529F, 0x0731C9CE, 0x09EDA68F,
+	0x0455780D, 0x0A89174C, 0x01F8AA48, 0x0F24C509, 0x029C1B8B, 0x0C4074CA,
+	0x0AA30EC2, 0x047F6183, 0x09C7BF01, 0x071BD040, 0x0C6A6D44, 0x02B60205,
+	0x0F0EDC87, 0x01D2B3C6, 0x0CABBB0B, 0x0277D44A, 0x0FCF0AC8, 0x01136589,
+	0x0A62D88D, 0x04BEB7CC, 0x0906694E, 0x07DA060F, 0x01397C07, 0x0FE51346,
+	0x025DCDC4, 0x0C81A285, 0x07F01F81, 0x092C70C0, 0x0494AE42, 0x0A48C103,
+	0x09525A52, 0x078E3513, 0x0A36EB91, 0x04EA84D0, 0x0F9B39D4, 0x01475695,
+	0x0CFF8817, 0x0223E756, 0x04C09D5E, 0x0A1CF21F, 0x07A42C9D, 0x097843DC,
+	0x0209FED8, 0x0CD59199, 0x016D4F1B, 0x0FB1205A, 0x075879B9, 0x098416F8,
+	0x043CC87A, 0x0AE0A73B, 0x01911A3F, 0x0F4D757E, 0x02F5ABFC, 0x0C29C4BD,
+	0x0ACABEB5, 0x0416D1F4, 0x09AE0F76, 0x07726037, 0x0C03DD33, 0x02DFB272,
+	0x0F676CF0, 0x01BB03B1, 0x02A198E0, 0x0C7DF7A1, 0x01C52923, 0x0F194662,
+	0x0468FB66, 0x0AB49427, 0x070C4AA5, 0x09D025E4, 0x0F335FEC, 0x01EF30AD,
+	0x0C57EE2F, 0x028B816E, 0x09FA3C6A, 0x0726532B, 0x0A9E8DA9, 0x0442E2E8,
+	0x0590512E, 0x0B4C3E6F, 0x06F4E0ED, 0x08288FAC, 0x035932A8, 0x0D855DE9,
+	0x003D836B, 0x0EE1EC2A, 0x08029622, 0x06DEF963, 0x0B6627E1, 0x05BA48A0,
+	0x0ECBF5A4, 0x00179AE5, 0x0DAF4467, 0x03732B26, 0x0069B077, 0x0EB5DF36,
+	0x030D01B4, 0x0DD16EF5, 0x06A0D3F1, 0x087CBCB0, 0x05C46232, 0x0B180D73,
+	0x0DFB777B, 0x0327183A, 0x0E9FC6B8, 0x0043A9F9, 0x0B3214FD, 0x05EE7BBC,
+	0x0856A53E, 0x068ACA7F, 0x0E63939C, 0x00BFFCDD, 0x0D07225F, 0x03DB4D1E,
+	0x08AAF01A, 0x06769F5B, 0x0BCE41D9, 0x05122E98, 0x03F15490, 0x0D2D3BD1,
+	0x0095E553, 0x0E498A12, 0x05383716, 0x0BE45857, 0x065C86D5, 0x0880E994,
+	0x0B9A72C5, 0x05461D84, 0x08FEC306, 0x0622AC47, 0x0D531143, 0x038F7E02,
+	0x0E37A080, 0x00EBCFC1, 0x0608B5C9, 0x08D4DA88, 0x056C040A, 0x0BB06B4B,
+	0x00C1D64F, 0x0E1DB90E, 0x03A5678C, 0x0D7908CD,
+};
+
+/*remainders of (byte << (8 * slice)) * x^30 mod 0x741B8CD7, 4 slice(s)*/
+const uint32_t crc_table_741b8cd7[4 * 256] ICACHE_RODATA_ATTR __attribute__((aligned(4))) = {
+	0x00000000, 0x341B8CD7, 0x1C2C9579, 0x283719AE, 0x38592AF2, 0x0C42A625,
+	0x2475BF8B, 0x106E335C, 0x04A9D933, 0x30B255E4, 0x18854C4A, 0x2C9EC09D,
+	0x3CF0F3C1, 0x08EB7F16, 0x20DC66B8, 0x14C7EA6F, 0x0953B266, 0x3D483EB1,
+	0x157F271F, 0x2164ABC8, 0x310A9894, 0x05111443, 0x2D260DED, 0x193D813A,
+	0x0DFA6B55, 0x39E1E782, 0x11D6FE2C, 0x25CD72FB, 0x35A341A7, 0x01B8CD70,
+	0x298FD4DE, 0x1D945809, 0x12A764CC, 0x26BCE81B, 0x0E8BF1B5, 0x3A907D62,
+	0x2AFE4E3E, 0x1EE5C2E9, 0x36D2DB47, 0x02C95790, 0x160EBDFF, 0x22153128,
+	0x0A222886, 0x3E39A451, 0x2E57970D, 0x1A4C1BDA, 0x327B0274, 0x06608EA3,
+	0x1BF4D6AA, 0x2FEF5A7D, 0x07D843D3, 0x33C3CF04, 0x23ADFC58, 0x17B6708F,
+	0x3F816921, 0x0B9AE5F6, 0x1F5D0F99, 0x2B46834E, 0x03719AE0, 0x376A1637,
+	0x2704256B, 0x131FA9BC, 0x3B28B012, 0x0F333CC5, 0x254EC998, 0x1155454F,
+	0x39625CE1, 0x0D79D036, 0x1D17E36A, 0x290C6FBD, 0x013B7613, 0x3520FAC4,
+	0x21E710AB, 0x15FC9C7C, 0x3DCB85D2, 0x09D00905, 0x19BE3A59, 0x2DA5B68E,
+	0x0592AF20, 0x318923F7, 0x2C1D7BFE, 0x1806F729, 0x3031EE87, 0x042A6250,
+	0x1444510C, 0x205FDDDB, 0x0868C475, 0x3C7348A2, 0x28B4A2CD, 0x1CAF2E1A,
+	0x349837B4, 0x0083BB63, 0x10ED883F, 0x24F604E8, 0x0CC11D46, 0x38DA9191,
+	0x37E9AD54, 0x03F22183, 0x2BC5382D, 0x1FDEB4FA, 0x0FB087A6, 0x3BAB0B71,
+	0x139C12DF, 0x27879E08, 0x33407467, 0x075BF8B0, 0x2F6CE11E, 0x1B776DC9,
+	0x0B195E95, 0x3F02D242, 0x1735CBEC, 0x232E473B, 0x3EBA1F32, 0x0AA193E5,
+	0x22968A4B, 0x168D069C, 0x06E335C0, 0x32F8B917, 0x1ACFA0B9, 0x2ED42C6E,
+	0x3A13C601, 0x0E084AD6, 0x263F5378, 0x1224DFAF, 0x024AECF3, 0x36516024,
+	0x1E66798A, 0x2A7DF55D, 0x3E861FE7, 0x0A9D9330, 0x22AA8A9E, 0x16B10649,
+	0x06DF3515, 0x32C4B9C2, 0x1AF3A06C, 0x2EE82CBB, 0x3A2FC6D4, 0x0E344A03,
+	0x260353AD, 0x1218DF7A, 0x0276EC26, 0x366D60F1, 0x1E5A795F, 0x2A41F588,
+	0x37D5AD81, 0x03CE2156, 0x2BF938F8, 0x1FE2B42F, 0x0F8C8773, 0x3B970BA4,
+	0x13A0120A, 0x27BB9EDD, 0x337C74B2, 0x0767F865, 0x2F50E1CB, 0x1B4B6D1C,
+	0x0B255E40, 0x3F3ED297, 0x1709CB39, 0x231247EE, 0x2C217B2B, 0x183AF7FC,
+	0x300DEE52, 0x04166285, 0x147851D9, 0x2063DD0E, 0x0854C4A0, 0x3C4F4877,
+	0x2888A218, 0x1C932ECF, 0x34A43761, 0x00BFBBB6, 0x10D188EA, 0x24CA043D,
+	0x0CFD1D93, 0x38E69144, 0x2572C94D, 0x1169459A, 0x395E5C34, 0x0D45D0E3,
+	0x1D2BE3BF, 0x29306F68, 0x010776C6, 0x351CFA11, 0x21DB107E, 0x15C09CA9,
+	0x3DF78507, 0x09EC09D0, 0x19823A8C, 0x2D99B65B, 0x05AEAFF5, 0x31B52322,
+	0x1BC8D67F, 0x2FD35AA8, 0x07E44306, 0x33FFCFD1, 0x2391FC8D, 0x178A705A,
+	0x3FBD69F4, 0x0BA6E523, 0x1F610F4C, 0x2B7A839B, 0x034D9A35, 0x375616E2,
+	0x273825BE, 0x1323A969, 0x3B14B0C7, 0x0F0F3C10, 0x129B6419, 0x2680E8CE,
+	0x0EB7F160, 0x3AAC7DB7, 0x2AC24EEB, 0x1ED9C23C, 0x36EEDB92, 0x02F55745,
+	0x1632BD2A, 0x222931FD, 0x0A1E2853, 0x3E05A484, 0x2E6B97D8, 0x1A701B0F,
+	0x324702A1, 0x065C8E76, 0x096FB2B3, 0x3D743E64, 0x154327CA, 0x2158AB1D,
+	0x31369841, 0x052D1496, 0x2D1A0D38, 0x190181EF, 0x0DC66B80, 0x39DDE757,
+	0x11EAFEF9, 0x25F1722E, 0x359F4172, 0x0184CDA5, 0x29B3D40B, 0x1DA858DC,
+	0x003C00D5, 0x34278C02, 0x1C1095AC, 0x280B197B, 0x38652A27, 0x0C7EA6F0,
+	0x2449BF5E, 0x10523389, 0x0495D9E6, 0x308E5531, 0x18B94C9F, 0x2CA2C048,
+	0x3CCCF314, 0x08D77FC3, 0x20E0666D, 0x14FBEABA, 0x00000000, 0x0917B319,
+	0x122F6632, 0x1B38D52B, 0x245ECC64, 0x2D497F7D, 0x3671AA56, 0x3F66194F,
+	0x3CA6141F, 0x35B1A706, 0x2E89722D, 0x279EC134, 0x18F8D87B, 0x11EF6B62,
+	0x0AD7BE49, 0x03C00D50, 0x0D57A4E9, 0x044017F0, 0x1F78C2DB, 0x166F71C2,
+	0x2909688D, 0x201EDB94, 0x3B260EBF, 0x3231BDA6, 0x31F1B0F6, 0x38E603EF,
+	0x23DED6C4, 0x2AC965DD, 0x15AF7C92, 0x1CB8CF8B, 0x07801AA0, 0x0E97A9B9,
+	0x1AAF49D2, 0x13B8FACB, 0x08802FE0, 0x01979CF9, 0x3EF185B6, 0x37E636AF,
+	0x2CDEE384, 0x25C9509D, 0x26095DCD, 0x2F1EEED4, 0x34263BFF, 0x3D3188E6,
+	0x025791A9, 0x0B4022B0, 0x1078F79B, 0x196F4482, 0x17F8ED3B, 0x1EEF5E22,
+	0x05D78B09, 0x0CC03810, 0x33A6215F, 0x3AB19246, 0x2189476D, 0x289EF474,
+	0x2B5EF924, 0x22494A3D, 0x39719F16, 0x30662C0F, 0x0F003540, 0x06178659,
+	0x1D2F5372, 0x1438E06B, 0x355E93A4, 0x3C4920BD, 0x2771F596, 0x2E66468F,
+	0x11005FC0, 0x1817ECD9, 0x032F39F2, 0x0A388AEB, 0x09F887BB, 0x00EF34A2,
+	0x1BD7E189, 0x12C05290, 0x2DA64BDF, 0x24B1F8C6, 0x3F892DED, 0x369E9EF4,
+	0x3809374D, 0x311E8454, 0x2A26517F, 0x2331E266, 0x1C57FB29, 0x15404830,
+	0x0E789D1B, 0x076F2E02, 0x04AF2352, 0x0DB8904B, 0x16804560, 0x1F97F679,
+	0x20F1EF36, 0x29E65C2F, 0x32DE8904, 0x3BC93A1D, 0x2FF1DA76, 0x26E6696F,
+	0x3DDEBC44, 0x34C90F5D, 0x0BAF1612, 0x02B8A50B, 0x19807020, 0x1097C339,
+	0x1357CE69, 0x1A407D70, 0x0178A85B, 0x086F1B42, 0x3709020D, 0x3E1EB114,
+	0x2526643F, 0x2C31D726, 0x22A67E9F, 0x2BB1CD86, 0x308918AD, 0x399EABB4,
+	0x06F8B2FB, 0x0FEF01E2, 0x14D7D4C9, 0x1DC067D0, 0x1E006A80, 0x1717D999,
+	0x0C2F0CB2, 0x0538BFAB, 0x3A5EA6E4, 0x334915FD, 0x2871C0D6, 0x216673CF,
+	0x1EA6AB9F, 0x17B11886, 0x0C89CDAD, 0x059E7EB4, 0x3AF867FB, 0x33EFD4E2,
+	0x28D701C9, 0x21C0B2D0, 0x2200BF80, 0x2B170C99, 0x302FD9B2, 0x39386AAB,
+	0x065E73E4, 0x0F49C0FD, 0x147115D6, 0x1D66A6CF, 0x13F10F76, 0x1AE6BC6F,
+	0x01DE6944, 0x08C9DA5D, 0x37AFC312, 0x3EB8700B, 0x2580A520, 0x2C971639,
+	0x2F571B69, 0x2640A870, 0x3D787D5B, 0x346FCE42, 0x0B09D70D, 0x021E6414,
+	0x1926B13F, 0x10310226, 0x0409E24D, 0x0D1E5154, 0x1626847F, 0x1F313766,
+	0x20572E29, 0x29409D30, 0x3278481B, 0x3B6FFB02, 0x38AFF652, 0x31B8454B,
+	0x2A809060, 0x23972379, 0x1CF13A36, 0x15E6892F, 0x0EDE5C04, 0x07C9EF1D,
+	0x095E46A4, 0x0049F5BD, 0x1B712096, 0x1266938F, 0x2D008AC0, 0x241739D9,
+	0x3F2FECF2, 0x36385FEB, 0x35F852BB, 0x3CEFE1A2, 0x27D73489, 0x2EC08790,
+	0x11A69EDF, 0x18B12DC6, 0x0389F8ED, 0x0A9E4BF4, 0x2BF8383B, 0x22EF8B22,
+	0x39D75E09, 0x30C0ED10, 0x0FA6F45F, 0x06B14746, 0x1D89926D, 0x149E2174,
+	0x175E2C24, 0x1E499F3D, 0x05714A16, 0x0C66F90F, 0x3300E040, 0x3A175359,
+	0x212F8672, 0x2838356B, 0x26AF9CD2, 0x2FB82FCB, 0x3480FAE0, 0x3D9749F9,
+	0x02F150B6, 0x0BE6E3AF, 0x10DE3684, 0x19C9859D, 0x1A0988CD, 0x131E3BD4,
+	0x0826EEFF, 0x01315DE6, 0x3E5744A9, 0x3740F7B0, 0x2C78229B, 0x256F9182,
+	0x315771E9, 0x3840C2F0, 0x237817DB, 0x2A6FA4C2, 0x1509BD8D, 0x1C1E0E94,
+	0x0726DBBF, 0x0E3168A6, 0x0DF165F6, 0x04E6D6EF, 0x1FDE03C4, 0x16C9B0DD,
+	0x29AFA992, 0x20B81A8B, 0x3B80CFA0, 0x32977CB9, 0x3C00D500, 0x35176619,
+	0x2E2FB332, 0x2738002B, 0x185E1964, 0x1149AA7D, 0x0A717F56, 0x0366CC4F,
+	0x00A6C11F, 0x09B17206, 0x1289A72D, 0x1B9E1434, 0x24F80D7B, 0x2DEFBE62,
+	0x36D76B49, 0x3FC0D850, 0x00000000, 0x3D4D573E, 0x0E8122AB, 0x33CC7595,
+	0x1D024556, 0x204F1268, 0x138367FD, 0x2ECE30C3, 0x3A048AAC, 0x0749DD92,
+	0x3485A807, 0x09C8FF39, 0x2706CFFA, 0x1A4B98C4, 0x2987ED51, 0x14CABA6F,
+	0x0012998F, 0x3D5FCEB1, 0x0E93BB24, 0x33DEEC1A, 0x1D10DCD9, 0x205D8BE7,
+	0x1391FE72, 0x2EDCA94C, 0x3A161323, 0x075B441D, 0x34973188, 0x09DA66B6,
+	0x27145675, 0x1A59014B, 0x299574DE, 0x14D823E0, 0x0025331E, 0x3D686420,
+	0x0EA411B5, 0x33E9468B, 0x1D277648, 0x206A2176, 0x13A654E3, 0x2EEB03DD,
+	0x3A21B9B2, 0x076CEE8C, 0x34A09B19, 0x09EDCC27, 0x2723FCE4, 0x1A6EABDA,
+	0x29A2DE4F, 0x14EF8971, 0x0037AA91, 0x3D7AFDAF, 0x0EB6883A, 0x33FBDF04,
+	0x1D35EFC7, 0x2078B8F9, 0x13B4CD6C, 0x2EF99A52, 0x3A33203D, 0x077E7703,
+	0x34B20296, 0x09FF55A8, 0x2731656B, 0x1A7C3255, 0x29B047C0, 0x14FD10FE,
+	0x004A663C, 0x3D073102, 0x0ECB4497, 0x338613A9, 0x1D48236A, 0x20057454,
+	0x13C901C1, 0x2E8456FF, 0x3A4EEC90, 0x0703BBAE, 0x34CFCE3B, 0x09829905,
+	0x274CA9C6, 0x1A01FEF8, 0x29CD8B6D, 0x1480DC53, 0x0058FFB3, 0x3D15A88D,
+	0x0ED9DD18, 0x33948A26, 0x1D5ABAE5, 0x2017EDDB, 0x13DB984E, 0x2E96CF70,
+	0x3A5C751F, 0x07112221, 0x34DD57B4, 0x0990008A, 0x275E3049, 0x1A136777,
+	0x29DF12E2, 0x149245DC, 0x006F5522, 0x3D22021C, 0x0EEE7789, 0x33A320B7,
+	0x1D6D1074, 0x2020474A, 0x13EC32DF, 0x2EA165E1, 0x3A6BDF8E, 0x072688B0,
+	0x34EAFD25, 0x09A7AA1B, 0x27699AD8, 0x1A24CDE6, 0x29E8B873, 0x14A5EF4D,
+	0x007DCCAD, 0x3D309B93, 0x0EFCEE06, 0x33B1B938, 0x1D7F89FB, 0x2032DEC5,
+	0x13FEAB50, 0x2EB3FC6E, 0x3A794601, 0x0734113F, 0x34F864AA, 0x09B53394,
+	0x277B0357, 0x1A365469, 0x29FA21FC, 0x14B776C2, 0x0094CC78, 0x3DD99B46,
+	0x0E15EED3, 0x3358B9ED, 0x1D96892E, 0x20DBDE10, 0x1317AB85, 0x2E5AFCBB,
+	0x3A9046D4, 0x07DD11EA, 0x3411647F, 0x095C3341, 0x27920382, 0x1ADF54BC,
+	0x29132129, 0x145E7617, 0x008655F7, 0x3DCB02C9, 0x0E07775C, 0x334A2062,
+	0x1D8410A1, 0x20C9479F, 0x1305320A, 0x2E486534, 0x3A82DF5B, 0x07CF8865,
+	0x3403FDF0, 0x094EAACE, 0x27809A0D, 0x1ACDCD33, 0x2901B8A6, 0x144CEF98,
+	0x00B1FF66, 0x3DFCA858, 0x0E30DDCD, 0x337D8AF3, 0x1DB3BA30, 0x20FEED0E,
+	0x1332989B, 0x2E7FCFA5, 0x3AB575CA, 0x07F822F4, 0x34345761, 0x0979005F,
+	0x27B7309C, 0x1AFA67A2, 0x29361237, 0x147B4509, 0x00A366E9, 0x3DEE31D7,
+	0x0E224442, 0x336F137C, 0x1DA123BF, 0x20EC7481, 0x13200114, 0x2E6D562A,
+	0x3AA7EC45, 0x07EABB7B, 0x3426CEEE, 0x096B99D0, 0x27A5A913, 0x1AE8FE2D,
+	0x29248BB8, 0x1469DC86, 0x00DEAA44, 0x3D93FD7A, 0x0E5F88EF, 0x3312DFD1,
+	0x1DDCEF12, 0x2091B82C, 0x135DCDB9, 0x2E109A87, 0x3ADA20E8, 0x079777D6,
+	0x345B0243, 0x0916557D, 0x27D865BE, 0x1A953280, 0x29594715, 0x1414102B,
+	0x00CC33CB, 0x3D8164F5, 0x0E4D1160, 0x3300465E, 0x1DCE769D, 0x208321A3,
+	0x134F5436, 0x2E020308, 0x3AC8B967, 0x0785EE59, 0x34499BCC, 0x0904CCF2,
+	0x27CAFC31, 0x1A87AB0F, 0x294BDE9A, 0x140689A4, 0x00FB995A, 0x3DB6CE64,
+	0x0E7ABBF1, 0x3337ECCF, 0x1DF9DC0C, 0x20B48B32, 0x1378FEA7, 0x2E35A999,
+	0x3AFF13F6, 0x07B244C8, 0x347E315D, 0x09336663, 0x27FD56A0, 0x1AB0019E,
+	0x297C740B, 0x14312335, 0x00E900D5, 0x3DA457EB, 0x0E68227E, 0x33257540,
+	0x1DEB4583, 0x20A612BD, 0x136A6728, 0x2E273016, 0x3AED8A79, 0x07A0DD47,
+	0x346CA8D2, 0x0921FFEC, 0x27EFCF2F, 0x1AA29811, 0x296EED84, 0x1423BABA,
+	0x00000000, 0x012998F0, 0x025331E0, 0x037AA910, 0x04A663C0, 0x058FFB30,
+	0x06F55220, 0x07DCCAD0, 0x094CC780, 0x08655F70, 0x0B1FF660, 0x0A366E90,
+	0x0DEAA440, 0x0CC33CB0, 0x0FB995A0, 0x0E900D50, 0x12998F00, 0x13B017F0,
+	0x10CABEE0, 0x11E32610, 0x163FECC0, 0x17167430, 0x146CDD20, 0x154545D0,
+	0x1BD54880, 0x1AFCD070, 0x19867960, 0x18AFE190, 0x1F732B40, 0x1E5AB3B0,
+	0x1D201AA0, 0x1C098250, 0x25331E00, 0x241A86F0, 0x27602FE0, 0x2649B710,
+	0x21957DC0, 0x20BCE530, 0x23C64C20, 0x22EFD4D0, 0x2C7FD980, 0x2D564170,
+	0x2E2CE860, 0x2F057090, 0x28D9BA40, 0x29F022B0, 0x2A8A8BA0, 0x2BA31350,
+	0x37AA9100, 0x368309F0, 0x35F9A0E0, 0x34D03810, 0x330CF2C0, 0x32256A30,
+	0x315FC320, 0x30765BD0, 0x3EE65680, 0x3FCFCE70, 0x3CB56760, 0x3D9CFF90,
+	0x3A403540, 0x3B69ADB0, 0x381304A0, 0x393A9C50, 0x00000000, 0x012998F0,
+	0x025331E0, 0x037AA910, 0x04A663C0, 0x058FFB30, 0x06F55220, 0x07DCCAD0,
+	0x094CC780, 0x08655F70, 0x0B1FF660, 0x0A366E90, 0x0DEAA440, 0x0CC33CB0,
+	0x0FB995A0, 0x0E900D50, 0x12998F00, 0x13B017F0, 0x10CABEE0, 0x11E32610,
+	0x163FECC0, 0x17167430, 0x146CDD20, 0x154545D0, 0x1BD54880, 0x1AFCD070,
+	0x19867960, 0x18AFE190, 0x1F732B40, 0x1E5AB3B0, 0x1D201AA0, 0x1C098250,
+	0x25331E00, 0x241A86F0, 0x27602FE0, 0x2649B710, 0x21957DC0, 0x20BCE530,
+	0x23C64C20, 0x22EFD4D0, 0x2C7FD980, 0x2D564170, 0x2E2CE860, 0x2F057090,
+	0x28D9BA40, 0x29F022B0, 0x2A8A8BA0, 0x2BA31350, 0x37AA9100, 0x368309F0,
+	0x35F9A0E0, 0x34D03810, 0x330CF2C0, 0x32256A30, 0x315FC320, 0x30765BD0,
+	0x3EE65680, 0x3FCFCE70, 0x3CB56760, 0x3D9CFF90, 0x3A403540, 0x3B69ADB0,
+	0x381304A0, 0x393A9C50, 0x00000000, 0x012998F0, 0x025331E0, 0x037AA910,
+	0x04A663C0, 0x058FFB30, 0x06F55220, 0x07DCCAD0, 0x094CC780, 0x08655F70,
+	0x0B1FF660, 0x0A366E90, 0x0DEAA440, 0x0CC33CB0, 0x0FB995A0, 0x0E900D50,
+	0x12998F00, 0x13B017F0, 0x10CABEE0, 0x11E32610, 0x163FECC0, 0x17167430,
+	0x146CDD20, 0x154545D0, 0x1BD54880, 0x1AFCD070, 0x19867960, 0x18AFE190,
+	0x1F732B40, 0x1E5AB3B0, 0x1D201AA0, 0x1C098250, 0x25331E00, 0x241A86F0,
+	0x27602FE0, 0x2649B710, 0x21957DC0, 0x20BCE530, 0x23C64C20, 0x22EFD4D0,
+	0x2C7FD980, 0x2D564170, 0x2E2CE860, 0x2F057090, 0x28D9BA40, 0x29F022B0,
+	0x2A8A8BA0, 0x2BA31350, 0x37AA9100, 0x368309F0, 0x35F9A0E0, 0x34D03810,
+	0x330CF2C0, 0x32256A30, 0x315FC320, 0x30765BD0, 0x3EE65680, 0x3FCFCE70,
+	0x3CB56760, 0x3D9CFF90, 0x3A403540, 0x3B69ADB0, 0x381304A0, 0x393A9C50,
+	0x00000000, 0x012998F0, 0x025331E0, 0x037AA910, 0x04A663C0, 0x058FFB30,
+	0x06F55220, 0x07DCCAD0, 0x094CC780, 0x08655F70, 0x0B1FF660, 0x0A366E90,
+	0x0DEAA440, 0x0CC33CB0, 0x0FB995A0, 0x0E900D50, 0x12998F00, 0x13B017F0,
+	0x10CABEE0, 0x11E32610, 0x163FECC0, 0x17167430, 0x146CDD20, 0x154545D0,
+	0x1BD54880, 0x1AFCD070, 0x19867960, 0x18AFE190, 0x1F732B40, 0x1E5AB3B0,
+	0x1D201AA0, 0x1C098250, 0x25331E00, 0x241A86F0, 0x27602FE0, 0x2649B710,
+	0x21957DC0, 0x20BCE530, 0x23C64C20, 0x22EFD4D0, 0x2C7FD980, 0x2D564170,
+	0x2E2CE860, 0x2F057090, 0x28D9BA40, 0x29F022B0, 0x2A8A8BA0, 0x2BA31350,
+	0x37AA9100, 0x368309F0, 0x35F9A0E0, 0x34D03810, 0x330CF2C0, 0x32256A30,
+	0x315FC320, 0x30765BD0, 0x3EE65680, 0x3FCFCE70, 0x3CB56760, 0x3D9CFF90,
+	0x3A403540, 0x3B69ADB0, 0x381304A0, 0x393A9C50,
+};
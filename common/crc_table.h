@@ -0,0 +1,24 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CRC_TABLE_H_INCLUDED
+#define CRC_TABLE_H_INCLUDED 1
+
+#include <inttypes.h>
+
+extern const uint32_t crc_table_1edc6f41[256];
+extern const uint32_t crc_table_741b8cd7[4 * 256];
+
+#endif
@@ -33,26 +33,40 @@
 #include "store.h"
 
 #define HTTP_PART_SIZE ((uint32_t)1400)
+#define HTTP_ROUTE_SEGMENTS 2
+#define HTTP_REQUEST_SLOTS 5
+#define HTTP_ROUTE_SEED 2166136261UL
+#define HTTP_ROUTE_PRIME 16777619UL
 
 extern Ns_T ns;
 extern struct Store_T store;
 
+/*pages sorted by the hash of method, path and up to HTTP_ROUTE_SEGMENTS*/
+/*leading literal path rules, equal keys keep the registration order*/
+typedef struct {
+	uint32_t key;
+	const struct Http_Page_T* page;
+} Http_Route_T;
+
 struct Http_T {
 	struct espconn conn;
 	esp_tcp tcp;
 	List_T list;
+	Http_Route_T* routes;
+	uint16_t routes_amount;
 	Parser_State_T state;
 };
 
+/*path and query items point into path, sized for the matched page*/
 struct Http_Request_T {
-	char args_cpy[512];
-	char query_cpy[512];
-	Item_T args_items[5];
-	struct Value_T query_items[10];
+	char* path;
+	Item_T* args_items;
+	Value_T query_items;
 	Http_T http;
 	Parser_T parser;
 	Buffer_T send;
 	Buffer_T content;
+	Json_T json;
 	const struct Http_Page_T* page;
 	struct espconn* conn;
 	void* data;
@@ -60,8 +74,8 @@ struct Http_Request_T {
 	uint32_t content_length;
 	uint16_t part;
 	uint16_t length;
-	Item_T* args;
-	uint8_t args_amount;
+	uint8_t args_size;
+	uint8_t query_size;
 	uint8_t chunked_ref;
 	uint8_t ready : 1;
 	uint8_t close : 1;
@@ -70,6 +84,7 @@ struct Http_Request_T {
 };
 
 static Http_T http_global = NULL;
+static struct Http_Request_T http_requests[HTTP_REQUEST_SLOTS];
 
 static void ICACHE_FLASH_ATTR  http_error_response(Http_Request_T request) {
 	static const char bad_request_400_html[] =
@@ -190,9 +205,11 @@ static Parser_State_T ICACHE_FLASH_ATTR http_200(Http_Request_T req) {
 		return 0;
 	}
 	buffer_init(&header, sizeof(storage), storage);
-	if (req->page->exec || req->page->exec_req) {
+	if (req->page->exec || req->page->exec_req || req->page->exec_json) {
 		if (req->page->exec) {
 			result = req->page->exec(&req->send, req->args_items, req->query_items, req->content);
+		} else if (req->page->exec_json) {
+			result = req->page->exec_json(&req->json, req->args_items, req->query_items, req->content);
 		} else {
 			result = req->page->exec_req(req);
 		}
@@ -204,7 +221,9 @@ static Parser_State_T ICACHE_FLASH_ATTR http_200(Http_Request_T req) {
 				return Parser_State_Internal_Server_Error_500;
 			}
 		}
-		if (req->send) {
+		if (req->json) {
+			req->content_length = json_measure(req->json);
+		} else if (req->send) {
 			req->content_length = buffer_size(req->send);
 		} else {
 			req->content_length = 0;
@@ -263,15 +282,228 @@ static Parser_State_T http_200_options(Http_Request_T req) {
 	return Parser_State_OK_200;
 }
 
+static uint32_t ICACHE_FLASH_ATTR http_route_hash(uint32_t key, const char* data, uint16_t len) {
+	while (len--) {
+		key ^= (uint8_t)*data++;
+		key *= HTTP_ROUTE_PRIME;
+	}
+	return key;
+}
+
+static uint32_t ICACHE_FLASH_ATTR http_route_key(Parser_Method_T method, const char* path) {
+	return http_route_hash(HTTP_ROUTE_SEED ^ (uint32_t)method, path, strlen(path));
+}
+
+static uint32_t ICACHE_FLASH_ATTR http_route_segment(uint32_t key, const char* segment, uint16_t len) {
+	return http_route_hash(http_route_hash(key, "/", 1), segment, len);
+}
+
+static uint32_t ICACHE_FLASH_ATTR http_route_page_key(const struct Http_Page_T* page) {
+	const Rule_T* rule;
+	uint32_t key;
+	uint8_t i;
+	key = http_route_key(page->method, page->path);
+	for (i = 0; (i < HTTP_ROUTE_SEGMENTS) && (i < page->path_rules_amount); i++) {
+		rule = &page->path_rules[i];
+		if ((rule->type != RULE_EQUAL) || !rule->required || !rule->detail.equal) {
+			break;
+		}
+		key = http_route_segment(key, rule->detail.equal, strlen(rule->detail.equal));
+	}
+	return key;
+}
+
+/*first route with a key not below the given one*/
+static uint16_t ICACHE_FLASH_ATTR http_route_find(Http_T http, uint32_t key, uint8_t after) {
+	uint16_t low = 0;
+	uint16_t high = http->routes_amount;
+	uint16_t mid;
+	while (low < high) {
+		mid = (low + high) / 2;
+		if ((http->routes[mid].key < key) || (after && (http->routes[mid].key == key))) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+static uint8_t ICACHE_FLASH_ATTR http_request_items(Http_Request_T request, const struct Http_Page_T* page) {
+	uint8_t size;
+	void* items;
+	size = page->path_rules_amount ? page->path_rules_amount : 1;
+	if (size > request->args_size) {
+		if (!(items = realloc(request->args_items, sizeof(Item_T) * size))) {
+			return 0;
+		}
+		request->args_items = items;
+		request->args_size = size;
+	}
+	size = page->query_rules_amount ? page->query_rules_amount : 1;
+	if (size > request->query_size) {
+		if (!(items = realloc(request->query_items, sizeof(struct Value_T) * size))) {
+			return 0;
+		}
+		request->query_items = items;
+		request->query_size = size;
+	}
+	memset(request->args_items, 0, sizeof(Item_T) * request->args_size);
+	memset(request->query_items, 0, sizeof(struct Value_T) * request->query_size);
+	return 1;
+}
+
+/*checks everything but the route key, sets the page on match. args and query*/
+/*are split in a scratch copy of the path, the rules run on the same spot of*/
+/*the request path which is restored first since a failed page may have cut it*/
+static uint8_t ICACHE_FLASH_ATTR http_page_match(Http_Request_T request, const struct Http_Page_T* page, const char* path, const char* index, const char* args, const char* query) {
+	char* origin;
+	if (index && strcmp(page->path, index)) {
+		return 0;
+	}
+	if (!index && strlen(page->path)) {
+		return 0;
+	}
+	if (parser_method(request->parser) != page->method) {
+		return 0;
+	}
+	while (page->alias) {
+		page = page->alias;
+	}
+	if (page->panel && store.panel_dis) {
+		return 0;
+	}
+	if (page->rest) {
+		if (store.rest_dis) {
+			return 0;
+		}
+		if (strnlen(store.token, sizeof(store.token))) {
+			const char* token;
+			if (!(token = parser_token(request->parser))) {
+				return 0;
+			}
+			if (strncmp(store.token, token, sizeof(store.token))) {
+				return 0;
+			}
+		}
+	}
+	if (args && (!page->path_rules || !page->path_rules_amount)) {
+		return 0;
+	}
+	if ((!args || !strlen(args)) && page->path_rules_amount) {
+		return 0;
+	}
+	if (query && (!page->query_rules || !page->query_rules_amount)) {
+		return 0;
+	}
+	if (page->query_rules) {
+		uint16_t required = 0;
+		uint16_t i;
+		for (i = 0; i < page->query_rules_amount; i++) {
+			if (page->query_rules[i].required) {
+				required++;
+			}
+		}
+		if (required && !query) {
+			return 0;
+		}
+	}
+	if (!http_request_items(request, page) || !(origin = request->path)) {
+		return 0;
+	}
+	if (args) {
+		char* at = origin + (args - path);
+		strcpy(at, args);
+		if (!rule_check_path(at,
+			page->path_rules,
+			request->args_items,
+			page->path_rules_amount,
+			'/')) {
+			return 0;
+		}
+	}
+	if (query) {
+		Slash_T amper;
+		char* at = origin + (query - path);
+		strcpy(at, query);
+		slash_init(&amper, at, '&');
+		if (!slash_parse(&amper,
+			page->query_rules,
+			request->query_items,
+			page->query_rules_amount,
+			'=')) {
+			return 0;
+		}
+	}
+	request->page = page;
+	return 1;
+}
+
+/*splits a copy of the request path in place into index, args and query*/
+static uint8_t ICACHE_FLASH_ATTR http_route_split(char* path, char** index, char** args, char** query) {
+	Slash_T slash;
+	*args = NULL;
+	*query = NULL;
+	debug_printf("path: %s\n", path);
+	while (*path == '/') {
+		path++;
+	}
+	if (!slash_init(&slash, path, '?')) {
+		return 0;
+	}
+	*index = slash_next(&slash);
+	if (*index) {
+		debug_printf("index: %s\n", *index);
+	}
+	if (slash_have_next(&slash)) {
+		*query = slash_current(&slash);
+	}
+	if (*index && (*args = strchr(*index, '/'))) {
+		**args = 0;
+		(*args)++;
+	}
+	if (*args) {
+		debug_printf("args: %s\n", *args);
+	}
+	return 1;
+}
+
+/*most specific route first, only pages with the same key are checked*/
+static const struct Http_Page_T* ICACHE_FLASH_ATTR http_route_page(Http_Request_T request, const char* path, const char* index, const char* args, const char* query) {
+	uint32_t keys[HTTP_ROUTE_SEGMENTS + 1];
+	const char* segment;
+	const char* end;
+	uint16_t i;
+	uint8_t tiers;
+	keys[0] = http_route_key(parser_method(request->parser), index ? index : "");
+	tiers = 1;
+	segment = args;
+	while (segment && (tiers <= HTTP_ROUTE_SEGMENTS)) {
+		end = strchr(segment, '/');
+		keys[tiers] = http_route_segment(keys[tiers - 1], segment, end ? (uint16_t)(end - segment) : strlen(segment));
+		tiers++;
+		segment = end ? end + 1 : NULL;
+	}
+	while (tiers--) {
+		for (i = http_route_find(request->http, keys[tiers], 0);
+			(i < request->http->routes_amount) && (request->http->routes[i].key == keys[tiers]);
+			i++) {
+			if (http_page_match(request, request->http->routes[i].page, path, index, args, query)) {
+				return request->page;
+			}
+		}
+	}
+	return NULL;
+}
+
 static void ICACHE_FLASH_ATTR http_recv(void *arg, char* data, unsigned short len) {
 	struct espconn* conn = arg;
 	Http_Request_T request;
 	const struct Http_Page_T* page;
-	Slash_T slash;
 	char* index;
-	char* path;
 	char* path_copy = NULL;
-	char* args = NULL;
+	char* args;
+	char* query;
 	uint16_t i;
 	uint8_t ok_200 = 0;
 	if (!conn || !data) {
@@ -337,106 +569,15 @@ static void ICACHE_FLASH_ATTR http_recv(void *arg, char* data, unsigned short le
 		if (!(path_copy = strdup(parser_path(request->parser)))) {
 			goto error;
 		}
-		path = path_copy;
-		debug_printf("path: %s\n", path);
-		while (*path == '/') {
-			path++;
-		}
-		if (!slash_init(&slash, path, '?')) {
+		if (!request->path && !(request->path = strdup(path_copy))) {
 			goto error;
 		}
-		index = slash_next(&slash);
-		if (index) {
-			debug_printf("index: %s\n", index);
+		if (!http_route_split(path_copy, &index, &args, &query)) {
+			goto error;
 		}
 		request->http->state = Parser_State_Not_Found_404;
-		list_rewind(request->http->list);
-		if (index && (args = strchr(index, '/'))) {
-			*args = 0;
-			args++;
-		}
-		if (args) {
-			debug_printf("args: %s\n", args);
-		}
-		while(list_next(request->http->list, &page)) {
-			if (index && strcmp(page->path, index)) {
-				continue;
-			}
-			if (!index && strlen(page->path)) {
-				continue;
-			}
-			if (parser_method(request->parser) != page->method) {
-				continue;
-			}
-			while (page->alias) {
-				page = page->alias;
-			}
-			request->page = page;
-			if (request->page->panel && store.panel_dis) {
-				continue;
-			}
-			if (request->page->rest) {
-				if (store.rest_dis) {
-					continue;
-				}
-				if (strnlen(store.token, sizeof(store.token))) {
-					const char* token;
-					if (!(token = parser_token(request->parser))) {
-						continue;
-					}
-					if (strncmp(store.token, token, sizeof(store.token))) {
-						continue;
-					}
-				}
-			}
-			if (args && (!page->path_rules || !page->path_rules_amount)) {
-				continue;
-			}
-			if ((!args || !strlen(args)) && page->path_rules_amount) {
-				continue;
-			}
-			if (slash_have_next(&slash) && (!page->query_rules || !page->query_rules_amount)) {
-				continue;
-			}
-			if (page->query_rules) {
-				uint16_t required = 0;
-				uint16_t i;
-				for (i = 0; i < page->query_rules_amount; i++) {
-					if (page->query_rules[i].required) {
-						required++;
-					}
-				}
-				if (required && !slash_have_next(&slash)) {
-					continue;
-				}
-			}
-			memset(request->args_items, 0, sizeof(request->args_items));
-			if (args) {
-				memset(request->args_cpy, 0, sizeof(request->args_cpy));
-				strncpy(request->args_cpy, args, sizeof(request->args_cpy) - 1);
-				if (!rule_check_path(request->args_cpy,
-					page->path_rules,
-					request->args_items,
-					(page->path_rules_amount > ARRAY_SIZE(request->args_items)) ? ARRAY_SIZE(request->args_items) : page->path_rules_amount,
-					'/')) {
-					continue;
-				}
-			}
-			memset(request->query_items, 0, sizeof(request->query_items));
-			if (slash_have_next(&slash)) {
-				Slash_T amper;
-				memset(request->query_cpy, 0, sizeof(request->query_cpy));
-				strncpy(request->query_cpy, slash_current(&slash), sizeof(request->query_cpy) - 1);
-				slash_init(&amper, request->query_cpy, '&');
-				if (!slash_parse(&amper,
-					page->query_rules,
-					request->query_items,
-					(page->query_rules_amount > ARRAY_SIZE(request->query_items)) ? ARRAY_SIZE(request->query_items) : page->query_rules_amount,
-					'=')) {
-					continue;
-				}
-			}
-			if (!ok_200 && !request->page->multipart) {
+		if ((page = http_route_page(request, path_copy, index, args, query))) {
+			if (!ok_200 && !page->multipart) {
 				debug_describe_P("No multipart");
 				goto done;
 			}
@@ -446,7 +587,6 @@ static void ICACHE_FLASH_ATTR http_recv(void *arg, char* data, unsigned short le
 				request->content = NULL;
 			}
 			request->http->state = http_200(request);
-			break;
 		}
 		if (request->http->state == Parser_State_OK_200) {
 			goto done;
@@ -466,15 +606,21 @@ done:
 
 static Http_Request_T ICACHE_FLASH_ATTR http_request_new(Http_T http, struct espconn* conn) {
 	Http_Request_T request;
+	uint8_t i;
 	if (!http || !conn) {
 		return NULL;
 	}
-	if (!(request = (void*)malloc(sizeof(struct Http_Request_T)))) {
+	for (i = 0; i < HTTP_REQUEST_SLOTS; i++) {
+		if (!http_requests[i].http) {
+			break;
+		}
+	}
+	if (i == HTTP_REQUEST_SLOTS) {
 		return NULL;
 	}
+	request = &http_requests[i];
 	memset(request, 0, sizeof(struct Http_Request_T));
 	if (!(request->parser = parser_new())) {
-		free(request);
 		return NULL;
 	}
 	request->http = http;
@@ -496,8 +642,18 @@ static void ICACHE_FLASH_ATTR http_request_delete(Http_Request_T request) {
 	if (request->send) {
 		free(request->send);
 	}
+	json_delete(request->json);
 	parser_free(request->parser);
-	free(request);
+	if (request->path) {
+		free(request->path);
+	}
+	if (request->args_items) {
+		free(request->args_items);
+	}
+	if (request->query_items) {
+		free(request->query_items);
+	}
+	memset(request, 0, sizeof(struct Http_Request_T));
 	debug_printf("Free heap: %u\n", system_get_free_heap_size());
 }
 
@@ -546,7 +702,7 @@ uint8_t ICACHE_FLASH_ATTR http_req_send_chunked_json(Http_Request_T req, Json_T
 		req->send = NULL;
 	}
 	if (json) {
-		req->send = buffer_new(json_size(json) + 16);
+		req->send = buffer_new(json_measure(json) + 16);
 		if (req->send) {
 			json_print(json, req->send, 0);
 		}
@@ -658,7 +814,20 @@ static void ICACHE_FLASH_ATTR http_sendcon(void *arg) {
 	if (send_len > HTTP_PART_SIZE) {
 		send_len = HTTP_PART_SIZE;
 	}
-	if (req->send) {
+	if (req->json) {
+		/*next window of the json into one part sized buffer*/
+		if (!req->send) {
+			req->send = buffer_new(HTTP_PART_SIZE);
+		}
+		if (req->send) {
+			buffer_clear(req->send);
+			json_print_window(req->json, req->send, req->send_bytes);
+			if (send_len > buffer_size(req->send)) {
+				send_len = buffer_size(req->send);
+			}
+			send_data = buffer_data(req->send, 0);
+		}
+	} else if (req->send) {
 		send_data = buffer_data(req->send, req->send_bytes);
 	} else {
 		send_data = (uint8_t*)req->page->content + req->send_bytes;
@@ -716,7 +885,7 @@ Http_T ICACHE_FLASH_ATTR http_new(void) {
 	espconn_regist_connectcb(&http->conn, http_listen);
 	espconn_accept(&http->conn);
 	espconn_regist_time(&http->conn, 7200, 0);
-	espconn_tcp_set_max_con_allow(&http->conn, 5);
+	espconn_tcp_set_max_con_allow(&http->conn, HTTP_REQUEST_SLOTS);
 	return http;
 }
 
@@ -725,15 +894,34 @@ void ICACHE_FLASH_ATTR http_delete(Http_T http) {
 		return;
 	}
 	list_delete(http->list);
+	if (http->routes) {
+		free(http->routes);
+	}
 	free(http);
 	http_global = NULL;
 }
 
 uint8_t ICACHE_FLASH_ATTR http_add_page(Http_T http, const struct Http_Page_T* page) {
+	Http_Route_T* routes;
+	uint32_t key;
+	uint16_t i;
 	if (!http || !page) {
 		return 0;
 	}
-	return list_add(http->list, &page);
+	if (!(routes = realloc(http->routes, sizeof(Http_Route_T) * (http->routes_amount + 1)))) {
+		return 0;
+	}
+	http->routes = routes;
+	if (!list_add(http->list, &page)) {
+		return 0;
+	}
+	key = http_route_page_key(page);
+	i = http_route_find(http, key, 1);
+	memmove(&routes[i + 1], &routes[i], sizeof(Http_Route_T) * (http->routes_amount - i));
+	routes[i].key = key;
+	routes[i].page = page;
+	http->routes_amount++;
+	return 1;
 }
 
 void* ICACHE_FLASH_ATTR http_req_data(Http_Request_T req) {
@@ -34,6 +34,8 @@ struct Http_Page_T {
 	const char* type;
 	Parser_State_T (*exec)(Buffer_T* buffer, Item_T* args, Value_T query, Buffer_T content);
 	Parser_State_T (*exec_req)(Http_Request_T req);
+	/*json is measured for the header and streamed in parts, never printed whole*/
+	Parser_State_T (*exec_json)(Json_T* json, Item_T* args, Value_T query, Buffer_T content);
 	void (*close_cb)(Http_Request_T req);
 	void (*send_cb)(Http_Request_T req);
 	void (*header_cb)(Http_Request_T req);
@@ -39,21 +39,6 @@ struct Json_T {
 static void ICACHE_FLASH_ATTR json_free_value(Value_T value);
 static void ICACHE_FLASH_ATTR json_print_value(Value_T value, Buffer_T buffer, uint8_t level);
 
-static char* ICACHE_FLASH_ATTR json_string_escape(const char* value) {
-	struct Buffer_T buffer;
-	uint8_t* escaped;
-	if (!value) {
-		return NULL;
-	}
-	if (!(escaped = malloc((strlen(value) * 6) + 1))) {
-		return NULL;
-	}
-	memset(escaped, 0, (strlen(value) * 6) + 1);
-	buffer_init(&buffer, strlen(value) * 6, escaped);
-	buffer_puts_escape(&buffer, value);
-	return (char*)escaped;
-}
-
 Json_T ICACHE_FLASH_ATTR json_new(void) {
 	Json_T json;
 	if (!(json = (Json_T)malloc(sizeof(struct Json_T)))) {
@@ -350,17 +335,13 @@ error0:
 }
 
 static void ICACHE_FLASH_ATTR json_print_value(Value_T value, Buffer_T buffer, uint8_t level) {
-	char* str;
 	if (!value || !buffer) {
 		return;
 	}
 	switch (value->type) {
 		case VALUE_TYPE_STRING:
 			buffer_write(buffer, '"');
-			if ((str = json_string_escape(value->string_value))) {
-				buffer_puts(buffer, str);
-				free(str);
-			}
+			buffer_puts_escape(buffer, value->string_value);
 			buffer_write(buffer, '"');
 			break;
 		case VALUE_TYPE_INT:
@@ -393,12 +374,10 @@ uint16_t ICACHE_FLASH_ATTR json_print(Json_T json, Buffer_T buffer, uint8_t leve
 		return 0;
 	}
 	json_print_rewind(json);
-	while (1) {
-		if (json_print_part(json, buffer, level)) {
-			continue;
-		}
-		break;
-	}
+	/*not driven by the written size, a measuring or skipping buffer stays empty*/
+	do {
+		json_print_part(json, buffer, level);
+	} while (json->it < list_size(json->list));
 	return buffer_size(buffer);
 }
 
@@ -439,13 +418,9 @@ uint16_t ICACHE_FLASH_ATTR json_print_part(Json_T json, Buffer_T buffer, uint8_t
 			buffer_indent(buffer, '\t', level + 1);
 		}
 		if (value.name) {
-			char* name;
-			if ((name = json_string_escape(value.name))) {
-				buffer_write(buffer, '"');
-				buffer_puts(buffer, name);
-				free(name);
-				buffer_puts(buffer, "\": ");
-			}
+			buffer_write(buffer, '"');
+			buffer_puts_escape(buffer, value.name);
+			buffer_puts(buffer, "\": ");
 		}
 		json_print_value(&value, buffer, level);
 		json->it++;
@@ -556,15 +531,189 @@ uint8_t ICACHE_FLASH_ATTR json_to_values(Json_T json, Value_T values) {
 	return 1;
 }
 
-uint16_t ICACHE_FLASH_ATTR json_size(Json_T json) {
-	struct Buffer_T test;
-	uint8_t storage[8];
+static char* ICACHE_FLASH_ATTR json_skip_space(char* data) {
+	while (*data && isspace((unsigned char)*data)) {
+		data++;
+	}
+	return data;
+}
+
+/*data points behind the opening quote, returns the closing quote*/
+static char* ICACHE_FLASH_ATTR json_scan_string(char* data) {
+	while (*data && (*data != '"')) {
+		if ((*data == '\\') && !*(++data)) {
+			return NULL;
+		}
+		data++;
+	}
+	return *data ? data : NULL;
+}
+
+/*data points to '{' or '[', returns the character behind the matching close.
+ *one bit per level remembers the bracket kind, deeper documents are rejected*/
+static char* ICACHE_FLASH_ATTR json_skip_nested(char* data) {
+	uint32_t arrays = 0;
+	uint8_t level = 0;
+	while (*data) {
+		if (*data == '"') {
+			if (!(data = json_scan_string(data + 1))) {
+				return NULL;
+			}
+		} else if ((*data == '{') || (*data == '[')) {
+			if (level == JSON_NEST_MAX) {
+				return NULL;
+			}
+			arrays = (arrays << 1) | (*data == '[');
+			level++;
+		} else if ((*data == '}') || (*data == ']')) {
+			if (!level || ((arrays & 1) != (*data == ']'))) {
+				return NULL;
+			}
+			arrays >>= 1;
+			if (!--level) {
+				return data + 1;
+			}
+		}
+		data++;
+	}
+	return NULL;
+}
+
+/*single pass over a flat object, fields named by the rules are terminated and
+ *unescaped in place, so string values point into the given string which has to
+ *outlive the values. unknown fields and nested objects are skipped*/
+uint8_t ICACHE_FLASH_ATTR json_parse_values(char* string, const Rule_T* rule, uint8_t size, Value_T values) {
+	char* data;
+	char* name;
+	char* value;
+	char* end;
+	char delimiter;
+	uint8_t literal;
+	uint8_t i;
+	if (!string || !rule || !size || !values) {
+		return 0;
+	}
+	memset(values, 0, sizeof(struct Value_T) * size);
+	data = json_skip_space(string);
+	if (*data != '{') {
+		goto error;
+	}
+	data = json_skip_space(data + 1);
+	if (*data == '}') {
+		data++;
+		goto done;
+	}
+	while (1) {
+		if (*data != '"') {
+			goto error;
+		}
+		name = data + 1;
+		if (!(end = json_scan_string(name))) {
+			goto error;
+		}
+		*end = 0;
+		data = json_skip_space(end + 1);
+		if (*data != ':') {
+			goto error;
+		}
+		data = json_skip_space(data + 1);
+		value = NULL;
+		literal = 0;
+		if (*data == '"') {
+			value = data + 1;
+			if (!(end = json_scan_string(value))) {
+				goto error;
+			}
+			*end = 0;
+			data = end + 1;
+		} else if ((*data == '{') || (*data == '[')) {
+			if (!(data = json_skip_nested(data))) {
+				goto error;
+			}
+		} else {
+			value = data;
+			while (*data && !strchr("{}[]:,\"", *data) && !isspace((unsigned char)*data)) {
+				data++;
+			}
+			if (data == value) {
+				goto error;
+			}
+			literal = 1;
+		}
+		delimiter = ' ';
+		if (literal) {
+			delimiter = *data;
+			*data = 0;
+			if (delimiter) {
+				data++;
+			}
+		}
+		if (!delimiter || isspace((unsigned char)delimiter)) {
+			data = json_skip_space(data);
+			if ((delimiter = *data)) {
+				data++;
+			}
+		}
+		if (!slash_replace(name)) {
+			goto error;
+		}
+		for (i = 0; i < size; i++) {
+			if (!values[i].present && !strcmp(rule[i].name, name)) {
+				if (!value) {
+					goto error;
+				}
+				if (!literal && !slash_replace(value)) {
+					goto error;
+				}
+				if (!rule_check_to_value(&rule[i], value, &values[i])) {
+					goto error;
+				}
+				break;
+			}
+		}
+		if (delimiter == '}') {
+			break;
+		}
+		if (delimiter != ',') {
+			goto error;
+		}
+		data = json_skip_space(data);
+	}
+done:
+	if (*json_skip_space(data)) {
+		goto error;
+	}
+	for (i = 0; i < size; i++) {
+		if (rule[i].required && !values[i].present) {
+			goto error;
+		}
+	}
+	return 1;
+error:
+	debug_describe_P("Not valid JSON");
+	return 0;
+}
+
+/*exact serialized length, printed into a buffer without storage*/
+uint16_t ICACHE_FLASH_ATTR json_measure(Json_T json) {
+	struct Buffer_T measure;
 	if (!json) {
 		return 0;
 	}
-	buffer_init(&test, sizeof(storage), storage);
-	json_print(json, &test, 0);
-	return buffer_overflow(&test) + buffer_capacity(&test);
+	memset(&measure, 0, sizeof(measure));
+	json_print(json, &measure, 0);
+	return buffer_overflow(&measure);
+}
+
+/*prints the part of the serialized json starting at offset that fits the buffer*/
+uint16_t ICACHE_FLASH_ATTR json_print_window(Json_T json, Buffer_T buffer, uint16_t offset) {
+	if (!json || !buffer) {
+		return 0;
+	}
+	buffer->skip = offset;
+	json_print(json, buffer, 0);
+	buffer->skip = 0;
+	return buffer_size(buffer);
 }
 
 Buffer_T ICACHE_FLASH_ATTR json_to_buffer(Json_T json) {
@@ -576,7 +725,7 @@ Buffer_T ICACHE_FLASH_ATTR json_to_buffer_size(Json_T json, uint16_t additional_
 	if (!json) {
 		return NULL;
 	}
-	buffer = buffer_new(json_size(json) + additional_size);
+	buffer = buffer_new(json_measure(json) + 1 + additional_size);
 	if (buffer) {
 		json_print(json, buffer, 0);
 	}
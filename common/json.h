@@ -22,6 +22,8 @@
 #include "list.h"
 #include "rule.h"
 
+#define JSON_NEST_MAX 32
+
 typedef struct Json_T* Json_T;
 
 Json_T json_new(void);
@@ -30,6 +32,8 @@ uint8_t json_add(Json_T json, Value_T value);
 uint16_t json_print(Json_T json, Buffer_T buffer, uint8_t level);
 void json_print_rewind(Json_T json);
 uint16_t json_print_part(Json_T json, Buffer_T buffer, uint8_t level);
+uint16_t json_print_window(Json_T json, Buffer_T buffer, uint16_t offset);
+uint16_t json_measure(Json_T json);
 void json_clear(Json_T json);
 void json_delete(Json_T json);
 uint8_t json_add_obj(Json_T json, const char* name, Json_T obj);
@@ -44,8 +48,8 @@ Json_T json_parse(char* string, const Rule_T* rule, uint8_t size);
 List_T json_items(Json_T json);
 uint8_t json_get(Json_T json, const char* name, Value_T value);
 uint8_t json_to_values(Json_T json, Value_T values);
+uint8_t json_parse_values(char* string, const Rule_T* rule, uint8_t size, Value_T values);
 uint8_t json_set_callback(Json_T json, const char* name);
-uint16_t json_size(Json_T json);
 Buffer_T json_to_buffer(Json_T json);
 Buffer_T json_to_buffer_size(Json_T json, uint16_t additional_size);
 
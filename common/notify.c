@@ -14,6 +14,7 @@
 
 
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <user_interface.h>
@@ -28,6 +29,30 @@
 #include "store.h"
 #include "base64.h"
 #include "rule.h"
+#include "rtc.h"
+#include "array_size.h"
+#include "trace.h"
+#ifdef BUTTON
+#include "sleep.h"
+#endif
+
+#define NOTIFY_DNS_TTL (3600)
+#define NOTIFY_POOL_SIZE (2)
+#define NOTIFY_POOL_WARM (5000)
+#define NOTIFY_POOL_IDLE (10000)
+#define NOTIFY_RESP_LINE_SIZE (48)
+
+typedef enum {
+	NOTIFY_RESP_STATUS,
+	NOTIFY_RESP_HEAD,
+	NOTIFY_RESP_BODY,
+	NOTIFY_RESP_CHUNK_SIZE,
+	NOTIFY_RESP_CHUNK_DATA,
+	NOTIFY_RESP_CHUNK_END,
+	NOTIFY_RESP_TRAILER,
+	NOTIFY_RESP_UNTIL_CLOSE,
+	NOTIFY_RESP_DONE,
+} Notify_Resp_State_T;
 
 struct Notify_T {
 	char* path;
@@ -46,12 +71,252 @@ struct Notify_T {
 	void* owner;
 	char* post_data;
 	char* headers;
+	char* line;
+	char* head;
 	uint32_t timeout;
 	Ns_Method_T method;
+	Notify_Resp_State_T resp;
+	uint32_t resp_left;
+	uint16_t resp_code;
+	uint8_t resp_line_len;
+	char resp_line[NOTIFY_RESP_LINE_SIZE];
 	uint8_t ssl : 1;
+	uint8_t cached : 1;
+	uint8_t refresh : 1;
+	uint8_t keep_alive : 1;
+	uint8_t resp_close : 1;
+	uint8_t resp_chunked : 1;
+	uint8_t resp_length : 1;
+	uint8_t reused : 1;
+	uint8_t resp_any : 1;
 };
 
+typedef enum {
+	NOTIFY_CONN_FREE,
+	NOTIFY_CONN_RESOLVING,
+	NOTIFY_CONN_CONNECTING,
+	NOTIFY_CONN_IDLE,
+	NOTIFY_CONN_DROP,
+	NOTIFY_CONN_BUSY,
+} Notify_Conn_State_T;
+
+/*connection owned by the pool, opened ahead of a request or kept alive after one*/
+typedef struct {
+	struct espconn conn;
+	esp_tcp tcp;
+	struct espconn dns;
+	os_timer_t timer;
+	ip_addr_t ip;
+	Notify_Target_T target;
+	Notify_Conn_State_T state;
+	uint8_t warm : 1;
+} Notify_Conn_T;
+
+static Notify_Conn_T pool[NOTIFY_POOL_SIZE];
+static uint8_t pool_keep_alive = 0;
+static RTC_TLS_T tls_stats;
+static uint8_t tls_stats_loaded = 0;
+
+#ifdef BUTTON
+static RTC_DNS_T dns_cache;
+static uint8_t dns_cache_loaded = 0;
+static struct espconn dns_refresh_conn;
+static ip_addr_t dns_refresh_ip;
+static char dns_refresh_host[RTC_DNS_HOST_SIZE];
+static uint8_t dns_refresh_busy = 0;
+#endif
+
 static void ICACHE_FLASH_ATTR notify_response_timeout_cb(void* arg);
+static void ICACHE_FLASH_ATTR notify_dns_cb(const char* name, ip_addr_t* ipaddr, void* arg);
+static void ICACHE_FLASH_ATTR notify_dns_timeout_cb(void* arg);
+static uint8_t ICACHE_FLASH_ATTR notify_connect_by_ip(Notify_T notify);
+
+static uint8_t ICACHE_FLASH_ATTR notify_pool_connect(Notify_T notify);
+static uint8_t ICACHE_FLASH_ATTR notify_pool_idle(Notify_T notify);
+static void ICACHE_FLASH_ATTR notify_pool_detach(Notify_Conn_T* c);
+
+static Notify_Conn_T* ICACHE_FLASH_ATTR notify_pool_find(struct espconn* conn) {
+	uint8_t i;
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		if (conn == &pool[i].conn) {
+			return &pool[i];
+		}
+	}
+	return NULL;
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_release(struct espconn* conn) {
+	Notify_Conn_T* c;
+	if (!(c = notify_pool_find(conn))) {
+		return;
+	}
+	os_timer_disarm(&c->timer);
+	c->conn.reverse = NULL;
+	c->state = NOTIFY_CONN_FREE;
+}
+
+static RTC_TLS_T* ICACHE_FLASH_ATTR notify_tls(void) {
+	if (!tls_stats_loaded) {
+#ifdef BUTTON
+		if (!rtc_read(RTC_TLS_OFFSET, &tls_stats, sizeof(tls_stats))) {
+			memset(&tls_stats, 0, sizeof(tls_stats));
+		}
+#endif
+		tls_stats_loaded = 1;
+	}
+	return &tls_stats;
+}
+
+/*full handshakes against ones saved by a kept connection, survives deep sleep*/
+static void ICACHE_FLASH_ATTR notify_tls_count(uint8_t reused) {
+	RTC_TLS_T* stats = notify_tls();
+	if (reused) {
+		stats->reused++;
+	} else {
+		stats->handshakes++;
+	}
+#ifdef BUTTON
+	rtc_write(RTC_TLS_OFFSET, stats, sizeof(RTC_TLS_T));
+#endif
+}
+
+#ifdef BUTTON
+static RTC_DNS_T* ICACHE_FLASH_ATTR notify_dns_cache(void) {
+	if (!dns_cache_loaded) {
+		if (!rtc_read(RTC_DNS_OFFSET, &dns_cache, sizeof(dns_cache))) {
+			memset(&dns_cache, 0, sizeof(dns_cache));
+		}
+		dns_cache_loaded = 1;
+	}
+	return &dns_cache;
+}
+#endif
+
+static uint8_t ICACHE_FLASH_ATTR notify_dns_cache_get(const char* host, ip_addr_t* ip, uint8_t* refresh) {
+#ifdef BUTTON
+	RTC_DNS_T* cache;
+	RTC_DNS_Entry_T* entry;
+	uint32_t now;
+	uint8_t i;
+	if (!host || !ip || (strlen(host) >= RTC_DNS_HOST_SIZE)) {
+		return 0;
+	}
+	cache = notify_dns_cache();
+	now = sleep_get_current_timestamp();
+	for (i = 0; i < RTC_DNS_ENTRIES; i++) {
+		entry = &cache->entry[i];
+		if (strncmp(entry->host, host, RTC_DNS_HOST_SIZE)) {
+			continue;
+		}
+		/*timestamp may jump back after time sync*/
+		if (!entry->ip.addr || (now >= entry->expire) || ((entry->expire - now) > NOTIFY_DNS_TTL)) {
+			return 0;
+		}
+		*ip = entry->ip;
+		if (refresh) {
+			*refresh = ((entry->expire - now) < (NOTIFY_DNS_TTL / 2)) ? 1 : 0;
+		}
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+static void ICACHE_FLASH_ATTR notify_dns_cache_put(const char* host, ip_addr_t* ip) {
+#ifdef BUTTON
+	RTC_DNS_T* cache;
+	RTC_DNS_Entry_T* entry = NULL;
+	uint8_t i;
+	if (!host || (strlen(host) >= RTC_DNS_HOST_SIZE)) {
+		return;
+	}
+	cache = notify_dns_cache();
+	for (i = 0; i < RTC_DNS_ENTRIES; i++) {
+		if (!strncmp(cache->entry[i].host, host, RTC_DNS_HOST_SIZE)) {
+			entry = &cache->entry[i];
+			break;
+		}
+	}
+	if (!entry) {
+		if (!ip) {
+			return;
+		}
+		/*replace the entry which expires first*/
+		entry = &cache->entry[0];
+		for (i = 1; i < RTC_DNS_ENTRIES; i++) {
+			if (cache->entry[i].expire < entry->expire) {
+				entry = &cache->entry[i];
+			}
+		}
+	}
+	memset(entry, 0, sizeof(RTC_DNS_Entry_T));
+	strncpy(entry->host, host, RTC_DNS_HOST_SIZE - 1);
+	if (ip) {
+		entry->ip = *ip;
+		entry->expire = sleep_get_current_timestamp() + NOTIFY_DNS_TTL;
+	}
+	debug_printf("DNS cache %s: " IPSTR "\n", entry->host, IP2STR(&entry->ip));
+	if (!rtc_write(RTC_DNS_OFFSET, cache, sizeof(RTC_DNS_T))) {
+		debug_describe_P("DNS cache save error");
+	}
+#endif
+}
+
+#ifdef BUTTON
+static void ICACHE_FLASH_ATTR notify_dns_refresh_cb(const char* name, ip_addr_t* ipaddr, void* arg) {
+	dns_refresh_busy = 0;
+	if (!ipaddr) {
+		debug_describe_P("DNS refresh error");
+		return;
+	}
+	notify_dns_cache_put(dns_refresh_host, ipaddr);
+}
+#endif
+
+static void ICACHE_FLASH_ATTR notify_dns_refresh(const char* host) {
+#ifdef BUTTON
+	if (!host || dns_refresh_busy || (strlen(host) >= RTC_DNS_HOST_SIZE)) {
+		return;
+	}
+	debug_describe_P("DNS refresh");
+	memset(&dns_refresh_conn, 0, sizeof(dns_refresh_conn));
+	memset(dns_refresh_host, 0, sizeof(dns_refresh_host));
+	strncpy(dns_refresh_host, host, sizeof(dns_refresh_host) - 1);
+	dns_refresh_ip.addr = 0;
+	switch (espconn_gethostbyname(&dns_refresh_conn, dns_refresh_host, &dns_refresh_ip, notify_dns_refresh_cb)) {
+		case ESPCONN_OK:
+			notify_dns_cache_put(dns_refresh_host, &dns_refresh_ip);
+			break;
+		case ESPCONN_INPROGRESS:
+			dns_refresh_busy = 1;
+			break;
+		default:
+			break;
+	}
+#endif
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_resolve(Notify_T notify) {
+	if (!notify || !notify->host) {
+		return 0;
+	}
+	notify->server_ip.addr = 0;
+	switch (espconn_gethostbyname(&notify->dns, notify->host, &notify->server_ip, notify_dns_cb)) {
+		case ESPCONN_OK:
+			debug_printf("Notify server IP:" IPSTR "\n", IP2STR(&notify->server_ip));
+			notify->ip = notify->server_ip;
+			notify_dns_cache_put(notify->host, &notify->ip);
+			return notify_connect_by_ip(notify);
+		case ESPCONN_INPROGRESS:
+			os_timer_disarm(&notify->timer);
+			os_timer_setfn(&notify->timer, notify_dns_timeout_cb, notify);
+			os_timer_arm(&notify->timer, 10000, 0);
+			return 1;
+		default:
+			break;
+	}
+	return 0;
+}
 
 static void ICACHE_FLASH_ATTR notify_done(Notify_T notify, uint8_t error) {
 	if (!notify) {
@@ -81,15 +346,145 @@ static void ICACHE_FLASH_ATTR notify_send(void* arg) {
 	}
 }
 
+static void ICACHE_FLASH_ATTR notify_frame_line(Notify_T notify) {
+	char* line = notify->resp_line;
+	char* value;
+	uint8_t i;
+	switch (notify->resp) {
+		case NOTIFY_RESP_STATUS:
+			if ((strlen(line) < 12) || strncmp(line, "HTTP/1.", 7)) {
+				notify->resp = NOTIFY_RESP_UNTIL_CLOSE;
+				break;
+			}
+			if (line[7] == '0') {
+				notify->resp_close = 1;
+			}
+			notify->resp_code = atoi(line + 9);
+			notify->resp = NOTIFY_RESP_HEAD;
+			break;
+
+		case NOTIFY_RESP_HEAD:
+			if (!strlen(line)) {
+				if ((notify->resp_code >= 100) && (notify->resp_code < 200)) {
+					notify->resp_chunked = 0;
+					notify->resp_length = 0;
+					notify->resp = NOTIFY_RESP_STATUS;
+				} else if ((notify->resp_code == 204) || (notify->resp_code == 304)) {
+					notify->resp = NOTIFY_RESP_DONE;
+				} else if (notify->resp_chunked) {
+					notify->resp = NOTIFY_RESP_CHUNK_SIZE;
+				} else if (notify->resp_length) {
+					notify->resp = notify->resp_left ? NOTIFY_RESP_BODY : NOTIFY_RESP_DONE;
+				} else {
+					notify->resp = NOTIFY_RESP_UNTIL_CLOSE;
+				}
+				break;
+			}
+			if (!(value = strchr(line, ':'))) {
+				break;
+			}
+			*value++ = '\0';
+			while (*value == ' ') {
+				value++;
+			}
+			if (!strcasecmp(line, "Content-Length")) {
+				notify->resp_left = atoi(value);
+				notify->resp_length = 1;
+			} else if (!strcasecmp(line, "Transfer-Encoding")) {
+				notify->resp_chunked = strstr(value, "chunked") ? 1 : 0;
+			} else if (!strcasecmp(line, "Connection")) {
+				if (strstr(value, "close")) {
+					notify->resp_close = 1;
+				}
+			}
+			break;
+
+		case NOTIFY_RESP_CHUNK_SIZE:
+			notify->resp_left = 0;
+			for (i = 0; isxdigit((unsigned char)line[i]); i++) {
+				notify->resp_left <<= 4;
+				notify->resp_left |= isdigit((unsigned char)line[i]) ? (line[i] - '0') : ((tolower((unsigned char)line[i]) - 'a') + 10);
+			}
+			notify->resp = notify->resp_left ? NOTIFY_RESP_CHUNK_DATA : NOTIFY_RESP_TRAILER;
+			break;
+
+		case NOTIFY_RESP_CHUNK_END:
+			notify->resp = NOTIFY_RESP_CHUNK_SIZE;
+			break;
+
+		case NOTIFY_RESP_TRAILER:
+			if (!strlen(line)) {
+				notify->resp = NOTIFY_RESP_DONE;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*follows the response framing, returns 1 once the whole response is in*/
+static uint8_t ICACHE_FLASH_ATTR notify_frame(Notify_T notify, const uint8_t* data, uint16_t len) {
+	uint16_t i = 0;
+	uint32_t n;
+	if (!notify || !data) {
+		return 0;
+	}
+	while (i < len) {
+		switch (notify->resp) {
+			case NOTIFY_RESP_BODY:
+			case NOTIFY_RESP_CHUNK_DATA:
+				n = len - i;
+				if (n > notify->resp_left) {
+					n = notify->resp_left;
+				}
+				notify->resp_left -= n;
+				i += n;
+				if (!notify->resp_left) {
+					notify->resp = (notify->resp == NOTIFY_RESP_BODY) ? NOTIFY_RESP_DONE : NOTIFY_RESP_CHUNK_END;
+				}
+				continue;
+			case NOTIFY_RESP_UNTIL_CLOSE:
+				return 0;
+			case NOTIFY_RESP_DONE:
+				/*more than one response, do not reuse*/
+				notify->resp_close = 1;
+				return 1;
+			default:
+				break;
+		}
+		if (data[i] == '\n') {
+			if (notify->resp_line_len && (notify->resp_line[notify->resp_line_len - 1] == '\r')) {
+				notify->resp_line_len--;
+			}
+			notify->resp_line[notify->resp_line_len] = '\0';
+			notify_frame_line(notify);
+			notify->resp_line_len = 0;
+		} else if (notify->resp_line_len < (sizeof(notify->resp_line) - 1)) {
+			notify->resp_line[notify->resp_line_len++] = data[i];
+		}
+		i++;
+	}
+	return (notify->resp == NOTIFY_RESP_DONE) ? 1 : 0;
+}
+
 static void ICACHE_FLASH_ATTR notify_recv(void *arg, char* data, unsigned short len) {
 	struct espconn* conn = (struct espconn*)arg;
 	Notify_T notify;
+	uint8_t keep;
 	if (!conn || !(notify = conn->reverse) || !data) {
 		return;
 	}
 	debug_describe_P("Notify recv");
 	notify->current_conn = conn;
-	if (notify->recv_cb && notify->recv_cb(notify, (uint8_t*)data, len)) {
+	notify->resp_any = 1;
+	keep = (notify->recv_cb && notify->recv_cb(notify, (uint8_t*)data, len)) ? 1 : 0;
+	if (notify->keep_alive && notify_frame(notify, (uint8_t*)data, len) && !notify->resp_close && notify_pool_idle(notify)) {
+		debug_describe_P("Notify keep alive");
+		notify_done(notify, 0);
+		return;
+	}
+	if (keep) {
 		return;
 	}
 	if (notify->ssl) {
@@ -99,6 +494,17 @@ static void ICACHE_FLASH_ATTR notify_recv(void *arg, char* data, unsigned short
 	}
 }
 
+/*kept alive connection went away before any answer, the server likely timed it out*/
+static uint8_t ICACHE_FLASH_ATTR notify_retry(Notify_T notify) {
+	if (!notify->reused || notify->resp_any) {
+		return 0;
+	}
+	debug_describe_P("Notify retry");
+	notify->reused = 0;
+	os_timer_disarm(&notify->timer);
+	return notify_connect_by_ip(notify);
+}
+
 static void ICACHE_FLASH_ATTR notify_close(void* arg) {
 	struct espconn* conn = (struct espconn*)arg;
 	Notify_T notify;
@@ -111,7 +517,11 @@ static void ICACHE_FLASH_ATTR notify_close(void* arg) {
 	} else {
 		espconn_delete(conn);
 	}
+	notify_pool_release(conn);
 	notify->current_conn = NULL;
+	if (notify_retry(notify)) {
+		return;
+	}
 	notify_done(notify, 0);
 }
 
@@ -119,6 +529,7 @@ static void ICACHE_FLASH_ATTR notify_connected(void* arg) {
 	struct Buffer_T request;
 	uint8_t* storage = NULL;
 	struct espconn* conn = (struct espconn*)arg;
+	Notify_Conn_T* c;
 	Notify_T notify;
 	size_t req_len = 0;
 	int8_t result;
@@ -126,25 +537,26 @@ static void ICACHE_FLASH_ATTR notify_connected(void* arg) {
 		return;
 	}
 	debug_describe_P("Notify connected");
+	trace_mark(TRACE_CONNECT);
 	notify->current_conn = conn;
 	espconn_regist_disconcb(conn, notify_close);
 	espconn_regist_recvcb(conn, notify_recv);
 	espconn_regist_sentcb(conn, notify_send);
 
-	req_len += 7; /*method*/
-	req_len += strlen(notify->path) + 11; /*path*/
-	req_len += strlen(notify->host) + 7 + 6 + 2;
-	req_len += 17 + 2;
-	if (notify->headers) {
-		req_len += strlen(notify->headers);
-	}
-	if (notify->auth) {
-		req_len += strlen(notify->auth) + 21 + 2;
+	if (notify->cached && notify->refresh) {
+		notify_dns_refresh(notify->host);
 	}
+	notify->keep_alive = (pool_keep_alive && notify->recv_cb && notify_pool_find(conn)) ? 1 : 0;
+	notify->resp = NOTIFY_RESP_STATUS;
+	notify->resp_line_len = 0;
+	notify->resp_any = 0;
+	req_len += strlen(notify->line);
+	req_len += strlen(notify->head);
+	req_len += 22 + 2;
 	if (notify->post_data) {
 		req_len += strlen(notify->post_data) + 16 + 5 + 2;
 	}
-	req_len += 2 + 32;
+	req_len += 2 + 1;
 	if (!(storage = calloc(1, req_len))) {
 		result = 1;
 		goto done;
@@ -152,51 +564,14 @@ static void ICACHE_FLASH_ATTR notify_connected(void* arg) {
 	buffer_init(&request, req_len, storage);
 	buffer_clear(&request);
 
-	if (notify->method == NS_METHOD_DELETE) {
-		buffer_puts(&request, "DELETE ");
+	buffer_puts(&request, notify->line);
+	buffer_puts(&request, notify->head);
+	if (notify->keep_alive) {
+		buffer_puts(&request, "Connection: keep-alive" CRLF);
 	} else {
-		if ((notify->method == NS_METHOD_POST) ||
-			(notify->method == NS_METHOD_PUT) ||
-			notify->post_data) {
-			if (notify->method == NS_METHOD_POST) {
-				buffer_puts(&request, "POST ");
-			} else {
-				buffer_puts(&request, "PUT ");
-			}
-		} else {
-			buffer_puts(&request, "GET ");
-		}
+		buffer_puts(&request, "Connection: close" CRLF);
 	}
-	buffer_puts(&request, notify->path);
-	buffer_puts(&request, " HTTP/1.1" CRLF);
-	free(notify->path);
-	notify->path = NULL;
-
-	buffer_puts(&request, "Host: ");
-	buffer_puts(&request, notify->host);
-	free(notify->host);
-	notify->host = NULL;
-
-	buffer_puts(&request, ":");
-	buffer_dec(&request, notify->port);
-	buffer_puts(&request, CRLF);
 
-	buffer_puts(&request, "Connection: close" CRLF);
-	if (notify->headers) {
-		buffer_puts(&request, notify->headers);
-		if (!buffer_equal_from_end_str(&request, CRLF)) {
-			buffer_puts(&request, CRLF);
-		}
-		free(notify->headers);
-		notify->headers = NULL;
-	}
-	if (notify->auth) {
-		buffer_puts(&request, "Authorization: Basic ");
-		buffer_puts(&request, notify->auth);
-		buffer_puts(&request, CRLF);
-		free(notify->auth);
-		notify->auth = NULL;
-	}
 	if (notify->post_data) {
 		buffer_puts(&request, "Content-Length: ");
 		buffer_dec(&request, strlen(notify->post_data));
@@ -206,6 +581,15 @@ static void ICACHE_FLASH_ATTR notify_connected(void* arg) {
 
 	if (notify->post_data) {
 		buffer_puts(&request, notify->post_data);
+	}
+	/*a reused connection may be closed under us, keep the request for one retry*/
+	if (!notify->reused) {
+		free(notify->line);
+		notify->line = NULL;
+		free(notify->head);
+		notify->head = NULL;
+		free(notify->host);
+		notify->host = NULL;
 		free(notify->post_data);
 		notify->post_data = NULL;
 	}
@@ -217,13 +601,20 @@ static void ICACHE_FLASH_ATTR notify_connected(void* arg) {
 done:
 	if (result) {
 		debug_describe_P("Http request send error");
-		if (notify->ssl) {
+		free(storage);
+		/*the pool finishes its connection, the notify is deleted by done*/
+		if ((c = notify_pool_find(conn))) {
+			notify_pool_detach(c);
+			notify->current_conn = NULL;
+			if (notify_retry(notify)) {
+				return;
+			}
+		} else if (notify->ssl) {
 			espconn_secure_disconnect(conn);
 		} else {
 			espconn_disconnect(conn);
 		}
 		notify_done(notify, 1);
-		free(storage);
 		return;
 	}
 	debug_describe_P("SEND:");
@@ -248,8 +639,20 @@ static void ICACHE_FLASH_ATTR notify_error(void* arg, sint8 errType) {
 	} else {
 		espconn_delete(conn);
 	}
+	notify_pool_release(conn);
 	notify->current_conn = NULL;
 	debug_describe_P("Unable connect to notify server");
+	if (notify_retry(notify)) {
+		return;
+	}
+	if (notify->cached) {
+		/*cached address is stale, resolve again*/
+		notify->cached = 0;
+		notify_dns_cache_put(notify->host, NULL);
+		if (notify_resolve(notify)) {
+			return;
+		}
+	}
 	notify_done(notify, 1);
 }
 
@@ -258,6 +661,11 @@ static uint8_t ICACHE_FLASH_ATTR notify_connect_by_ip(Notify_T notify) {
 		return 0;
 	}
 	debug_describe_P("Notify connect by IP");
+	trace_mark(TRACE_DNS);
+	if (notify_pool_connect(notify)) {
+		debug_describe_P("Notify connecting...");
+		return 1;
+	}
 	memset(&notify->conn, 0, sizeof(notify->conn));
 	memset(&notify->tcp, 0, sizeof(notify->tcp));
 	notify->conn.reverse = notify;
@@ -275,6 +683,7 @@ static uint8_t ICACHE_FLASH_ATTR notify_connect_by_ip(Notify_T notify) {
 			debug_describe_P("Unable to connect to notify server by SSL");
 			return 0;
 		}
+		notify_tls_count(0);
 	} else {
 		if (espconn_connect(&notify->conn)) {
 			debug_describe_P("Unable to connect to notify server");
@@ -301,6 +710,7 @@ static void ICACHE_FLASH_ATTR notify_dns_cb(const char* name, ip_addr_t* ipaddr,
 	}
 	debug_describe_P("Notify address resolved");
 	notify->ip = *ipaddr;
+	notify_dns_cache_put(notify->host, &notify->ip);
 	if (!notify_connect_by_ip(notify)) {
 		notify_done(notify, 1);
 	}
@@ -328,93 +738,367 @@ static void ICACHE_FLASH_ATTR notify_response_timeout_cb(void* arg) {
 	}
 }
 
-Notify_T ICACHE_FLASH_ATTR notify_new(
-	const char* url,
-	const char* headers,
-	const char* post_data,
-	const char* args,
-	void (*done_cb)(Notify_T notify, uint8_t error),
-	uint8_t (*recv_cb)(Notify_T notify, uint8_t* data, uint32_t len),
-	void* owner,
-	uint32_t timeout_ms,
-	Ns_Method_T method)
-{
-	uint8_t* storage = NULL;
-	struct Buffer_T buffer;
-	size_t len;
-	size_t len_plus_spaces;
-	size_t path_len;
-	size_t i;
-	Notify_T notify;
-	Slash_T slash;
-	char* server;
-	char* port;
-	char* at;
-	char* proto;
-	err_t err;
-	uint8_t require_question = 0;
-	if (!url) {
-		debug_describe_P("No URL");
-		return NULL;
+static void ICACHE_FLASH_ATTR notify_pool_disconnect(Notify_Conn_T* c) {
+	if (c->target.ssl) {
+		espconn_secure_disconnect(&c->conn);
+	} else {
+		espconn_disconnect(&c->conn);
 	}
-	if (!(len = strlen(url))) {
-		debug_describe_P("URL zero len");
-		return NULL;
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_drop(Notify_Conn_T* c) {
+	switch (c->state) {
+		case NOTIFY_CONN_RESOLVING:
+			debug_describe_P("Notify pool drop");
+			notify_pool_release(&c->conn);
+			break;
+		case NOTIFY_CONN_CONNECTING:
+			/*disconnect as soon as connected*/
+			c->state = NOTIFY_CONN_DROP;
+			break;
+		case NOTIFY_CONN_IDLE:
+			debug_describe_P("Notify pool drop");
+			c->state = NOTIFY_CONN_DROP;
+			notify_pool_disconnect(c);
+			break;
+		default:
+			break;
 	}
-	if (!(notify = malloc(sizeof(struct Notify_T)))) {
-		debug_describe_P("Can't alloc notify");
-		return NULL;
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_timeout_cb(void* arg) {
+	Notify_Conn_T* c = arg;
+	if (!c) {
+		return;
 	}
-	debug_describe_P("New notify");
-	memset(notify, 0, sizeof(struct Notify_T));
-	memset(&notify->dns, 0, sizeof(notify->dns));
-	if (headers && strlen(headers)) {
-		if (!(notify->headers = strdup(headers))) {
-			goto error;
-		}
+	debug_describe_P("Notify pool timeout");
+	notify_pool_drop(c);
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_adopted_cb(void* arg) {
+	Notify_Conn_T* c = arg;
+	if (c && (c->state == NOTIFY_CONN_BUSY) && c->conn.reverse) {
+		notify_connected(&c->conn);
 	}
-	debug_value(method);
-	if ((post_data && strlen(post_data)) ||
-		(args && strlen(args) && ((method == NS_METHOD_POST) || (method == NS_METHOD_PUT)))) {
-		size_t body_len = 1;
-		if (post_data) {
-			body_len += strlen(post_data);
-		}
-		if (args) {
-			body_len += strlen(args);
-		}
-		if (!(notify->post_data = calloc(1, body_len + 1))) {
-			goto error;
-		}
-		if (post_data && strlen(post_data)) {
-			strcat(notify->post_data, post_data);
-		}
-		if (args && strlen(args)) {
-			if (post_data && strlen(post_data)) {
-				strcat(notify->post_data, "&");
-			}
-			strcat(notify->post_data, args);
-		}
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_close_cb(void* arg) {
+	struct espconn* conn = (struct espconn*)arg;
+	Notify_Conn_T* c;
+	if (!conn) {
+		return;
 	}
-	notify->done_cb = done_cb;
-	notify->recv_cb = recv_cb;
-	notify->owner = owner;
-	notify->dns.reverse = notify;
-	notify->timeout = timeout_ms;
-	notify->method = method;
-	len_plus_spaces = len + (rule_count_char(url, ' ') * 2);
-	if (!(storage = calloc(1, len_plus_spaces + 1))) {
-		goto error;
+	if (conn->reverse) {
+		notify_close(arg);
+		return;
 	}
-	buffer_init(&buffer, len_plus_spaces + 1, storage);
-	for (i = 0; i < len; i++) {
-		if (url[i] == ' ') {
-			buffer_puts(&buffer, "%20");
-			continue;
-		}
-		buffer_write(&buffer, url[i]);
+	if (!(c = notify_pool_find(conn))) {
+		return;
 	}
-	slash_init(&slash, buffer_string(&buffer), '/');
+	debug_describe_P("Notify pool close");
+	if (c->target.ssl) {
+		espconn_secure_delete(conn);
+	} else {
+		espconn_delete(conn);
+	}
+	notify_pool_release(conn);
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_error_cb(void* arg, sint8 errType) {
+	struct espconn* conn = (struct espconn*)arg;
+	Notify_Conn_T* c;
+	if (!conn) {
+		return;
+	}
+	if (conn->reverse) {
+		notify_error(arg, errType);
+		return;
+	}
+	if (!(c = notify_pool_find(conn))) {
+		return;
+	}
+	debug_describe_P("Notify pool error");
+	if (c->target.ssl) {
+		espconn_secure_delete(conn);
+	} else {
+		espconn_delete(conn);
+	}
+	notify_pool_release(conn);
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_recv_cb(void* arg, char* data, unsigned short len) {
+	struct espconn* conn = (struct espconn*)arg;
+	Notify_Conn_T* c;
+	if (!conn) {
+		return;
+	}
+	if (conn->reverse) {
+		notify_recv(arg, data, len);
+		return;
+	}
+	/*nothing is expected on an idle connection*/
+	if ((c = notify_pool_find(conn))) {
+		notify_pool_drop(c);
+	}
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_detach(Notify_Conn_T* c) {
+	if (c->state != NOTIFY_CONN_BUSY) {
+		return;
+	}
+	debug_describe_P("Notify pool detach");
+	os_timer_disarm(&c->timer);
+	c->conn.reverse = NULL;
+	c->state = NOTIFY_CONN_DROP;
+	espconn_regist_disconcb(&c->conn, notify_pool_close_cb);
+	espconn_regist_recvcb(&c->conn, notify_pool_recv_cb);
+	/*still connecting, notify_pool_connected_cb or the error callback finish it*/
+	if (c->conn.state == ESPCONN_CONNECT) {
+		notify_pool_disconnect(c);
+	}
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_connected_cb(void* arg) {
+	struct espconn* conn = (struct espconn*)arg;
+	Notify_Conn_T* c;
+	if (!conn) {
+		return;
+	}
+	if (conn->reverse) {
+		notify_connected(arg);
+		return;
+	}
+	if (!(c = notify_pool_find(conn))) {
+		return;
+	}
+	debug_describe_P("Notify pool connected");
+	espconn_regist_disconcb(conn, notify_pool_close_cb);
+	espconn_regist_recvcb(conn, notify_pool_recv_cb);
+	if (c->state == NOTIFY_CONN_DROP) {
+		notify_pool_disconnect(c);
+		return;
+	}
+	c->state = NOTIFY_CONN_IDLE;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_pool_open(Notify_Conn_T* c, Notify_T owner) {
+	memset(&c->conn, 0, sizeof(c->conn));
+	memset(&c->tcp, 0, sizeof(c->tcp));
+	c->conn.reverse = owner;
+	c->conn.type = ESPCONN_TCP;
+	c->conn.state = ESPCONN_NONE;
+	c->conn.proto.tcp = &c->tcp;
+	c->conn.proto.tcp->local_port = espconn_port();
+	c->conn.proto.tcp->remote_port = c->target.port;
+	memcpy(&c->conn.proto.tcp->remote_ip, &c->ip, 4);
+	espconn_set_opt(&c->conn, ESPCONN_REUSEADDR | ESPCONN_NODELAY);
+	espconn_regist_connectcb(&c->conn, notify_pool_connected_cb);
+	espconn_regist_reconcb(&c->conn, notify_pool_error_cb);
+	if (c->target.ssl) {
+		if (espconn_secure_connect(&c->conn)) {
+			return 0;
+		}
+		notify_tls_count(0);
+	} else {
+		if (espconn_connect(&c->conn)) {
+			return 0;
+		}
+	}
+	debug_printf("Notify pool connecting " IPSTR "\n", IP2STR(&c->ip));
+	return 1;
+}
+
+static void ICACHE_FLASH_ATTR notify_pool_dns_cb(const char* name, ip_addr_t* ipaddr, void* arg) {
+	struct espconn* dns = (struct espconn*)arg;
+	Notify_Conn_T* c;
+	if (!dns || !(c = dns->reverse) || (c->state != NOTIFY_CONN_RESOLVING)) {
+		return;
+	}
+	if (!name || !ipaddr) {
+		notify_pool_release(&c->conn);
+		return;
+	}
+	c->ip = *ipaddr;
+	notify_dns_cache_put(c->target.host, &c->ip);
+	if (!notify_pool_open(c, NULL)) {
+		notify_pool_release(&c->conn);
+		return;
+	}
+	c->state = NOTIFY_CONN_CONNECTING;
+}
+
+static Notify_Conn_T* ICACHE_FLASH_ATTR notify_pool_free(void) {
+	uint8_t i;
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		if (pool[i].state == NOTIFY_CONN_FREE) {
+			return &pool[i];
+		}
+	}
+	return NULL;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_pool_match(Notify_Conn_T* c, Notify_T notify) {
+	if (!c || !notify || !notify->host) {
+		return 0;
+	}
+	if (strcmp(c->target.host, notify->host) ||
+		(c->target.port != notify->port) ||
+		(c->target.ssl != notify->ssl)) {
+		return 0;
+	}
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_pool_adopt(Notify_T notify) {
+	Notify_Conn_T* found = NULL;
+	Notify_Conn_T* c;
+	uint8_t i;
+	if (!notify) {
+		return 0;
+	}
+	/*targets sent in parallel open their own connections, only one of them*/
+	/*adopts a matching entry, reuse pays off between gestures*/
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		c = &pool[i];
+		switch (c->state) {
+			case NOTIFY_CONN_CONNECTING:
+			case NOTIFY_CONN_IDLE:
+				if (!found && notify_pool_match(c, notify)) {
+					found = c;
+					continue;
+				}
+				break;
+			case NOTIFY_CONN_RESOLVING:
+				break;
+			default:
+				continue;
+		}
+		/*gesture went elsewhere, sdk keeps only one secure connection*/
+		if (c->warm || (c->target.ssl && notify->ssl)) {
+			notify_pool_drop(c);
+		}
+	}
+	if (!found) {
+		return 0;
+	}
+	debug_describe_P("Notify use pool");
+	os_timer_disarm(&found->timer);
+	found->conn.reverse = notify;
+	notify->current_conn = &found->conn;
+	notify->ip = found->ip;
+	if (found->state == NOTIFY_CONN_IDLE) {
+		if (found->target.ssl) {
+			notify_tls_count(1);
+		}
+		notify->reused = 1;
+		/*send from task context, the caller keeps the handle first*/
+		os_timer_setfn(&found->timer, notify_pool_adopted_cb, found);
+		os_timer_arm(&found->timer, 0, 0);
+	}
+	found->state = NOTIFY_CONN_BUSY;
+	found->warm = 0;
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_pool_connect(Notify_T notify) {
+	Notify_Conn_T* c;
+	if (!notify || !pool_keep_alive || !notify->recv_cb || !notify->host) {
+		return 0;
+	}
+	if ((strlen(notify->host) >= NOTIFY_TARGET_HOST_SIZE) || !(c = notify_pool_free())) {
+		return 0;
+	}
+	memset(&c->target, 0, sizeof(Notify_Target_T));
+	strcpy(c->target.host, notify->host);
+	c->target.port = notify->port;
+	c->target.ssl = notify->ssl;
+	c->ip = notify->ip;
+	c->warm = 0;
+	if (!notify_pool_open(c, notify)) {
+		return 0;
+	}
+	c->state = NOTIFY_CONN_BUSY;
+	notify->current_conn = &c->conn;
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_pool_idle(Notify_T notify) {
+	Notify_Conn_T* c;
+	if (!notify || !(c = notify_pool_find(notify->current_conn)) || (c->state != NOTIFY_CONN_BUSY)) {
+		return 0;
+	}
+	os_timer_disarm(&notify->timer);
+	notify->current_conn = NULL;
+	c->conn.reverse = NULL;
+	c->state = NOTIFY_CONN_IDLE;
+	espconn_regist_disconcb(&c->conn, notify_pool_close_cb);
+	espconn_regist_recvcb(&c->conn, notify_pool_recv_cb);
+	os_timer_disarm(&c->timer);
+	os_timer_setfn(&c->timer, notify_pool_timeout_cb, c);
+	os_timer_arm(&c->timer, NOTIFY_POOL_IDLE, 0);
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_body(Notify_T notify, const char* post_data, const char* args) {
+	size_t body_len = 1;
+	if (!notify) {
+		return 0;
+	}
+	if (!(post_data && strlen(post_data)) &&
+		!(args && strlen(args) && ((notify->method == NS_METHOD_POST) || (notify->method == NS_METHOD_PUT)))) {
+		return 1;
+	}
+	if (post_data) {
+		body_len += strlen(post_data);
+	}
+	if (args) {
+		body_len += strlen(args);
+	}
+	if (!(notify->post_data = calloc(1, body_len + 1))) {
+		return 0;
+	}
+	if (post_data && strlen(post_data)) {
+		strcat(notify->post_data, post_data);
+	}
+	if (args && strlen(args)) {
+		if (post_data && strlen(post_data)) {
+			strcat(notify->post_data, "&");
+		}
+		strcat(notify->post_data, args);
+	}
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_parse(Notify_T notify, const char* url, const char* post_data, const char* args) {
+	uint8_t* storage = NULL;
+	struct Buffer_T buffer;
+	size_t len;
+	size_t len_plus_spaces;
+	size_t path_len;
+	size_t i;
+	Slash_T slash;
+	char* server;
+	char* port;
+	char* at;
+	char* proto;
+	uint8_t require_question = 0;
+	if (!notify || !url) {
+		return 0;
+	}
+	len = strlen(url);
+	len_plus_spaces = len + (rule_count_char(url, ' ') * 2);
+	if (!(storage = calloc(1, len_plus_spaces + 1))) {
+		goto error;
+	}
+	buffer_init(&buffer, len_plus_spaces + 1, storage);
+	for (i = 0; i < len; i++) {
+		if (url[i] == ' ') {
+			buffer_puts(&buffer, "%20");
+			continue;
+		}
+		buffer_write(&buffer, url[i]);
+	}
+	slash_init(&slash, buffer_string(&buffer), '/');
 	if (!(proto = slash_next(&slash))) {
 		debug_describe_P("Notify no protocol");
 		goto error;
@@ -469,7 +1153,7 @@ Notify_T ICACHE_FLASH_ATTR notify_new(
 	if (slash_have_next(&slash)) {
 		path_len += strlen(slash_current(&slash));
 	}
-	if (((method == NS_METHOD_GET) || (method == NS_METHOD_DELETE)) && !post_data && args && strlen(args)) {
+	if (((notify->method == NS_METHOD_GET) || (notify->method == NS_METHOD_DELETE)) && !post_data && args && strlen(args)) {
 		path_len += strlen(args) + 1;
 	}
 	if (!(notify->path = calloc(1, path_len + 1))) {
@@ -482,7 +1166,7 @@ Notify_T ICACHE_FLASH_ATTR notify_new(
 		}
 		strncpy(notify->path + 1 + require_question, slash_current(&slash), path_len - 1 - require_question);
 	}
-	if (((method == NS_METHOD_GET) || (method == NS_METHOD_DELETE)) && !post_data && args && strlen(args)) {
+	if (((notify->method == NS_METHOD_GET) || (notify->method == NS_METHOD_DELETE)) && !post_data && args && strlen(args)) {
 		if (strrchr(notify->path, (int)'?')) {
 			strcat(notify->path, "&");
 		} else {
@@ -491,46 +1175,495 @@ Notify_T ICACHE_FLASH_ATTR notify_new(
 		strcat(notify->path, args);
 	}
 	debug_printf("Notify server: %s:%d, path: %s\n", notify->host, (int)notify->port, notify->path);
-	if (rule_check_ip(notify->host, &notify->server_ip.addr)) {
+	free(storage);
+	return 1;
+error:
+	free(storage);
+	return 0;
+}
+
+static char* ICACHE_FLASH_ATTR notify_line(Notify_T notify) {
+	struct Buffer_T request;
+	char* line;
+	size_t len;
+	if (!notify || !notify->path) {
+		return NULL;
+	}
+	len = 7 + strlen(notify->path) + 1;
+	if (!(line = calloc(1, len))) {
+		return NULL;
+	}
+	buffer_init(&request, len, (uint8_t*)line);
+	if (notify->method == NS_METHOD_DELETE) {
+		buffer_puts(&request, "DELETE ");
+	} else {
+		if ((notify->method == NS_METHOD_POST) ||
+			(notify->method == NS_METHOD_PUT) ||
+			notify->post_data) {
+			if (notify->method == NS_METHOD_POST) {
+				buffer_puts(&request, "POST ");
+			} else {
+				buffer_puts(&request, "PUT ");
+			}
+		} else {
+			buffer_puts(&request, "GET ");
+		}
+	}
+	buffer_puts(&request, notify->path);
+	return line;
+}
+
+static char* ICACHE_FLASH_ATTR notify_head(Notify_T notify, const char* headers) {
+	struct Buffer_T request;
+	char* head;
+	size_t len;
+	if (!notify || !notify->host) {
+		return NULL;
+	}
+	len = 11 + 2;
+	len += strlen(notify->host) + 7 + 6 + 2;
+	if (headers) {
+		len += strlen(headers) + 2;
+	}
+	if (notify->auth) {
+		len += strlen(notify->auth) + 21 + 2;
+	}
+	if (!(head = calloc(1, len + 1))) {
+		return NULL;
+	}
+	buffer_init(&request, len + 1, (uint8_t*)head);
+	buffer_puts(&request, " HTTP/1.1" CRLF);
+
+	buffer_puts(&request, "Host: ");
+	buffer_puts(&request, notify->host);
+	buffer_puts(&request, ":");
+	buffer_dec(&request, notify->port);
+	buffer_puts(&request, CRLF);
+
+	if (headers) {
+		buffer_puts(&request, headers);
+		if (!buffer_equal_from_end_str(&request, CRLF)) {
+			buffer_puts(&request, CRLF);
+		}
+	}
+	if (notify->auth) {
+		buffer_puts(&request, "Authorization: Basic ");
+		buffer_puts(&request, notify->auth);
+		buffer_puts(&request, CRLF);
+	}
+	return head;
+}
+
+/*request line and header are built before connect, only the body follows them*/
+static uint8_t ICACHE_FLASH_ATTR notify_prepare(Notify_T notify) {
+	if (!notify) {
+		return 0;
+	}
+	if (!(notify->line = notify_line(notify)) ||
+		!(notify->head = notify_head(notify, notify->headers))) {
+		return 0;
+	}
+	free(notify->path);
+	notify->path = NULL;
+	free(notify->headers);
+	notify->headers = NULL;
+	free(notify->auth);
+	notify->auth = NULL;
+	return 1;
+}
+
+static Notify_T ICACHE_FLASH_ATTR notify_alloc(
+	void (*done_cb)(Notify_T notify, uint8_t error),
+	uint8_t (*recv_cb)(Notify_T notify, uint8_t* data, uint32_t len),
+	void* owner,
+	uint32_t timeout_ms,
+	Ns_Method_T method)
+{
+	Notify_T notify;
+	if (!(notify = malloc(sizeof(struct Notify_T)))) {
+		debug_describe_P("Can't alloc notify");
+		return NULL;
+	}
+	debug_describe_P("New notify");
+	memset(notify, 0, sizeof(struct Notify_T));
+	memset(&notify->dns, 0, sizeof(notify->dns));
+	notify->done_cb = done_cb;
+	notify->recv_cb = recv_cb;
+	notify->owner = owner;
+	notify->dns.reverse = notify;
+	notify->timeout = timeout_ms;
+	notify->method = method;
+	return notify;
+}
+
+static uint8_t ICACHE_FLASH_ATTR notify_start(Notify_T notify) {
+	uint8_t refresh = 0;
+	if (!notify || !notify->host) {
+		return 0;
+	}
+	if (notify_pool_adopt(notify)) {
+		return 1;
+	}
+	if (notify->server_ip.addr || rule_check_ip(notify->host, &notify->server_ip.addr)) {
 		debug_printf("Notify immediate IP:" IPSTR "\n", IP2STR(&notify->server_ip));
 		notify->ip = notify->server_ip;
-		if (!notify_connect_by_ip(notify)) {
+		return notify_connect_by_ip(notify);
+	}
+	if (notify_dns_cache_get(notify->host, &notify->server_ip, &refresh)) {
+		debug_printf("Notify cached IP:" IPSTR "\n", IP2STR(&notify->server_ip));
+		notify->ip = notify->server_ip;
+		notify->cached = 1;
+		notify->refresh = refresh;
+		return notify_connect_by_ip(notify);
+	}
+	return notify_resolve(notify);
+}
+
+Notify_T ICACHE_FLASH_ATTR notify_new(
+	const char* url,
+	const char* headers,
+	const char* post_data,
+	const char* args,
+	void (*done_cb)(Notify_T notify, uint8_t error),
+	uint8_t (*recv_cb)(Notify_T notify, uint8_t* data, uint32_t len),
+	void* owner,
+	uint32_t timeout_ms,
+	Ns_Method_T method)
+{
+	Notify_T notify;
+	if (!url) {
+		debug_describe_P("No URL");
+		return NULL;
+	}
+	if (!strlen(url)) {
+		debug_describe_P("URL zero len");
+		return NULL;
+	}
+	if (!(notify = notify_alloc(done_cb, recv_cb, owner, timeout_ms, method))) {
+		return NULL;
+	}
+	if (headers && strlen(headers)) {
+		if (!(notify->headers = strdup(headers))) {
 			goto error;
 		}
-		free(storage);
-		return notify;
 	}
-	notify->server_ip.addr = 0;
-	err = espconn_gethostbyname(&notify->dns, notify->host, &notify->server_ip, notify_dns_cb);
-	switch (err) {
-		case ESPCONN_OK:
-			debug_printf("Notify server IP:" IPSTR "\n", IP2STR(&notify->server_ip));
-			notify->ip = notify->server_ip;
-			if (!notify_connect_by_ip(notify)) {
-				goto error;
-			}
-			free(storage);
-			return notify;
-		case ESPCONN_INPROGRESS:
-			os_timer_disarm(&notify->timer);
-			os_timer_setfn(&notify->timer, notify_dns_timeout_cb, notify);
-			os_timer_arm(&notify->timer, 10000, 0);
-			free(storage);
-			return notify;
-		case ESPCONN_ARG:
-			break;
+	debug_value(method);
+	if (!notify_body(notify, post_data, args)) {
+		goto error;
+	}
+	if (!notify_parse(notify, url, post_data, args) ||
+		!notify_prepare(notify) ||
+		!notify_start(notify)) {
+		goto error;
 	}
+	return notify;
 error:
-	free(storage);
 	notify_delete(notify);
 	return NULL;
 }
 
+uint16_t ICACHE_FLASH_ATTR notify_plan(
+	const char* url,
+	const char* headers,
+	const char* headers_args,
+	const char* post_data,
+	Ns_Method_T method,
+	Buffer_T plan)
+{
+	Notify_Plan_T header;
+	Notify_T notify;
+	char* line = NULL;
+	char* head = NULL;
+	char* head_args = NULL;
+	uint16_t begin;
+	uint16_t ret_val = 0;
+	if (!url || !strlen(url) || !plan) {
+		return 0;
+	}
+	if (!(notify = notify_alloc(NULL, NULL, NULL, 0, method))) {
+		return 0;
+	}
+	if (!notify_body(notify, post_data, NULL) ||
+		!notify_parse(notify, url, post_data, NULL) ||
+		!(line = notify_line(notify)) ||
+		!(head = notify_head(notify, (headers && strlen(headers)) ? headers : NULL))) {
+		goto done;
+	}
+	if (headers_args && strlen(headers_args)) {
+		if (!(head_args = notify_head(notify, headers_args))) {
+			goto done;
+		}
+	}
+	memset(&header, 0, sizeof(header));
+	header.method = method;
+	header.ssl = notify->ssl;
+	header.port = notify->port;
+	rule_check_ip(notify->host, &header.ip.addr);
+	header.host_len = strlen(notify->host) + 1;
+	header.line_len = strlen(line) + 1;
+	header.head_len = strlen(head) + 1;
+	header.head_args_len = head_args ? (strlen(head_args) + 1) : 0;
+	header.body_len = notify->post_data ? (strlen(notify->post_data) + 1) : 0;
+	header.len = sizeof(header) + header.host_len + header.line_len + header.head_len + header.head_args_len + header.body_len;
+	/*keep records word aligned for flash*/
+	header.len = (header.len + 3) & ~3;
+	begin = buffer_size(plan);
+	buffer_append(plan, (uint8_t*)&header, sizeof(header));
+	buffer_append(plan, (uint8_t*)notify->host, header.host_len);
+	buffer_append(plan, (uint8_t*)line, header.line_len);
+	buffer_append(plan, (uint8_t*)head, header.head_len);
+	if (head_args) {
+		buffer_append(plan, (uint8_t*)head_args, header.head_args_len);
+	}
+	if (notify->post_data) {
+		buffer_append(plan, (uint8_t*)notify->post_data, header.body_len);
+	}
+	while (!buffer_overflow(plan) && ((buffer_size(plan) - begin) < header.len)) {
+		buffer_write(plan, 0);
+	}
+	if (buffer_overflow(plan)) {
+		debug_describe_P("Notify plan overflow");
+		goto done;
+	}
+	ret_val = header.len;
+done:
+	free(line);
+	free(head);
+	free(head_args);
+	notify_delete(notify);
+	return ret_val;
+}
+
+uint16_t ICACHE_FLASH_ATTR notify_plan_size(const uint8_t* plan) {
+	Notify_Plan_T header;
+	if (!plan) {
+		return 0;
+	}
+	memcpy(&header, plan, sizeof(header));
+	return header.len;
+}
+
+uint8_t ICACHE_FLASH_ATTR notify_plan_ssl(const uint8_t* plan) {
+	Notify_Plan_T header;
+	if (!plan) {
+		return 0;
+	}
+	memcpy(&header, plan, sizeof(header));
+	return header.ssl;
+}
+
+Notify_T ICACHE_FLASH_ATTR notify_new_plan(
+	const uint8_t* plan,
+	const char* args,
+	void (*done_cb)(Notify_T notify, uint8_t error),
+	uint8_t (*recv_cb)(Notify_T notify, uint8_t* data, uint32_t len),
+	void* owner,
+	uint32_t timeout_ms)
+{
+	Notify_Plan_T header;
+	Notify_T notify;
+	const char* host;
+	const char* line;
+	const char* head;
+	const char* body = NULL;
+	uint8_t query;
+	size_t len;
+	if (!plan) {
+		return NULL;
+	}
+	memcpy(&header, plan, sizeof(header));
+	if ((header.len < sizeof(header)) || !header.host_len || !header.line_len || !header.head_len) {
+		debug_describe_P("Bad notify plan");
+		return NULL;
+	}
+	host = (const char*)plan + sizeof(header);
+	line = host + header.host_len;
+	head = line + header.line_len;
+	if (header.body_len) {
+		body = head + header.head_len + header.head_args_len;
+	}
+	query = (((header.method == NS_METHOD_GET) || (header.method == NS_METHOD_DELETE)) && !body && args && strlen(args)) ? 1 : 0;
+	if (header.head_args_len && args && strlen(args)) {
+		/*content type depends on args*/
+		head += header.head_len;
+	}
+	if (!(notify = notify_alloc(done_cb, recv_cb, owner, timeout_ms, header.method))) {
+		return NULL;
+	}
+	notify->ssl = header.ssl;
+	notify->port = header.port;
+	notify->server_ip = header.ip;
+	len = strlen(line) + 1;
+	if (query) {
+		len += strlen(args) + 1;
+	}
+	if (!notify_body(notify, body, args) ||
+		!(notify->host = strdup(host)) ||
+		!(notify->head = strdup(head)) ||
+		!(notify->line = calloc(1, len))) {
+		goto error;
+	}
+	strcpy(notify->line, line);
+	if (query) {
+		if (strrchr(notify->line, (int)'?')) {
+			strcat(notify->line, "&");
+		} else {
+			strcat(notify->line, "?");
+		}
+		strcat(notify->line, args);
+	}
+	debug_printf("Notify plan server: %s:%d\n", notify->host, (int)notify->port);
+	if (!notify_start(notify)) {
+		goto error;
+	}
+	return notify;
+error:
+	notify_delete(notify);
+	return NULL;
+}
+
+/*target of a plan record, len may cover only the record start*/
+uint8_t ICACHE_FLASH_ATTR notify_plan_target(const uint8_t* plan, uint16_t len, Notify_Target_T* target) {
+	Notify_Plan_T header;
+	const char* host;
+	if (!plan || !target || (len < sizeof(header))) {
+		return 0;
+	}
+	memcpy(&header, plan, sizeof(header));
+	host = (const char*)plan + sizeof(header);
+	if (!header.host_len || (header.host_len > sizeof(target->host)) || (header.host_len > (len - sizeof(header)))) {
+		return 0;
+	}
+	if (host[header.host_len - 1]) {
+		return 0;
+	}
+	memset(target, 0, sizeof(Notify_Target_T));
+	memcpy(target->host, host, header.host_len);
+	target->port = header.port;
+	target->ssl = header.ssl;
+	return 1;
+}
+
+/*target of a http or https url, credentials and path are left out*/
+uint8_t ICACHE_FLASH_ATTR notify_url_target(const char* url, Notify_Target_T* target) {
+	const char* host;
+	const char* end;
+	const char* at;
+	const char* port;
+	if (!url || !target) {
+		return 0;
+	}
+	memset(target, 0, sizeof(Notify_Target_T));
+	if (!strncmp(url, "https://", 8)) {
+		target->ssl = 1;
+		host = url + 8;
+	} else if (!strncmp(url, "http://", 7)) {
+		host = url + 7;
+	} else {
+		return 0;
+	}
+	end = host + strcspn(host, "/?#");
+	if ((at = memchr(host, '@', end - host))) {
+		host = at + 1;
+	}
+	if ((port = memchr(host, ':', end - host))) {
+		target->port = atoi(port + 1);
+		end = port;
+	} else {
+		target->port = target->ssl ? 443 : 80;
+	}
+	if ((end == host) || ((end - host) >= sizeof(target->host))) {
+		return 0;
+	}
+	memcpy(target->host, host, end - host);
+	return 1;
+}
+
+uint8_t ICACHE_FLASH_ATTR notify_warm(const Notify_Target_T* target) {
+	Notify_Conn_T* c;
+	uint8_t refresh;
+	uint8_t i;
+	if (!target || !strlen(target->host)) {
+		return 0;
+	}
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		if ((pool[i].state != NOTIFY_CONN_FREE) && !memcmp(&pool[i].target, target, sizeof(Notify_Target_T))) {
+			return 1;
+		}
+	}
+	if (!(c = notify_pool_free())) {
+		return 0;
+	}
+	debug_printf("Notify warm: %s:%d\n", target->host, (int)target->port);
+	memcpy(&c->target, target, sizeof(Notify_Target_T));
+	c->ip.addr = 0;
+	c->warm = 1;
+	os_timer_disarm(&c->timer);
+	os_timer_setfn(&c->timer, notify_pool_timeout_cb, c);
+	if (rule_check_ip(c->target.host, &c->ip.addr) || notify_dns_cache_get(c->target.host, &c->ip, &refresh)) {
+		if (!notify_pool_open(c, NULL)) {
+			return 0;
+		}
+		c->state = NOTIFY_CONN_CONNECTING;
+	} else {
+		memset(&c->dns, 0, sizeof(c->dns));
+		c->dns.reverse = c;
+		switch (espconn_gethostbyname(&c->dns, c->target.host, &c->ip, notify_pool_dns_cb)) {
+			case ESPCONN_OK:
+				if (!notify_pool_open(c, NULL)) {
+					return 0;
+				}
+				c->state = NOTIFY_CONN_CONNECTING;
+				break;
+			case ESPCONN_INPROGRESS:
+				c->state = NOTIFY_CONN_RESOLVING;
+				break;
+			default:
+				return 0;
+		}
+	}
+	os_timer_arm(&c->timer, NOTIFY_POOL_WARM, 0);
+	return 1;
+}
+
+void ICACHE_FLASH_ATTR notify_keep_alive(uint8_t yes) {
+	pool_keep_alive = yes ? 1 : 0;
+	if (!pool_keep_alive) {
+		notify_pool_close();
+	}
+}
+
+void ICACHE_FLASH_ATTR notify_pool_close(void) {
+	uint8_t i;
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		if (!pool[i].conn.reverse) {
+			notify_pool_drop(&pool[i]);
+		}
+	}
+}
+
+void ICACHE_FLASH_ATTR notify_tls_stats(uint32_t* handshakes, uint32_t* reused) {
+	RTC_TLS_T* stats = notify_tls();
+	if (handshakes) {
+		*handshakes = stats->handshakes;
+	}
+	if (reused) {
+		*reused = stats->reused;
+	}
+}
+
 void ICACHE_FLASH_ATTR notify_delete(Notify_T notify) {
+	uint8_t i;
 	if (!notify) {
 		return;
 	}
 	debug_describe_P("Notify delete");
+	for (i = 0; i < ARRAY_SIZE(pool); i++) {
+		if (pool[i].conn.reverse == notify) {
+			notify_pool_detach(&pool[i]);
+			pool[i].conn.reverse = NULL;
+		}
+	}
 	if (notify->host) {
 		free(notify->host);
 	}
@@ -546,6 +1679,12 @@ void ICACHE_FLASH_ATTR notify_delete(Notify_T notify) {
 	if (notify->post_data) {
 		free(notify->post_data);
 	}
+	if (notify->line) {
+		free(notify->line);
+	}
+	if (notify->head) {
+		free(notify->head);
+	}
 	free(notify);
 }
 
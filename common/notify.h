@@ -20,11 +20,33 @@
 #include "json.h"
 #include "buffer.h"
 #include "ns.h"
+#include <ip_addr.h>
 
 #define NOTIFY_HEADER_SIZE (1024)
+#define NOTIFY_TARGET_HOST_SIZE (64)
 
 typedef struct Notify_T* Notify_T;
 
+typedef struct {
+	char host[NOTIFY_TARGET_HOST_SIZE];
+	uint16_t port;
+	uint8_t ssl;
+} Notify_Target_T;
+
+/*prebuilt request, followed by host, line, head, head_args and body strings*/
+typedef struct {
+	uint16_t len;
+	uint8_t method;
+	uint8_t ssl;
+	uint16_t port;
+	uint16_t host_len;
+	ip_addr_t ip;
+	uint16_t line_len;
+	uint16_t head_len;
+	uint16_t head_args_len;
+	uint16_t body_len;
+} Notify_Plan_T;
+
 Notify_T notify_new(const char* url,
 					const char* headers,
 					const char* post_data,
@@ -34,6 +56,26 @@ Notify_T notify_new(const char* url,
 					void* owner,
 					uint32_t timeout_ms,
 					Ns_Method_T method);
+Notify_T notify_new_plan(const uint8_t* plan,
+					const char* args,
+					void (*done_cb)(Notify_T notify, uint8_t error),
+					uint8_t (*recv_cb)(Notify_T notify, uint8_t* data, uint32_t len),
+					void* owner,
+					uint32_t timeout_ms);
+uint16_t notify_plan(const char* url,
+					const char* headers,
+					const char* headers_args,
+					const char* post_data,
+					Ns_Method_T method,
+					Buffer_T plan);
+uint16_t notify_plan_size(const uint8_t* plan);
+uint8_t notify_plan_ssl(const uint8_t* plan);
+uint8_t notify_plan_target(const uint8_t* plan, uint16_t len, Notify_Target_T* target);
+uint8_t notify_url_target(const char* url, Notify_Target_T* target);
+uint8_t notify_warm(const Notify_Target_T* target);
+void notify_keep_alive(uint8_t yes);
+void notify_pool_close(void);
+void notify_tls_stats(uint32_t* handshakes, uint32_t* reused);
 void notify_delete(Notify_T notify);
 void* notify_owner(Notify_T notify);
 void notify_timeout(Notify_T notify, uint32_t time);
@@ -38,35 +38,81 @@ typedef struct {
 	char* args;
 	char* headers;
 	Json_T json;
+	uint8_t* plan;
 	void* owner;
 	Ns_Recv_Cb recv_cb;
 	Ns_Done_Cb done_cb;
 	Ns_Method_T method;
 } Ns_Item_T;
 
-struct Ns_T {
-	Http_Request_T event[3];
-	List_T list;
+typedef struct {
+	Ns_T ns;
 	Notify_T notify;
 	void* owner;
 	Ns_Recv_Cb recv_cb;
 	Ns_Done_Cb done_cb;
+	Notify_Target_T target;
+	uint8_t ssl : 1;
+	uint8_t done : 1;
+	uint8_t pooled : 1;
+} Ns_Slot_T;
+
+struct Ns_T {
+	Http_Request_T event[3];
+	List_T list;
+	Ns_Slot_T slot[NS_SLOTS_MAX];
 	uint32_t timeout;
+	uint8_t slots : 3;
 	uint8_t connected : 1;
-	uint8_t done : 1;
+	uint8_t keep_alive : 1;
 };
 
 static void ICACHE_FLASH_ATTR ns_send_done_cb(Notify_T notify, uint8_t error);
 static uint8_t ICACHE_FLASH_ATTR ns_recv_cb(Notify_T notify, uint8_t* data, uint32_t len);
 static uint8_t ICACHE_FLASH_ATTR ns_send(Ns_T ns);
 
+static uint8_t ICACHE_FLASH_ATTR ns_item_is_ssl(Ns_Item_T* item) {
+	if (!item) {
+		return 0;
+	}
+	if (item->plan) {
+		return notify_plan_ssl(item->plan);
+	}
+	if (!item->url) {
+		return 0;
+	}
+	return strncmp(item->url, "https://", 8) ? 0 : 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR ns_item_target(Ns_Item_T* item, Notify_Target_T* target) {
+	if (item->plan) {
+		return notify_plan_target(item->plan, notify_plan_size(item->plan), target);
+	}
+	return notify_url_target(item->url, target);
+}
+
+static void ICACHE_FLASH_ATTR ns_item_free(Ns_Item_T* item) {
+	if (!item) {
+		return;
+	}
+	free(item->args);
+	free(item->headers);
+	free(item->url);
+	free(item->plan);
+}
+
 Ns_T ICACHE_FLASH_ATTR ns_new(void) {
 	Ns_T ns;
+	uint8_t i;
 	if (!(ns = malloc(sizeof(struct Ns_T)))) {
 		return NULL;
 	}
 	memset(ns, 0, sizeof(struct Ns_T));
 	ns->timeout = 10000;
+	ns->slots = 1;
+	for (i = 0; i < ARRAY_SIZE(ns->slot); i++) {
+		ns->slot[i].ns = ns;
+	}
 	if (!(ns->list = list_new(sizeof(Ns_Item_T)))) {
 		free(ns);
 		return NULL;
@@ -89,21 +135,85 @@ void ICACHE_FLASH_ATTR ns_timeout(Ns_T ns, uint32_t time_ms) {
 	ns->timeout = time_ms;
 }
 
-static void ICACHE_FLASH_ATTR ns_done(Ns_T ns, uint8_t error) {
+void ICACHE_FLASH_ATTR ns_slots(Ns_T ns, uint8_t slots) {
+	if (!ns) {
+		return;
+	}
+	if (!slots) {
+		slots = 1;
+	}
+	if (slots > NS_SLOTS_MAX) {
+		slots = NS_SLOTS_MAX;
+	}
+	ns->slots = slots;
+	ns_send(ns);
+}
+
+void ICACHE_FLASH_ATTR ns_keep_alive(Ns_T ns, uint8_t yes) {
+	if (!ns) {
+		return;
+	}
+	ns->keep_alive = yes ? 1 : 0;
+	notify_keep_alive(yes);
+}
+
+/*kept alive connections are of no use once the device goes to sleep*/
+void ICACHE_FLASH_ATTR ns_pool_close(Ns_T ns) {
+	if (!ns) {
+		return;
+	}
+	notify_pool_close();
+}
+
+static uint8_t ICACHE_FLASH_ATTR ns_busy(Ns_T ns, uint8_t ssl_only) {
+	uint8_t i;
+	uint8_t count = 0;
+	if (!ns) {
+		return 0;
+	}
+	for (i = 0; i < ARRAY_SIZE(ns->slot); i++) {
+		if (!ns->slot[i].notify) {
+			continue;
+		}
+		if (ssl_only && !ns->slot[i].ssl) {
+			continue;
+		}
+		count++;
+	}
+	return count;
+}
+
+static Ns_Slot_T* ICACHE_FLASH_ATTR ns_free_slot(Ns_T ns) {
+	uint8_t i;
 	if (!ns) {
+		return NULL;
+	}
+	for (i = 0; i < ns->slots; i++) {
+		if (!ns->slot[i].notify && !ns->slot[i].done) {
+			return &ns->slot[i];
+		}
+	}
+	return NULL;
+}
+
+static void ICACHE_FLASH_ATTR ns_done(Ns_Slot_T* slot, uint8_t error) {
+	Ns_T ns;
+	if (!slot || !(ns = slot->ns)) {
 		return;
 	}
-	if (ns->done || error) {
+	if (slot->done || error) {
 		debug_describe_P("NS done");
-		Ns_Done_Cb done_cb = ns->done_cb;
-		void* owner = ns->owner;
-		ns->done = 0;
-		ns->recv_cb = NULL;
-		ns->done_cb = NULL;
-		ns->owner = NULL;
-		if (ns->notify) {
-			notify_delete(ns->notify);
-			ns->notify = NULL;
+		Ns_Done_Cb done_cb = slot->done_cb;
+		void* owner = slot->owner;
+		slot->done = 0;
+		slot->ssl = 0;
+		slot->pooled = 0;
+		slot->recv_cb = NULL;
+		slot->done_cb = NULL;
+		slot->owner = NULL;
+		if (slot->notify) {
+			notify_delete(slot->notify);
+			slot->notify = NULL;
 		}
 		if (done_cb) {
 			debug_describe_P("NS make done cb");
@@ -112,117 +222,146 @@ static void ICACHE_FLASH_ATTR ns_done(Ns_T ns, uint8_t error) {
 			debug_describe_P("NS no done cb");
 		}
 		#ifdef BUTTON
-		sleep_unlock(SLEEP_NS);
+		if (!ns_busy(ns, 0)) {
+			sleep_unlock(SLEEP_NS);
+		}
 		#endif
 		debug_value(system_get_free_heap_size());
 		ns_send(ns);
 	} else {
 		debug_describe_P("NS doing");
-		ns->done = 1;
+		slot->done = 1;
 	}
 }
 
-static uint8_t ICACHE_FLASH_ATTR ns_send(Ns_T ns) {
-	Ns_Item_T item;
+static uint8_t ICACHE_FLASH_ATTR ns_send_slot(Ns_T ns, Ns_Slot_T* slot, Ns_Item_T* item) {
 	uint8_t ret_val = 0;
-	if (!ns) {
-		return 0;
-	}
-	if (!ns->connected) {
-		return 1;
-	}
-	if (ns->notify) {
-		return 1;
-	}
-	if (!list_read(ns->list, 0, &item)) {
+	if (!ns || !slot || !item) {
 		return 0;
 	}
-	list_remove(ns->list, 0);
-	ns->recv_cb = item.recv_cb;
-	ns->done_cb = item.done_cb;
-	ns->owner = item.owner;
-	ns->done = 0;
-	if (item.json) {
-		struct Buffer_T test;
-		uint8_t storage[8];
+	slot->recv_cb = item->recv_cb;
+	slot->done_cb = item->done_cb;
+	slot->owner = item->owner;
+	slot->ssl = ns_item_is_ssl(item);
+	slot->pooled = (ns->keep_alive && item->recv_cb && ns_item_target(item, &slot->target)) ? 1 : 0;
+	slot->done = 0;
+	if (item->json) {
 		Buffer_T buffer;
 		uint16_t json_len;
-		buffer_init(&test, sizeof(storage), storage);
-		json_print(item.json, &test, 0);
-		json_len = buffer_overflow(&test) + buffer_capacity(&test);
+		json_len = json_measure(item->json);
 		debug_value(json_len);
 		if ((buffer = buffer_new(json_len + 1))) {
-			json_print(item.json, buffer, 0);
-			json_delete(item.json);
-			ns->notify = notify_new(item.url,
-									item.headers,
+			json_print(item->json, buffer, 0);
+			json_delete(item->json);
+			slot->notify = notify_new(item->url,
+									item->headers,
 									buffer_string(buffer),
 									NULL,
 									ns_send_done_cb,
-									ns->recv_cb ? ns_recv_cb : NULL,
-									ns,
+									slot->recv_cb ? ns_recv_cb : NULL,
+									slot,
 									ns->timeout,
-									item.method);
+									item->method);
 			buffer_delete(buffer);
 		} else {
 			debug_describe_P("!!!No space left for NS buffer");
-			json_delete(item.json);
+			json_delete(item->json);
 		}
 	} else {
-		if (item.body) {
-			ns->notify = notify_new(item.url,
-									item.headers,
-									item.body,
-									item.args,
+		if (item->plan) {
+			slot->notify = notify_new_plan(item->plan,
+									item->args,
 									ns_send_done_cb,
-									ns->recv_cb ? ns_recv_cb : NULL,
-									ns,
-									ns->timeout,
-									item.method);
+									slot->recv_cb ? ns_recv_cb : NULL,
+									slot,
+									ns->timeout);
 		} else {
-			ns->notify = notify_new(item.url,
-									item.headers,
-									NULL,
-									item.args,
+			slot->notify = notify_new(item->url,
+									item->headers,
+									item->body,
+									item->args,
 									ns_send_done_cb,
-									ns->recv_cb ? ns_recv_cb : NULL,
-									ns,
+									slot->recv_cb ? ns_recv_cb : NULL,
+									slot,
 									ns->timeout,
-									item.method);
+									item->method);
 		}
 	}
-	free(item.headers);
-	free(item.url);
-	free(item.args);
+	ns_item_free(item);
 	#ifdef BUTTON
-		if (ns->notify) {
+		if (slot->notify) {
 			sleep_lock(SLEEP_NS);
 		}
 	#endif
-	if (ns->notify) {
+	if (slot->notify) {
 		ret_val = 1;
 	}
-	ns_done(ns, ret_val ? 0 : 1);
+	ns_done(slot, ret_val ? 0 : 1);
+	return ret_val;
+}
+
+/*a request to a server that already has one in flight waits for its kept alive connection*/
+static uint8_t ICACHE_FLASH_ATTR ns_item_waits(Ns_T ns, Ns_Item_T* item) {
+	Notify_Target_T target;
+	uint8_t i;
+	if (!ns->keep_alive || !item->recv_cb || !ns_item_target(item, &target)) {
+		return 0;
+	}
+	for (i = 0; i < ARRAY_SIZE(ns->slot); i++) {
+		if (ns->slot[i].notify && ns->slot[i].pooled && !memcmp(&ns->slot[i].target, &target, sizeof(target))) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static uint8_t ICACHE_FLASH_ATTR ns_send(Ns_T ns) {
+	Ns_Item_T item;
+	Ns_Slot_T* slot;
+	uint16_t index;
+	uint8_t ret_val = 1;
+	if (!ns) {
+		return 0;
+	}
+	if (!ns->connected) {
+		return 1;
+	}
+	while ((slot = ns_free_slot(ns))) {
+		for (index = 0; list_read(ns->list, index, &item); index++) {
+			if (!ns_item_waits(ns, &item)) {
+				break;
+			}
+		}
+		if (index >= list_size(ns->list)) {
+			return ns_busy(ns, 0) ? 1 : 0;
+		}
+		/*sdk handles only one secure connection at a time*/
+		if (ns_item_is_ssl(&item) && ns_busy(ns, 1)) {
+			return 1;
+		}
+		list_remove(ns->list, index);
+		ret_val = ns_send_slot(ns, slot, &item);
+	}
 	return ret_val;
 }
 
 static void ICACHE_FLASH_ATTR ns_send_done_cb(Notify_T notify, uint8_t error) {
-	Ns_T ns;
-	if (!notify || !(ns = notify_owner(notify))) {
+	Ns_Slot_T* slot;
+	if (!notify || !(slot = notify_owner(notify))) {
 		return;
 	}
 	debug_describe_P("Notify send done cb");
-	ns_done(ns, error);
+	ns_done(slot, error);
 }
 
 static uint8_t ICACHE_FLASH_ATTR ns_recv_cb(Notify_T notify, uint8_t* data, uint32_t len) {
-	Ns_T ns;
-	if (!notify || !(ns = notify_owner(notify))) {
+	Ns_Slot_T* slot;
+	if (!notify || !(slot = notify_owner(notify))) {
 		return 0;
 	}
 	debug_describe_P("NS recv");
-	if (ns->recv_cb) {
-		return ns->recv_cb(ns->owner, data, len);
+	if (slot->recv_cb) {
+		return slot->recv_cb(slot->owner, data, len);
 	}
 	return 0;
 }
@@ -275,29 +414,35 @@ uint8_t ICACHE_FLASH_ATTR ns_post(Ns_T ns,
 	return 1;
 }
 
+char* ICACHE_FLASH_ATTR ns_multi_next(char** url) {
+	char* begin;
+	char* part;
+	if (!url || !(begin = *url) || !(*begin)) {
+		return NULL;
+	}
+	if ((part = strstr(begin, "||"))) {
+		while ((*part) == '|') {
+			*part = '\0';
+			part++;
+		}
+	}
+	*url = part;
+	return begin;
+}
+
 uint16_t ICACHE_FLASH_ATTR ns_multi_query(Ns_T ns, char* url, const char* args,
 		void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb) {
-	char* begin;
 	char* part;
 	uint16_t count = 0;
 	if (!ns || !url || !strlen(url)) {
 		return 0;
 	}
-	begin = url;
-	while (begin && *begin) {
-		if ((part = strstr(begin, "||"))) {
-			while ((*part) == '|') {
-				*part = '\0';
-				part++;
-			}
+	while ((part = ns_multi_next(&url))) {
+		if (!ns_query(ns, part, args, owner, recv_cb, done_cb)) {
+			break;
 		}
-		if (!ns_query(ns, begin, args, owner, recv_cb, done_cb)) {
-			goto done;
-		}
-		begin = part;
 		count++;
 	}
-done:
 	return count;
 }
 
@@ -389,8 +534,7 @@ static uint8_t ICACHE_FLASH_ATTR ns_post_data_is_json(const char* data) {
 	return 1;
 }
 
-uint8_t ICACHE_FLASH_ATTR ns_query(Ns_T ns, const char* url, const char* args,
-		void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb) {
+static uint8_t ICACHE_FLASH_ATTR ns_parse(const char* url, const char* args, Ns_Item_T* out) {
 	struct Buffer_T buffer;
 	char* url_dup = NULL;
 	char* post_data = NULL;
@@ -420,7 +564,7 @@ uint8_t ICACHE_FLASH_ATTR ns_query(Ns_T ns, const char* url, const char* args,
 			uint16_t soap : 1;
 		};
 	} is;
-	if (!ns || !url || !strlen(url)) {
+	if (!url || !strlen(url) || !out) {
 		return 0;
 	}
 	if (!(url_dup = calloc(1, strlen(url) + 10))) {
@@ -576,21 +720,135 @@ uint8_t ICACHE_FLASH_ATTR ns_query(Ns_T ns, const char* url, const char* args,
 	if (args) {
 		item.args = strdup(args);
 	}
+	*out = item;
+	return 1;
+
+error:
+	free(item.args);
+	free(item.headers);
+	if (url_dup) {
+		free(url_dup);
+	}
+	return 0;
+}
+
+uint8_t ICACHE_FLASH_ATTR ns_query(Ns_T ns, const char* url, const char* args,
+		void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb) {
+	Ns_Item_T item;
+	if (!ns || !url || !strlen(url)) {
+		return 0;
+	}
+	if (!ns_parse(url, args, &item)) {
+		return 0;
+	}
 	item.owner = owner;
 	item.recv_cb = recv_cb;
 	item.done_cb = done_cb;
 	if (!(list_add(ns->list, &item))) {
-		goto error;
+		ns_item_free(&item);
+		return 0;
 	}
 	ns_send(ns);
 	return 1;
+}
 
-error:
-	free(item.args);
-	free(item.headers);
-	if (url_dup) {
-		free(url_dup);
+uint8_t ICACHE_FLASH_ATTR ns_warm(Ns_T ns, uint8_t** plans, uint16_t* lens, uint8_t count) {
+	Notify_Target_T target;
+	Notify_Target_T other;
+	uint8_t found = 0;
+	uint8_t i;
+	if (!ns || !plans || !lens || !ns->connected || ns_busy(ns, 0)) {
+		return 0;
+	}
+	/*connect ahead only when every gesture goes to the same server*/
+	for (i = 0; i < count; i++) {
+		if (!plans[i] || !lens[i]) {
+			continue;
+		}
+		if (!notify_plan_target(plans[i], lens[i], found ? &other : &target)) {
+			return 0;
+		}
+		if (found && memcmp(&target, &other, sizeof(Notify_Target_T))) {
+			return 0;
+		}
+		found = 1;
+	}
+	if (!found) {
+		return 0;
+	}
+	return notify_warm(&target);
+}
+
+uint16_t ICACHE_FLASH_ATTR ns_plan(char* url, Buffer_T plan) {
+	Ns_Item_T item;
+	Ns_Item_T item_args;
+	char* part;
+	uint16_t count = 0;
+	uint16_t len;
+	if (!url || !strlen(url) || !plan) {
+		return 0;
 	}
+	while ((part = ns_multi_next(&url))) {
+		if (!ns_parse(part, NULL, &item)) {
+			return 0;
+		}
+		/*content type may change when args are given*/
+		if (!ns_parse(part, "", &item_args)) {
+			ns_item_free(&item);
+			return 0;
+		}
+		if (item.headers && item_args.headers && !strcmp(item.headers, item_args.headers)) {
+			free(item_args.headers);
+			item_args.headers = NULL;
+		}
+		len = notify_plan(item.url, item.headers, item_args.headers, item.body, item.method, plan);
+		ns_item_free(&item);
+		ns_item_free(&item_args);
+		if (!len) {
+			return 0;
+		}
+		count++;
+	}
+	return count;
+}
+
+uint16_t ICACHE_FLASH_ATTR ns_plan_next(const uint8_t* plan, uint16_t len, uint16_t offset) {
+	uint16_t size;
+	if (!plan || ((offset + sizeof(Notify_Plan_T)) > len)) {
+		return 0;
+	}
+	size = notify_plan_size(plan + offset);
+	if ((size < sizeof(Notify_Plan_T)) || ((offset + size) > len)) {
+		debug_describe_P("NS bad plan");
+		return 0;
+	}
+	return size;
+}
+
+uint8_t ICACHE_FLASH_ATTR ns_plan_query(Ns_T ns, const uint8_t* plan, uint16_t size, const char* args,
+		void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb) {
+	Ns_Item_T item;
+	if (!ns || !plan || (size < sizeof(Notify_Plan_T))) {
+		return 0;
+	}
+	memset(&item, 0, sizeof(Ns_Item_T));
+	if (!(item.plan = malloc(size))) {
+		return 0;
+	}
+	memcpy(item.plan, plan, size);
+	if (args && !(item.args = strdup(args))) {
+		goto error;
+	}
+	item.owner = owner;
+	item.recv_cb = recv_cb;
+	item.done_cb = done_cb;
+	if (!(list_add(ns->list, &item))) {
+		goto error;
+	}
+	ns_send(ns);
+	return 1;
+error:
+	ns_item_free(&item);
 	return 0;
 }
 
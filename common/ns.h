@@ -20,6 +20,10 @@
 #include "json.h"
 #include "http.h"
 
+#define NS_SLOTS_MAX 4
+/*leading bytes of a plan that hold where its first request goes*/
+#define NS_PLAN_HEAD_SIZE 96
+
 typedef struct Ns_T* Ns_T;
 
 typedef uint8_t (*Ns_Recv_Cb)(void* owner, uint8_t* data, uint32_t len);
@@ -42,7 +46,15 @@ uint16_t ns_size(Ns_T ns);
 uint8_t ns_connect(Ns_T ns, uint8_t yes);
 uint8_t ns_connected(Ns_T ns);
 void ns_timeout(Ns_T ns, uint32_t time_ms);
+void ns_slots(Ns_T ns, uint8_t slots);
+void ns_keep_alive(Ns_T ns, uint8_t yes);
+void ns_pool_close(Ns_T ns);
 uint8_t ns_query(Ns_T ns, const char* url, const char* args, void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb);
+char* ns_multi_next(char** url);
 uint16_t ns_multi_query(Ns_T ns, char* url, const char* args, void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb);
+uint8_t ns_warm(Ns_T ns, uint8_t** plans, uint16_t* lens, uint8_t count);
+uint16_t ns_plan(char* url, Buffer_T plan);
+uint16_t ns_plan_next(const uint8_t* plan, uint16_t len, uint16_t offset);
+uint8_t ns_plan_query(Ns_T ns, const uint8_t* plan, uint16_t size, const char* args, void* owner, Ns_Recv_Cb recv_cb, Ns_Done_Cb done_cb);
 
 #endif
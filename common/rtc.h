@@ -31,6 +31,9 @@ typedef struct {
 	uint32_t sleep_timestamp;
 	uint32_t sleep_period;
 	uint32_t begin_timestamp;
+	uint32_t rtc_ticks;
+	uint32_t rtc_cali;
+	int32_t drift;
 } RWC_T;//Wakeup Counter
 
 typedef struct {
@@ -38,11 +41,56 @@ typedef struct {
 	uint32_t value;
 } RTC_GPIO_T;
 
+#define RTC_DNS_HOST_SIZE (32)
+#define RTC_DNS_ENTRIES (4)
+
+typedef struct {
+	char host[RTC_DNS_HOST_SIZE];
+	ip_addr_t ip;
+	uint32_t expire;
+} RTC_DNS_Entry_T;
+
+typedef struct {
+	uint32_t magic;
+	RTC_DNS_Entry_T entry[RTC_DNS_ENTRIES];
+} RTC_DNS_T;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t handshakes;
+	uint32_t reused;
+} RTC_TLS_T;
+
+#define RTC_URL_ENTRIES (6)
+
+typedef struct {
+	uint32_t magic;
+	uint32_t crc[2];
+	uint32_t counter[2];
+	uint16_t len[RTC_URL_ENTRIES];
+	uint8_t valid;
+	uint8_t sector;
+	uint16_t reserved;
+} RTC_URL_T;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t generation;
+	uint32_t digest;
+	uint16_t end;
+	uint8_t sector;
+	uint8_t reserved;
+} RTC_STORE_T;
+
 #define RTC_MAGIC ((uint32_t)0x55AAAA55)
 #define RTC_MODE_OFFSET (64)
 #define RTC_IP_OFFSET (65)
 #define RTC_WC_OFFSET ((sizeof(RTC_IP_T) / 4) + RTC_IP_OFFSET)
-#define RTC_NEXT_OFFSET ((sizeof(RWC_T) / 4) + RTC_WC_OFFSET)
+#define RTC_DNS_OFFSET ((sizeof(RWC_T) / 4) + RTC_WC_OFFSET)
+#define RTC_TLS_OFFSET ((sizeof(RTC_DNS_T) / 4) + RTC_DNS_OFFSET)
+#define RTC_URL_OFFSET ((sizeof(RTC_TLS_T) / 4) + RTC_TLS_OFFSET)
+#define RTC_STORE_OFFSET ((sizeof(RTC_URL_T) / 4) + RTC_URL_OFFSET)
+#define RTC_NEXT_OFFSET ((sizeof(RTC_STORE_T) / 4) + RTC_STORE_OFFSET)
 
 #define RTC_GPIO_OFFSET (190)
 
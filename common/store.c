@@ -25,6 +25,7 @@
 #include "array_size.h"
 #include "slash.h"
 #include "url_storage.h"
+#include "rtc.h"
 
 #define STORE_SECTOR_A 0xFE
 #define STORE_SECTOR_B 0xFF
@@ -33,15 +34,38 @@
 #define STORE_SIZE_BEFORE_VERSION ((uint16_t)304)
 #define STORE_HEADER_SIZE ((uint16_t)8)
 #define STORE_MAX_SIZE ((uint16_t)1024)
+#define STORE_LOG_MAGIC 0x474F4C53
+#define STORE_RECORD_END 0xFFFF
+
+/*
+ * Store sectors hold a log: header, snapshot record and then records with only
+ * the changed span of Store_T. When the active sector is full, a new snapshot
+ * is written to the other one, so erase happens once per sector instead of once
+ * per save. Sector header is written last, record header after its data.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t generation;
+} Store_Log_Header_T;
+
+typedef struct {
+	uint16_t offset;
+	uint16_t len;
+	uint32_t crc;
+} Store_Record_T;
 
 struct Store_T store;
 
+/*store content as it is in flash*/
+static struct Store_T store_image;
+
 struct {
-	uint32_t counter : 20;
-	uint32_t current : 1;
-	uint32_t a : 1;
-	uint32_t b : 1;
-} static store_valid;
+	uint32_t generation;
+	uint32_t digest;
+	uint16_t end;
+	uint8_t sector : 1;
+	uint8_t valid : 1;
+} static store_log;
 
 extern Url_Storage_T url_storage;
 
@@ -140,59 +164,26 @@ static uint8_t ICACHE_FLASH_ATTR store_larger(uint32_t a, uint32_t b, uint8_t* i
 	return 1;
 }
 
-static uint8_t ICACHE_FLASH_ATTR store_store(uint8_t id, uint32_t counter) {
-	Crc_T crc;
-	debug_printf("Write store id: %d, counter: %u\n", (int)id, counter);
-	if (spi_flash_erase_sector(id ? STORE_SECTOR_B : STORE_SECTOR_A) != SPI_FLASH_RESULT_OK) {
-		debug_describe_P("Unable to erase sector");
-		return 0;
-	}
-	crc_init(&crc, STORE_CRC_POLY, 0);
-	store.crc = 0;
-	store.counter = counter;
-	store.len = sizeof(store);
-	store.version = STORE_VERSION;
-	crc_check(&crc, (uint8_t*)&store, sizeof(store));
-	store.crc = crc_last(&crc);
-	if (spi_flash_write((id ? STORE_SECTOR_B : STORE_SECTOR_A) * SPI_FLASH_SEC_SIZE, (uint32_t*)&store, sizeof(store)) == SPI_FLASH_RESULT_OK) {
-		#ifdef PRINT_SAVE_NET
-		debug_printf("SSID: %s\n", store.connect.station.ssid);
-		debug_printf("PWD: %s\n", store.connect.station.password);
-		debug_printf("BSSID: " MACSTR "\n", MAC2STR(store.connect.station.bssid));
-		debug_printf("SET: %d\n", (int)store.connect.station.bssid_set);
-		#endif
-		return 1;
-	}
-	debug_describe_P("Unable to write sector");
-	return 0;
-}
-
 static uint8_t ICACHE_FLASH_ATTR store_select(uint8_t* id) {
 	uint32_t counter_a;
 	uint32_t counter_b;
 	if (!id) {
 		return 0;
 	}
-	store_valid.a = 0;
-	store_valid.b = 0;
 	if (store_load(0, &counter_a)) {
 		if (store_load(1, &counter_b)) {
 			/*two valid store, select newest*/
 			if (store_larger(counter_a, counter_b, id)) {
-				store_valid.a = 1;
-				store_valid.b = 1;
 				debug_describe_P("Store A and B valid");
 				return 1;
 			}
 			return 0;
 		}
-		store_valid.a = 1;
 		*id = 0;
 		debug_describe_P("Only store A valid");
 		return 1;
 	}
 	if (store_load(1, NULL)) {
-		store_valid.b = 1;
 		*id = 1;
 		debug_describe_P("Only store B valid");
 		return 1;
@@ -200,6 +191,275 @@ static uint8_t ICACHE_FLASH_ATTR store_select(uint8_t* id) {
 	return 0;
 }
 
+static uint32_t ICACHE_FLASH_ATTR store_record_crc(const Store_Record_T* record, const uint8_t* data) {
+	Crc_T crc;
+	crc_init(&crc, STORE_CRC_POLY, 0);
+	crc_calculate(&crc, record->offset);
+	crc_calculate(&crc, record->len);
+	return crc_check(&crc, data, record->len) & 0xFFFFFFFF;
+}
+
+static uint32_t ICACHE_FLASH_ATTR store_log_digest(uint32_t digest, uint32_t crc) {
+	return ((digest << 1) | (digest >> 31)) ^ crc;
+}
+
+static uint8_t ICACHE_FLASH_ATTR store_log_read(uint32_t address, const uint8_t* buffer, uint16_t size, uint16_t pos, void* data, uint16_t len) {
+	if (!buffer) {
+		return spi_flash_read(address + pos, (uint32_t*)data, len) == SPI_FLASH_RESULT_OK;
+	}
+	if ((pos + len) > size) {
+		return 0;
+	}
+	memcpy(data, buffer + pos, len);
+	return 1;
+}
+
+/*
+ * With cache the sector is read at once and record CRCs are trusted, log must
+ * end where it did and give same digest.
+ */
+static uint8_t ICACHE_FLASH_ATTR store_log_replay(uint8_t id, const RTC_STORE_T* cache) {
+	Store_Log_Header_T header;
+	Store_Record_T record;
+	uint32_t address = (id ? STORE_SECTOR_B : STORE_SECTOR_A) * SPI_FLASH_SEC_SIZE;
+	uint32_t digest = 0;
+	uint16_t pos = sizeof(header);
+	uint16_t size = 0;
+	uint8_t* buffer = NULL;
+	uint8_t torn = 0;
+	uint8_t ret = 0;
+	memset(&store, 0, sizeof(store));
+	memset(&store_image, 0, sizeof(store_image));
+	if (cache) {
+		if ((cache->end <= sizeof(header)) || ((cache->end + sizeof(record)) > SPI_FLASH_SEC_SIZE) || (cache->end & 3)) {
+			return 0;
+		}
+		size = cache->end + sizeof(record);
+		if (!(buffer = malloc(size))) {
+			return 0;
+		}
+		if (spi_flash_read(address, (uint32_t*)buffer, size) != SPI_FLASH_RESULT_OK) {
+			goto done;
+		}
+	}
+	while ((pos + sizeof(record)) <= SPI_FLASH_SEC_SIZE) {
+		if (!store_log_read(address, buffer, size, pos, &record, sizeof(record))) {
+			goto done;
+		}
+		if (record.offset == STORE_RECORD_END) {
+			break;
+		}
+		if (!record.len || ((record.offset | record.len) & 3) || ((record.offset + record.len) > sizeof(store)) || ((pos + sizeof(record) + record.len) > SPI_FLASH_SEC_SIZE)) {
+			debug_printf("Bad record at %u\n", (uint32_t)pos);
+			torn = 1;
+			break;
+		}
+		/*log must start with snapshot*/
+		if ((pos == sizeof(header)) && (record.offset || (record.len != sizeof(store)))) {
+			goto done;
+		}
+		if (!store_log_read(address, buffer, size, pos + sizeof(record), (uint8_t*)&store + record.offset, record.len)) {
+			goto done;
+		}
+		if (!cache && (store_record_crc(&record, (uint8_t*)&store + record.offset) != record.crc)) {
+			/*torn write, drop rest of log*/
+			debug_printf("Bad CRC in record at %u\n", (uint32_t)pos);
+			memcpy((uint8_t*)&store + record.offset, (uint8_t*)&store_image + record.offset, record.len);
+			torn = 1;
+			break;
+		}
+		memcpy((uint8_t*)&store_image + record.offset, (uint8_t*)&store + record.offset, record.len);
+		digest = store_log_digest(digest, record.crc);
+		pos += sizeof(record) + record.len;
+	}
+	if (pos == sizeof(header)) {
+		goto done;
+	}
+	if (cache && (torn || (pos != cache->end) || (digest != cache->digest))) {
+		goto done;
+	}
+	store_log.digest = digest;
+	store_log.end = pos;
+	store_log.sector = id;
+	/*nothing is appended over a torn record, next save starts a new sector*/
+	store_log.valid = !torn;
+	ret = 1;
+done:
+	free(buffer);
+	return ret;
+}
+
+static uint8_t ICACHE_FLASH_ATTR store_log_load(void) {
+	Store_Log_Header_T a;
+	Store_Log_Header_T b;
+	uint8_t id;
+	memset(&store_log, 0, sizeof(store_log));
+	if ((spi_flash_read(STORE_SECTOR_A * SPI_FLASH_SEC_SIZE, (uint32_t*)&a, sizeof(a)) != SPI_FLASH_RESULT_OK) ||
+		(spi_flash_read(STORE_SECTOR_B * SPI_FLASH_SEC_SIZE, (uint32_t*)&b, sizeof(b)) != SPI_FLASH_RESULT_OK)) {
+		return 0;
+	}
+	if ((a.magic != STORE_LOG_MAGIC) && (b.magic != STORE_LOG_MAGIC)) {
+		return 0;
+	}
+	/*newest generation first, other one is fallback for broken snapshot*/
+	if ((a.magic == STORE_LOG_MAGIC) && (b.magic == STORE_LOG_MAGIC)) {
+		id = ((int32_t)(b.generation - a.generation) > 0) ? 1 : 0;
+	} else {
+		id = (b.magic == STORE_LOG_MAGIC) ? 1 : 0;
+	}
+	if (store_log_replay(id, NULL)) {
+		store_log.generation = id ? b.generation : a.generation;
+		debug_printf("Store log: %u, generation %u, end %u\n", (uint32_t)id, store_log.generation, (uint32_t)store_log.end);
+		return 1;
+	}
+	if ((id ? a.magic : b.magic) == STORE_LOG_MAGIC && store_log_replay(!id, NULL)) {
+		store_log.generation = id ? a.generation : b.generation;
+		/*newer sector is broken, replace it with the next save*/
+		store_log.valid = 0;
+		debug_describe_P(COLOR_RED "Store log fallback" COLOR_END);
+		return 1;
+	}
+	memset(&store_log, 0, sizeof(store_log));
+	return 0;
+}
+
+/*deep sleep wake trusts RTC copy of log position instead of checking all records*/
+static uint8_t ICACHE_FLASH_ATTR store_log_fast(void) {
+	struct rst_info* reset_info = system_get_rst_info();
+	Store_Log_Header_T header;
+	RTC_STORE_T rtc;
+	if (!reset_info || (reset_info->reason != REASON_DEEP_SLEEP_AWAKE)) {
+		return 0;
+	}
+	if (!rtc_read(RTC_STORE_OFFSET, &rtc, sizeof(rtc))) {
+		return 0;
+	}
+	memset(&store_log, 0, sizeof(store_log));
+	if (spi_flash_read((rtc.sector ? STORE_SECTOR_B : STORE_SECTOR_A) * SPI_FLASH_SEC_SIZE, (uint32_t*)&header, sizeof(header)) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	if ((header.magic != STORE_LOG_MAGIC) || (header.generation != rtc.generation)) {
+		return 0;
+	}
+	if (!store_log_replay(rtc.sector, &rtc)) {
+		memset(&store_log, 0, sizeof(store_log));
+		return 0;
+	}
+	store_log.generation = rtc.generation;
+	return 1;
+}
+
+static void ICACHE_FLASH_ATTR store_log_cache(void) {
+	RTC_STORE_T rtc;
+	memset(&rtc, 0, sizeof(rtc));
+	rtc.generation = store_log.generation;
+	rtc.digest = store_log.digest;
+	rtc.end = store_log.end;
+	rtc.sector = store_log.sector;
+	rtc_write(RTC_STORE_OFFSET, &rtc, sizeof(rtc));
+}
+
+/*write only clears bits, what a torn write left behind shows up here*/
+static uint8_t ICACHE_FLASH_ATTR store_log_verify(uint32_t address, const uint8_t* data, uint16_t len) {
+	uint32_t block[16];
+	uint16_t part;
+	while (len) {
+		part = (len < sizeof(block)) ? len : sizeof(block);
+		if (spi_flash_read(address, block, part) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+		if (memcmp(block, data, part)) {
+			return 0;
+		}
+		address += part;
+		data += part;
+		len -= part;
+	}
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR store_log_write(uint32_t address, uint16_t offset, uint16_t len, uint32_t* crc) {
+	Store_Record_T record;
+	const uint8_t* data = (const uint8_t*)&store + offset;
+	record.offset = offset;
+	record.len = len;
+	record.crc = store_record_crc(&record, data);
+	*crc = record.crc;
+	if (spi_flash_write(address + sizeof(record), (uint32_t*)data, len) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	if (!store_log_verify(address + sizeof(record), data, len)) {
+		debug_describe_P("Store record mismatch");
+		return 0;
+	}
+	if (spi_flash_write(address, (uint32_t*)&record, sizeof(record)) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	return store_log_verify(address, (const uint8_t*)&record, sizeof(record));
+}
+
+static uint8_t ICACHE_FLASH_ATTR store_log_compact(void) {
+	Store_Log_Header_T header;
+	uint32_t crc;
+	uint8_t id = !store_log.sector;
+	uint32_t address = (id ? STORE_SECTOR_B : STORE_SECTOR_A) * SPI_FLASH_SEC_SIZE;
+	debug_printf("Store snapshot id: %d, generation: %u\n", (int)id, store_log.generation + 1);
+	if (spi_flash_erase_sector(id ? STORE_SECTOR_B : STORE_SECTOR_A) != SPI_FLASH_RESULT_OK) {
+		debug_describe_P("Unable to erase sector");
+		return 0;
+	}
+	if (!store_log_write(address + sizeof(header), 0, sizeof(store), &crc)) {
+		goto error;
+	}
+	header.magic = STORE_LOG_MAGIC;
+	header.generation = store_log.generation + 1;
+	if (spi_flash_write(address, (uint32_t*)&header, sizeof(header)) != SPI_FLASH_RESULT_OK) {
+		goto error;
+	}
+	memcpy(&store_image, &store, sizeof(store));
+	store_log.generation = header.generation;
+	store_log.digest = store_log_digest(0, crc);
+	store_log.end = sizeof(header) + sizeof(Store_Record_T) + sizeof(store);
+	store_log.sector = id;
+	store_log.valid = 1;
+	return 1;
+error:
+	debug_describe_P("Unable to write sector");
+	return 0;
+}
+
+static uint8_t ICACHE_FLASH_ATTR store_log_append(void) {
+	const uint8_t* current = (const uint8_t*)&store;
+	const uint8_t* image = (const uint8_t*)&store_image;
+	uint32_t crc;
+	uint16_t first = 0;
+	uint16_t last = sizeof(store);
+	while ((first < last) && (current[first] == image[first])) {
+		first++;
+	}
+	if (first == last) {
+		return 1;
+	}
+	while (current[last - 1] == image[last - 1]) {
+		last--;
+	}
+	/*flash access is word aligned*/
+	first &= ~3;
+	last = (last + 3) & ~3;
+	if ((store_log.end + sizeof(Store_Record_T) + (last - first)) > SPI_FLASH_SEC_SIZE) {
+		return store_log_compact();
+	}
+	if (!store_log_write((store_log.sector ? STORE_SECTOR_B : STORE_SECTOR_A) * SPI_FLASH_SEC_SIZE + store_log.end, first, last - first, &crc)) {
+		debug_describe_P("Unable to write record");
+		/*space after broken record is lost, start over*/
+		return store_log_compact();
+	}
+	memcpy((uint8_t*)&store_image + first, current + first, last - first);
+	store_log.digest = store_log_digest(store_log.digest, crc);
+	store_log.end += sizeof(Store_Record_T) + (last - first);
+	return 1;
+}
+
 // This function detects that the configuration using old method (not general) has been defined by the HAEngine
 // and automatically migrates it to general configuration
 static uint8_t ICACHE_FLASH_ATTR store_hae_auto_migration(void) {
@@ -289,38 +549,64 @@ void ICACHE_FLASH_ATTR store_init(void) {
 	/*load data to RAM*/
 	uint32_t counter;
 	uint8_t id;
+	uint8_t save = 0;
 	memset(&store, 0, sizeof(store));
-	if (store_select(&id) && store_load(id, &counter)) {
-		store_valid.current = id;
-		store_valid.counter = counter;
-		debug_printf("Store load: %u, %u\n", (uint32_t)id, counter);
-		uint8_t migrated = 0;
-		switch (store.version) {
-			case 0:
-				break;
-		}
-		migrated += store_hae_auto_migration();
-
-		if (migrated) {
-			store_save();
+	if (store_log_fast()) {
+		debug_describe_P("Store log from RTC");
+	} else if (store_log_load()) {
+		debug_describe_P("Store log loaded");
+		if (store_log.valid) {
+			store_log_cache();
+		} else {
+			/*torn log is compacted first, RTC copy then points to the new snapshot*/
+			save = 1;
 		}
+	} else if (store_select(&id) && store_load(id, &counter)) {
+		debug_printf("Store load: %u, %u\n", (uint32_t)id, counter);
+		/*sector layout before log, first snapshot goes to other sector*/
+		memset(&store_log, 0, sizeof(store_log));
+		store_log.sector = id;
+		save = 1;
 	} else {
 		debug_describe_P(COLOR_RED "CORRUPT STORE" COLOR_END);
 		memset(&store, 0, sizeof(store));
-		store_valid.counter = 0;
-		store_valid.current = 0;
+		memset(&store_log, 0, sizeof(store_log));
 		store.version = STORE_VERSION;
 		store_save();
+		return;
+	}
+	switch (store.version) {
+		case 0:
+			/*done once, version is saved with store*/
+			store_hae_auto_migration();
+			save = 1;
+			break;
+	}
+	if (save) {
+		store_save();
 	}
 }
 
 uint8_t ICACHE_FLASH_ATTR store_save(void) {
-	store_valid.counter++;
-	store_valid.current++;
-	return store_store(store_valid.current, store_valid.counter);
+	uint8_t ret;
+	store.len = sizeof(store);
+	store.version = STORE_VERSION;
+	ret = store_log.valid ? store_log_append() : store_log_compact();
+	if (ret) {
+		store_log_cache();
+	}
+	#ifdef PRINT_SAVE_NET
+	debug_printf("SSID: %s\n", store.connect.station.ssid);
+	debug_printf("PWD: %s\n", store.connect.station.password);
+	debug_printf("BSSID: " MACSTR "\n", MAC2STR(store.connect.station.bssid));
+	debug_printf("SET: %d\n", (int)store.connect.station.bssid_set);
+	#endif
+	return ret;
 }
 
 void ICACHE_FLASH_ATTR store_erase(void) {
+	RTC_STORE_T rtc;
+	rtc_erase(RTC_STORE_OFFSET, &rtc, sizeof(rtc));
 	spi_flash_erase_sector(STORE_SECTOR_A);
 	spi_flash_erase_sector(STORE_SECTOR_B);
 	store_init();
@@ -20,7 +20,7 @@
 #include <user_interface.h>
 #include <ip_addr.h>
 
-#define STORE_VERSION ((uint32_t)0)
+#define STORE_VERSION ((uint32_t)1)
 #define STORE_PASSWORD_LENGTH 256//Must be aligned to 4
 
 typedef struct {
@@ -72,6 +72,8 @@ struct Store_T {
 	uint8_t veryfication;
 	uint8_t bssid_enable : 1;
 	char name[51];
+	/*url types whose queued events merge into one request, bit per Url_Storage_Type_T*/
+	uint8_t merge_types;
 };
 
 void store_init(void);
@@ -19,8 +19,148 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <c_types.h>
+#include <osapi.h>
+#include <user_interface.h>
 #include "timer.h"
 
+/*os timer may fire a little early*/
+#define TIMER_GROUP_SLACK_US (500)
+
+static void ICACHE_FLASH_ATTR timer_group_fire(void* arg);
+
+static void ICACHE_FLASH_ATTR timer_group_arm(Timer_Group_T group) {
+	Timer_T timer;
+	uint32_t now;
+	int32_t wait = -1;
+	int32_t left;
+	if (!group || group->busy) {
+		return;
+	}
+	os_timer_disarm(&group->os_timer);
+	if (group->pending) {
+		wait = 0;
+	} else {
+		now = system_get_time();
+		for (timer = group->first; timer; timer = timer->next) {
+			if (!timer->start) {
+				continue;
+			}
+			if (timer->now) {
+				wait = 0;
+				break;
+			}
+			if (!timer->counter) {
+				continue;
+			}
+			left = (int32_t)(timer->deadline - now);
+			if (left < 0) {
+				left = 0;
+			}
+			if ((wait < 0) || (left < wait)) {
+				wait = left;
+			}
+		}
+	}
+	if (wait < 0) {
+		return;
+	}
+	os_timer_setfn(&group->os_timer, timer_group_fire, group);
+	os_timer_arm(&group->os_timer, (wait + 999) / 1000, 0);
+}
+
+static void ICACHE_FLASH_ATTR timer_group_fire(void* arg) {
+	Timer_Group_T group = arg;
+	Timer_T timer;
+	uint32_t now;
+	if (!group) {
+		return;
+	}
+	group->busy = 1;
+	group->pending = 0;
+	now = system_get_time();
+	for (timer = group->first; timer; timer = timer->next) {
+		if (!timer->start) {
+			continue;
+		}
+		if (timer->now) {
+			timer->now = 0;
+			if (timer->lapse) {
+				timer->lapse(timer->owner);
+			}
+		}
+		if (!timer->counter || ((int32_t)(timer->deadline - now) > TIMER_GROUP_SLACK_US)) {
+			continue;
+		}
+		if (timer->repeat) {
+			timer->counter = timer->time;
+			timer->deadline += timer->time * group->tick_us;
+			if ((int32_t)(timer->deadline - now) < 0) {
+				timer->deadline = now + (timer->time * group->tick_us);
+			}
+		} else {
+			timer->counter = 0;
+			timer->start = 0;
+		}
+		timer->event = 1;
+		if (timer->lapse) {
+			timer->lapse(timer->owner);
+		}
+	}
+	if (group->dispatch) {
+		group->dispatch(group->owner);
+	}
+	group->busy = 0;
+	timer_group_arm(group);
+}
+
+static void ICACHE_FLASH_ATTR timer_group_sync(Timer_T timer) {
+	if (!timer->group || !timer->start) {
+		return;
+	}
+	timer->deadline = system_get_time() + (timer->counter * timer->group->tick_us);
+}
+
+static uint16_t ICACHE_FLASH_ATTR timer_group_left(Timer_T timer) {
+	int32_t left;
+	left = (int32_t)(timer->deadline - system_get_time());
+	if (left <= 0) {
+		return 0;
+	}
+	return (left + timer->group->tick_us - 1) / timer->group->tick_us;
+}
+
+Timer_Group_T ICACHE_FLASH_ATTR timer_group_init(Timer_Group_T group, uint16_t tick_ms, void* owner, void (*dispatch)(void* owner)) {
+	if (!group || !tick_ms) {
+		return NULL;
+	}
+	memset(group, 0, sizeof(struct Timer_Group_T));
+	os_timer_disarm(&group->os_timer);
+	group->tick_us = (uint32_t)tick_ms * 1000;
+	group->owner = owner;
+	group->dispatch = dispatch;
+	return group;
+}
+
+uint8_t ICACHE_FLASH_ATTR timer_group_add(Timer_Group_T group, Timer_T timer) {
+	if (!group || !timer || timer->group) {
+		return 0;
+	}
+	timer->group = group;
+	timer->next = group->first;
+	group->first = timer;
+	timer_group_sync(timer);
+	timer_group_arm(group);
+	return 1;
+}
+
+void ICACHE_FLASH_ATTR timer_group_stop(Timer_Group_T group) {
+	if (!group) {
+		return;
+	}
+	os_timer_disarm(&group->os_timer);
+	group->pending = 0;
+}
+
 Timer_T ICACHE_FLASH_ATTR timer_new(uint16_t time, void* owner, void (*lapse)(void* owner)) {
 	Timer_T timer;
 	if (!(timer = (void*)malloc(sizeof(struct Timer_T)))) {
@@ -52,6 +192,8 @@ void ICACHE_FLASH_ATTR timer_set(Timer_T timer, uint16_t time) {
 	}
 	timer->time = time;
 	timer->counter = timer->time;
+	timer_group_sync(timer);
+	timer_group_arm(timer->group);
 }
 
 void ICACHE_FLASH_ATTR timer_free(Timer_T timer) {
@@ -72,16 +214,26 @@ void ICACHE_FLASH_ATTR timer_start(Timer_T timer) {
 	if (!timer) {
 		return;
 	}
+	if (timer->start) {
+		return;
+	}
 	timer->start = 1;
+	timer_group_sync(timer);
+	timer_group_arm(timer->group);
 }
 
 void ICACHE_FLASH_ATTR timer_stop(Timer_T timer) {
 	if (!timer) {
 		return;
 	}
+	if (timer->group && timer->start && timer->counter) {
+		/*keep what is left for timer_start*/
+		timer->counter = timer_group_left(timer);
+	}
 	timer->start = 0;
 	timer->now = 0;
 	timer->event = 0;
+	timer_group_arm(timer->group);
 }
 
 void ICACHE_FLASH_ATTR timer_restart(Timer_T timer) {
@@ -90,6 +242,8 @@ void ICACHE_FLASH_ATTR timer_restart(Timer_T timer) {
 	}
 	timer->counter = timer->time;
 	timer->start = 1;
+	timer_group_sync(timer);
+	timer_group_arm(timer->group);
 }
 
 void ICACHE_FLASH_ATTR timer_reset(Timer_T timer) {
@@ -97,13 +251,16 @@ void ICACHE_FLASH_ATTR timer_reset(Timer_T timer) {
 		return;
 	}
 	timer->counter = timer->time;
+	timer_group_sync(timer);
+	timer_group_arm(timer->group);
 }
 
 void ICACHE_FLASH_ATTR timer_clk(Timer_T timer) {
 	if (!timer) {
 		return;
 	}
-	if (!timer->start) {
+	/*grouped timers are clocked by their deadline*/
+	if (!timer->start || timer->group) {
 		return;
 	}
 	if (timer->now) {
@@ -144,6 +301,7 @@ void ICACHE_FLASH_ATTR timer_now(Timer_T timer) {
 	}
 	if (timer->start) {
 		timer->now = 1;
+		timer_group_arm(timer->group);
 	}
 }
 
@@ -163,6 +321,10 @@ void ICACHE_FLASH_ATTR timer_notify(Timer_T timer) {
 		return;
 	}
 	timer->event = 1;
+	if (timer->group) {
+		timer->group->pending = 1;
+		timer_group_arm(timer->group);
+	}
 }
 
 uint16_t ICACHE_FLASH_ATTR timer_counter(Timer_T timer) {
@@ -170,6 +332,9 @@ uint16_t ICACHE_FLASH_ATTR timer_counter(Timer_T timer) {
 	if (!timer) {
 		return 0;
 	}
+	if (timer->group && timer->start && timer->counter) {
+		return timer_group_left(timer);
+	}
 	ret_val = timer->counter;
 	return ret_val;
 }
@@ -188,6 +353,8 @@ void ICACHE_FLASH_ATTR timer_set_counter(Timer_T timer, uint16_t counter) {
 		return;
 	}
 	timer->counter = counter;
+	timer_group_sync(timer);
+	timer_group_arm(timer->group);
 }
 
 uint8_t ICACHE_FLASH_ATTR timer_is_start(Timer_T timer) {
@@ -17,14 +17,19 @@
 #define TIMER_H_INCLUDED 1
 
 #include <inttypes.h>
+#include <os_type.h>
 
 typedef struct Timer_T* Timer_T;
+typedef struct Timer_Group_T* Timer_Group_T;
 
 struct Timer_T {
 	void* owner;
 	void (*lapse)(void* owner);
 	uint16_t time;
 	uint16_t counter;
+	uint32_t deadline;
+	Timer_Group_T group;
+	Timer_T next;
 	union {
 		uint8_t flags;
 		struct {
@@ -36,6 +41,20 @@ struct Timer_T {
 	};
 };
 
+/*timers sharing one os_timer armed for the nearest deadline, idle when none runs*/
+struct Timer_Group_T {
+	os_timer_t os_timer;
+	Timer_T first;
+	void* owner;
+	void (*dispatch)(void* owner);
+	uint32_t tick_us;
+	uint8_t busy : 1;
+	uint8_t pending : 1;
+};
+
+Timer_Group_T timer_group_init(Timer_Group_T group, uint16_t tick_ms, void* owner, void (*dispatch)(void* owner));
+uint8_t timer_group_add(Timer_Group_T group, Timer_T timer);
+void timer_group_stop(Timer_Group_T group);
 Timer_T timer_new(uint16_t time, void* owner, void (*lapse)(void* owner));
 Timer_T timer_init(Timer_T timer, uint16_t time, void* owner, void (*lapse)(void* owner));
 void timer_free(Timer_T timer);
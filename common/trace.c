@@ -0,0 +1,86 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <osapi.h>
+#include <user_interface.h>
+#include "trace.h"
+#include "debug.h"
+
+#if defined(DEBUG_PRINTF) || defined(TRACE_STAGES)
+
+static const char* const trace_name[__TRACE_MAX] = {
+	"wake",
+	"wifi",
+	"dhcp",
+	"conn",
+	"action",
+	"dns",
+	"connect",
+	"response",
+	"done",
+};
+
+static uint32_t trace_time[__TRACE_MAX];
+static uint8_t trace_reported = 0;
+
+/*first mark of each stage since boot wins, time in us from boot*/
+void ICACHE_FLASH_ATTR trace_mark(Trace_Stage_T stage) {
+	if (stage >= __TRACE_MAX) {
+		return;
+	}
+	if (trace_time[stage]) {
+		return;
+	}
+	trace_time[stage] = system_get_time();
+	if (!trace_time[stage]) {
+		trace_time[stage] = 1;
+	}
+}
+
+/*time of the first mark, zero when the stage was not reached*/
+uint32_t ICACHE_FLASH_ATTR trace_get(Trace_Stage_T stage) {
+	if (stage >= __TRACE_MAX) {
+		return 0;
+	}
+	return trace_time[stage];
+}
+
+const char* ICACHE_FLASH_ATTR trace_stage_name(Trace_Stage_T stage) {
+	if (stage >= __TRACE_MAX) {
+		return "";
+	}
+	return trace_name[stage];
+}
+
+/*one json line per wake, collected from uart to build the latency histograms*/
+void ICACHE_FLASH_ATTR trace_report(void) {
+	uint8_t i;
+	uint8_t first = 1;
+	if (trace_reported) {
+		return;
+	}
+	trace_reported = 1;
+	os_printf("TRACE {");
+	for (i = 0; i < __TRACE_MAX; i++) {
+		if (!trace_time[i]) {
+			continue;
+		}
+		os_printf("%s\"%s\":%u", first ? "" : ",", trace_name[i], trace_time[i]);
+		first = 0;
+	}
+	os_printf("}\n");
+}
+
+#endif
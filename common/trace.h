@@ -0,0 +1,48 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED 1
+
+#include <inttypes.h>
+
+/*wake to action stages, in the order they normally happen*/
+typedef enum {
+	TRACE_WAKE,
+	TRACE_WIFI,
+	TRACE_DHCP,
+	TRACE_CONN,
+	TRACE_ACTION,
+	TRACE_DNS,
+	TRACE_CONNECT,
+	TRACE_RESPONSE,
+	TRACE_DONE,
+	__TRACE_MAX
+} Trace_Stage_T;
+
+/*debug builds report on the uart, TRACE_STAGES keeps the marks for the host bench*/
+#if defined(DEBUG_PRINTF) || defined(TRACE_STAGES)
+void trace_mark(Trace_Stage_T stage);
+uint32_t trace_get(Trace_Stage_T stage);
+const char* trace_stage_name(Trace_Stage_T stage);
+void trace_report(void);
+#else
+#define trace_mark(stage)
+#define trace_get(stage) 0
+#define trace_stage_name(stage) ""
+#define trace_report()
+#endif
+
+#endif
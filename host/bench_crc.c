@@ -0,0 +1,83 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// One 4 KB flash sector through the CRC, bit by bit division against the
+// flash tables: as words with the URL poly the way url_storage checks its
+// sectors, as bytes with the store poly the way store_load does. ns per sector
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "crc.h"
+#include "crc_bitwise.h"
+#include "test.h"
+
+#define STORE_CRC_POLY 0x1EDC6F41
+#define URL_CRC_POLY 0x741B8CD7
+#define BENCH_CRC_SECTOR 4096
+#define BENCH_CRC_ROUNDS 2000
+
+static uint64_t bench_crc_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+int main(void) {
+	static uint32_t sector[BENCH_CRC_SECTOR / sizeof(uint32_t)];
+	uint64_t start;
+	uint64_t words_bits;
+	uint64_t words_table;
+	uint64_t bytes_bits;
+	uint64_t bytes_table;
+	uint64_t bits = 0;
+	uint64_t table = 0;
+	uint32_t i;
+	Crc_T crc;
+	for (i = 0; i < sizeof(sector); i++) {
+		((uint8_t*)sector)[i] = rand();
+	}
+	start = bench_crc_now();
+	for (i = 0; i < BENCH_CRC_ROUNDS; i++) {
+		crc_init(&crc, URL_CRC_POLY, 0);
+		bits ^= crc_bitwise_check_words(&crc, sector, sizeof(sector) / sizeof(uint32_t));
+	}
+	words_bits = bench_crc_now() - start;
+	start = bench_crc_now();
+	for (i = 0; i < BENCH_CRC_ROUNDS; i++) {
+		crc_init(&crc, URL_CRC_POLY, 0);
+		table ^= crc_check_words(&crc, sector, sizeof(sector) / sizeof(uint32_t));
+	}
+	words_table = bench_crc_now() - start;
+	start = bench_crc_now();
+	for (i = 0; i < BENCH_CRC_ROUNDS; i++) {
+		crc_init(&crc, STORE_CRC_POLY, 0);
+		bits ^= crc_bitwise_check(&crc, (const uint8_t*)sector, sizeof(sector));
+	}
+	bytes_bits = bench_crc_now() - start;
+	start = bench_crc_now();
+	for (i = 0; i < BENCH_CRC_ROUNDS; i++) {
+		crc_init(&crc, STORE_CRC_POLY, 0);
+		table ^= crc_check(&crc, (const uint8_t*)sector, sizeof(sector));
+	}
+	bytes_table = bench_crc_now() - start;
+	/*same results, and the loops can not be left out*/
+	CHECK(bits == table);
+	CHECK(words_table < words_bits);
+	CHECK(bytes_table < bytes_bits);
+	printf("{\"bench\":\"crc\",\"sector\":%u,\"url_words_bitwise_ns\":%llu,\"url_words_table_ns\":%llu,"
+		"\"store_bytes_bitwise_ns\":%llu,\"store_bytes_table_ns\":%llu}\n", BENCH_CRC_SECTOR,
+		(unsigned long long)(words_bits / BENCH_CRC_ROUNDS), (unsigned long long)(words_table / BENCH_CRC_ROUNDS),
+		(unsigned long long)(bytes_bits / BENCH_CRC_ROUNDS), (unsigned long long)(bytes_table / BENCH_CRC_ROUNDS));
+	TEST_DONE("bench crc");
+}
@@ -0,0 +1,142 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Dispatch of REST requests to the pages of the firmware: the sorted route
+// table against walking every registered page, ns per request. The route
+// helpers are static, so http.c is compiled into the bench itself
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "http.c"
+#include "shim.h"
+#include "test.h"
+
+#define BENCH_HTTP_ROUNDS 20000
+
+uint8_t wifi_http(Http_T http);
+uint8_t control_http(Http_T http);
+uint8_t device_http(Http_T http);
+uint8_t boot_http(Http_T http);
+
+typedef struct {
+	const char* request;
+	uint8_t found;
+} Bench_Http_Case_T;
+
+static const Bench_Http_Case_T bench_http_case[] = {
+	{"GET /api/v1/device/self HTTP/1.1\r\n\r\n", 1},
+	{"POST /api/v1/device/self HTTP/1.1\r\nContent-Length: 0\r\n\r\n", 1},
+	{"GET /api/v1/info HTTP/1.1\r\n\r\n", 1},
+	{"GET /api/v1/scan HTTP/1.1\r\n\r\n", 1},
+	{"GET /api/v1/name HTTP/1.1\r\n\r\n", 1},
+	{"GET /api/v1/action/double HTTP/1.1\r\n\r\n", 1},
+	{"GET /api/v1/settings HTTP/1.1\r\n\r\n", 1},
+	{"GET /help HTTP/1.1\r\n\r\n", 1},
+	{"GET /api/v1/unknown HTTP/1.1\r\n\r\n", 0}
+};
+
+#define BENCH_HTTP_CASES (sizeof(bench_http_case) / sizeof(bench_http_case[0]))
+
+static uint64_t bench_http_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/*the page http_recv would run, by route table or by the page list*/
+static const struct Http_Page_T* bench_http_dispatch(Http_Request_T request, uint8_t routed) {
+	const struct Http_Page_T* page = NULL;
+	const struct Http_Page_T* candidate;
+	char* path_copy;
+	char* index;
+	char* args;
+	char* query;
+	uint16_t i;
+	free(request->path);
+	request->page = NULL;
+	if (!(path_copy = strdup(parser_path(request->parser))) || !(request->path = strdup(path_copy))) {
+		free(path_copy);
+		return NULL;
+	}
+	if (http_route_split(path_copy, &index, &args, &query)) {
+		if (routed) {
+			page = http_route_page(request, path_copy, index, args, query);
+		} else {
+			for (i = 0; !page && list_read(request->http->list, i, &candidate); i++) {
+				if (http_page_match(request, candidate, path_copy, index, args, query)) {
+					page = request->page;
+				}
+			}
+		}
+	}
+	free(path_copy);
+	return page;
+}
+
+int main(void) {
+	struct Http_Request_T request[BENCH_HTTP_CASES];
+	const struct Http_Page_T* page;
+	uint64_t start;
+	uint64_t routed;
+	uint64_t walked;
+	uint32_t round;
+	uint32_t i;
+	const char* c;
+	Http_T http;
+	shim_boot(REASON_DEFAULT_RST);
+	CHECK((http = http_new()));
+	wifi_http(http);
+	control_http(http);
+	device_http(http);
+	boot_http(http);
+	for (i = 0; i < BENCH_HTTP_CASES; i++) {
+		memset(&request[i], 0, sizeof(request[i]));
+		request[i].http = http;
+		CHECK((request[i].parser = parser_new()));
+		for (c = bench_http_case[i].request; *c; c++) {
+			parser_do(request[i].parser, *c, strlen(bench_http_case[i].request));
+		}
+		/*both ways pick the same page*/
+		page = bench_http_dispatch(&request[i], 1);
+		CHECK(page == bench_http_dispatch(&request[i], 0));
+		CHECK(!page == !bench_http_case[i].found);
+	}
+	start = bench_http_now();
+	for (round = 0; round < BENCH_HTTP_ROUNDS; round++) {
+		for (i = 0; i < BENCH_HTTP_CASES; i++) {
+			page = bench_http_dispatch(&request[i], 1);
+		}
+	}
+	routed = bench_http_now() - start;
+	start = bench_http_now();
+	for (round = 0; round < BENCH_HTTP_ROUNDS; round++) {
+		for (i = 0; i < BENCH_HTTP_CASES; i++) {
+			page = bench_http_dispatch(&request[i], 0);
+		}
+	}
+	walked = bench_http_now() - start;
+	CHECK(routed < walked);
+	printf("{\"bench\":\"http\",\"pages\":%u,\"routes\":%u,\"requests\":%u,\"route_ns\":%llu,\"walk_ns\":%llu}\n",
+		list_size(http->list), http->routes_amount, (uint32_t)BENCH_HTTP_CASES,
+		(unsigned long long)(routed / (BENCH_HTTP_ROUNDS * BENCH_HTTP_CASES)),
+		(unsigned long long)(walked / (BENCH_HTTP_ROUNDS * BENCH_HTTP_CASES)));
+	for (i = 0; i < BENCH_HTTP_CASES; i++) {
+		free(request[i].path);
+		free(request[i].args_items);
+		free(request[i].query_items);
+		parser_free(request[i].parser);
+	}
+	http_delete(http);
+	TEST_DONE("bench http");
+}
@@ -0,0 +1,72 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// json_parse_values against json_parse plus json_to_values on the same
+// document, ns per parse
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "json.h"
+#include "test.h"
+
+#define BENCH_JSON_ROUNDS 200000
+
+static const Rule_T bench_rule[] = {
+	{.name = "repeat", .type = RULE_UNSIGNED_INT, .required = 1, .detail = {.unsigned_int = {.min_val = 0, .max_val = 10}}},
+	{.name = "speed", .type = RULE_UNSIGNED_INT, .required = 1, .detail = {.unsigned_int = {.min_val = 0, .max_val = 1000}}},
+	{.name = "color", .type = RULE_CHAR, .min_len = 0, .max_len = 16},
+	{.name = "text", .type = RULE_CHAR, .min_len = 0, .max_len = 64},
+	{.name = "led", .type = RULE_BOOLEAN}
+};
+
+#define BENCH_JSON_RULES (sizeof(bench_rule) / sizeof(bench_rule[0]))
+
+static const char bench_doc[] =
+	"{\"repeat\":3,\"speed\":250,\"color\":\"00FF00\",\"text\":\"Door \\\"front\\\" opened\",\"led\":true}";
+
+static uint64_t bench_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+int main(void) {
+	char data[sizeof(bench_doc)];
+	struct Value_T values[BENCH_JSON_RULES];
+	uint64_t start;
+	uint64_t in_place;
+	uint64_t tree;
+	uint32_t i;
+	Json_T json;
+	start = bench_now();
+	for (i = 0; i < BENCH_JSON_ROUNDS; i++) {
+		memcpy(data, bench_doc, sizeof(bench_doc));
+		CHECK(json_parse_values(data, bench_rule, BENCH_JSON_RULES, values));
+	}
+	in_place = bench_now() - start;
+	CHECK(values[1].uint_value == 250);
+	start = bench_now();
+	for (i = 0; i < BENCH_JSON_ROUNDS; i++) {
+		memcpy(data, bench_doc, sizeof(bench_doc));
+		json = json_parse(data, bench_rule, BENCH_JSON_RULES);
+		CHECK(json && json_to_values(json, values));
+		json_delete(json);
+	}
+	tree = bench_now() - start;
+	CHECK(values[1].uint_value == 250);
+	printf("{\"bench\":\"json\",\"rounds\":%u,\"json_parse_values_ns\":%llu,\"json_parse_ns\":%llu}\n",
+		BENCH_JSON_ROUNDS, (unsigned long long)(in_place / BENCH_JSON_ROUNDS),
+		(unsigned long long)(tree / BENCH_JSON_ROUNDS));
+	TEST_DONE("bench json");
+}
@@ -0,0 +1,205 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Days of timer wakes through the real user_main.c: wakes and awake time per
+// day for the sleep limit from the RTC calibration against the fixed 3600 s
+// without one, and how far the periodic report drifts from true time.
+// Boot costs the shim does not see are assumed: BENCH_SLEEP_BOOT_MS for a
+// full boot with RF calibration, BENCH_SLEEP_PASS_MS for an RF-less one.
+// obj/bench_sleep [days]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <user_interface.h>
+#include "user_config.h"
+#include "store.h"
+#include "url_storage.h"
+#include "action_plan.h"
+#include "rtc.h"
+#include "server.h"
+#include "shim.h"
+#include "test.h"
+
+#define BENCH_SLEEP_DAYS 30
+#define BENCH_SLEEP_BOOT_MS 350
+#define BENCH_SLEEP_PASS_MS 60
+#define BENCH_SLEEP_LIMIT_US 900000000ULL
+/*RTC tick period in us with 12 fractional bits*/
+#define BENCH_SLEEP_TICK(us_x1000) ((uint32_t)(((uint64_t)(us_x1000) << 12) / 1000))
+
+typedef struct {
+	const char* name;
+	uint32_t tick;
+	uint32_t cali;
+} Bench_Sleep_Case_T;
+
+typedef struct {
+	uint64_t awake;
+	uint64_t sleep;
+	uint8_t run;
+	uint8_t rf;
+} Bench_Sleep_Boot_T;
+
+extern struct Store_T store;
+extern Url_Storage_T url_storage;
+extern Action_Plan_T action_plan;
+
+void user_rf_pre_init(void);
+void user_init(void);
+
+static const Bench_Sleep_Case_T bench_sleep_case[] = {
+	{"calibrated", BENCH_SLEEP_TICK(5750), BENCH_SLEEP_TICK(5750)},
+	/*tick 1% off nominal, calibration 0.1% off the true tick*/
+	{"tick_error", BENCH_SLEEP_TICK(5808), BENCH_SLEEP_TICK(5802)},
+	{"uncalibrated", BENCH_SLEEP_TICK(5808), 0}
+};
+
+static void bench_sleep_provision(uint16_t port) {
+	char url[64];
+	shim_flash_erase();
+	shim_rtc_clear();
+	shim_boot(REASON_DEFAULT_RST);
+	store_init();
+	strcpy((char*)store.connect.station.ssid, "bench");
+	strcpy((char*)store.connect.station.password, "bench-password");
+	store.connect.save = 1;
+	CHECK(store_save());
+	url_storage_init(&url_storage, URL_STORAGE_SECTOR);
+	sprintf(url, "get://bench.local:%u/short", port);
+	CHECK(url_storage_write(&url_storage, URL_TYPE_SINGLE, url));
+	action_plan_init(&action_plan, ACTION_PLAN_SECTOR);
+	CHECK(action_plan_update(&action_plan, &url_storage));
+}
+
+static void bench_sleep_child(int fd, uint32_t reason) {
+	Bench_Sleep_Boot_T boot;
+	int null;
+	if ((null = open("/dev/null", O_WRONLY)) >= 0) {
+		dup2(null, STDOUT_FILENO);
+	}
+	memset(&boot, 0, sizeof(boot));
+	shim_boot(reason);
+	user_rf_pre_init();
+	user_init();
+	boot.run = shim_run(BENCH_SLEEP_LIMIT_US);
+	boot.awake = shim_now();
+	boot.sleep = shim_sleep_us();
+	boot.rf = shim_rf_option();
+	_exit(write(fd, &boot, sizeof(boot)) != sizeof(boot));
+}
+
+static uint8_t bench_sleep_boot(Bench_Sleep_Boot_T* boot, uint32_t reason) {
+	int fds[2];
+	int status;
+	pid_t pid;
+	uint8_t ok;
+	if (pipe(fds)) {
+		return 0;
+	}
+	fflush(stdout);
+	if (!(pid = fork())) {
+		close(fds[0]);
+		bench_sleep_child(fds[1], reason);
+	}
+	close(fds[1]);
+	ok = (pid > 0) && (read(fds[0], boot, sizeof(*boot)) == sizeof(*boot));
+	close(fds[0]);
+	if (pid > 0) {
+		waitpid(pid, &status, 0);
+	}
+	return ok && (boot->run == SHIM_RUN_SLEEP);
+}
+
+/*true time in us, the deep sleep runs on the true RTC tick*/
+static uint8_t bench_sleep_run(const Bench_Sleep_Case_T* test, uint16_t port, uint32_t days) {
+	Bench_Sleep_Boot_T boot;
+	RWC_T wc;
+	uint64_t now = 0;
+	uint64_t awake = 0;
+	uint64_t first_true = 0;
+	uint32_t first_stamp = 0;
+	uint32_t begin = 0;
+	uint32_t wakes = 0;
+	uint32_t passes = 0;
+	uint32_t reports = 0;
+	int64_t error;
+	int64_t worst = 0;
+	uint32_t reason = REASON_DEFAULT_RST;
+	bench_sleep_provision(port);
+	shim_rtc_cali(test->tick, test->cali);
+	while (now < (uint64_t)days * 86400000000ULL) {
+		if (!bench_sleep_boot(&boot, reason)) {
+			return 0;
+		}
+		if (reason == REASON_DEEP_SLEEP_AWAKE) {
+			wakes++;
+			passes += (boot.rf == 4);
+			awake += boot.awake + ((boot.rf == 4) ? BENCH_SLEEP_PASS_MS : BENCH_SLEEP_BOOT_MS) * 1000;
+		}
+		reason = REASON_DEEP_SLEEP_AWAKE;
+		/*a moved begin marks the periodic report of this wake*/
+		if (rtc_read(RTC_WC_OFFSET, &wc, sizeof(wc)) && (wc.begin_timestamp != begin)) {
+			begin = wc.begin_timestamp;
+			/*the first boot counts from its sleep, not a report*/
+			if (wakes && !reports++) {
+				first_true = now;
+				first_stamp = begin;
+			} else if (wakes) {
+				error = (int64_t)(begin - first_stamp) - (int64_t)((now - first_true) / 1000000);
+				if (llabs(error) > llabs(worst)) {
+					worst = error;
+				}
+			}
+		}
+		now += boot.awake;
+		shim_rtc_advance(boot.awake);
+		now += shim_rtc_slept(boot.sleep);
+		shim_rtc_advance(shim_rtc_slept(boot.sleep));
+	}
+	printf("{\"bench\":\"sleep\",\"case\":\"%s\",\"days\":%u,\"wakes_per_day\":%.1f,\"rf_less_per_day\":%.1f,"
+		"\"awake_ms_per_day\":%llu,\"all_full_awake_ms_per_day\":%llu,\"reports\":%u,\"report_error_s\":%lld,\"wc_drift_s\":%d}\n",
+		test->name, days, (double)wakes / days, (double)passes / days,
+		(unsigned long long)(awake / 1000 / days),
+		(unsigned long long)((awake + (uint64_t)passes * (BENCH_SLEEP_BOOT_MS - BENCH_SLEEP_PASS_MS) * 1000) / 1000 / days),
+		reports, (long long)worst, (int)wc.drift);
+	/*two reports a day*/
+	CHECK((reports >= days * 2 - 1) && (reports <= days * 2 + 1));
+	if (test->cali) {
+		CHECK(wakes <= days * 9);
+	}
+	return 1;
+}
+
+int main(int argc, char** argv) {
+	Server_T server;
+	uint32_t days = BENCH_SLEEP_DAYS;
+	uint32_t i;
+	if (argc > 1) {
+		days = strtoul(argv[1], NULL, 10);
+	}
+	if (!days) {
+		return 1;
+	}
+	server = server_new("{}");
+	shim_dns_add("bench.local", "127.0.0.1");
+	shim_wifi_ap("bench", "bench-password", -55);
+	for (i = 0; i < sizeof(bench_sleep_case) / sizeof(bench_sleep_case[0]); i++) {
+		CHECK(bench_sleep_run(&bench_sleep_case[i], server_port(server), days));
+	}
+	server_delete(server);
+	TEST_DONE("bench sleep");
+}
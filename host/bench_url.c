@@ -0,0 +1,74 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Flash reads to read back all URL types: the word by word reader that
+// shipped before, the block reader with a cold index, with the index restored
+// from RTC memory after deep sleep and with the index already in RAM
+
+#include <string.h>
+#include <stdlib.h>
+#include <user_interface.h>
+#include "url_storage.h"
+#include "url_legacy.h"
+#include "shim.h"
+#include "test.h"
+
+#define BENCH_URL_SECTOR 0xF8
+
+static const char* bench_url[__URL_TYPE_MAX] = {
+	"get://192.168.1.20/api/v1/scene/hallway?state=toggle",
+	"get://192.168.1.20/api/v1/scene/hallway?state=off",
+	"post://192.168.1.20/api/v1/scene/all?state=off&delay=30",
+	"get://192.168.1.21/relay?toggle=1",
+	"get://192.168.1.22/report?mac=2CF43212AB00&action=$action&battery=$battery"
+};
+
+/*flash reads taken by one pass over all types*/
+static uint32_t bench_url_pass(Url_Storage_T* url) {
+	uint32_t reads = shim_flash_reads();
+	uint32_t type;
+	char* str;
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		str = url ? url_storage_read(url, type) : url_legacy_read(BENCH_URL_SECTOR, type);
+		CHECK(str && !strcmp(str, bench_url[type]));
+		free(str);
+	}
+	return shim_flash_reads() - reads;
+}
+
+int main(void) {
+	Url_Storage_T url;
+	uint32_t legacy;
+	uint32_t cold;
+	uint32_t rtc;
+	uint32_t ram;
+	uint32_t type;
+	shim_flash_erase();
+	shim_rtc_clear();
+	url_storage_init(&url, BENCH_URL_SECTOR);
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		CHECK(url_storage_write(&url, type, bench_url[type]));
+	}
+	legacy = bench_url_pass(NULL);
+	shim_rtc_clear();
+	url_storage_init(&url, BENCH_URL_SECTOR);
+	cold = bench_url_pass(&url);
+	url_storage_init(&url, BENCH_URL_SECTOR);
+	rtc = bench_url_pass(&url);
+	ram = bench_url_pass(&url);
+	CHECK(cold < legacy / 100);
+	CHECK(rtc < cold && ram < rtc);
+	printf("{\"bench\":\"url\",\"types\":%u,\"legacy_reads\":%u,\"cold_reads\":%u,\"rtc_reads\":%u,\"ram_reads\":%u}\n",
+		__URL_TYPE_MAX, legacy, cold, rtc, ram);
+	TEST_DONE("bench url");
+}
@@ -0,0 +1,241 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Wake to action latency of the real user_main.c: every boot is a forked deep
+// sleep wake with the button held, the station, DHCP, DNS and the stub server
+// take jittered virtual delays. Prints per stage p50/p95/p99 in us as JSON,
+// "at" counts from boot and "took" from the stage reached before.
+// obj/bench_wake [boots] [file]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <user_interface.h>
+#include "user_config.h"
+#include "peri.h"
+#include "store.h"
+#include "url_storage.h"
+#include "action_plan.h"
+#include "trace.h"
+#include "server.h"
+#include "shim.h"
+#include "test.h"
+
+#define BENCH_WAKE_BOOTS 200
+#define BENCH_WAKE_HOLD_US 120000
+#define BENCH_WAKE_LIMIT_US 60000000
+#define BENCH_WAKE_TAG 0xB0
+
+typedef struct {
+	uint32_t time[__TRACE_MAX];
+	uint64_t awake;
+	uint64_t sleep;
+	uint8_t run;
+} Bench_Wake_Boot_T;
+
+extern struct Store_T store;
+extern Url_Storage_T url_storage;
+extern Action_Plan_T action_plan;
+
+void user_rf_pre_init(void);
+void user_init(void);
+
+static uint32_t bench_seed = 0x2545F491;
+
+/*xorshift, the same delays on every run*/
+static uint32_t bench_rand(uint32_t min, uint32_t max) {
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return min + (bench_seed % (max - min + 1));
+}
+
+static void bench_wake_provision(uint16_t port) {
+	char url[64];
+	shim_flash_erase();
+	shim_rtc_clear();
+	shim_boot(REASON_DEFAULT_RST);
+	store_init();
+	strcpy((char*)store.connect.station.ssid, "bench");
+	strcpy((char*)store.connect.station.password, "bench-password");
+	store.connect.save = 1;
+	CHECK(store_save());
+	url_storage_init(&url_storage, URL_STORAGE_SECTOR);
+	sprintf(url, "get://bench.local:%u/short", port);
+	CHECK(url_storage_write(&url_storage, URL_TYPE_SINGLE, url));
+	action_plan_init(&action_plan, ACTION_PLAN_SECTOR);
+	CHECK(action_plan_update(&action_plan, &url_storage));
+}
+
+static void bench_wake_release(void* arg, uint8_t* data, uint16_t len) {
+	shim_gpio_input(BTN_GPIO, 1);
+}
+
+/*one wake in a child, the parent keeps flash and RTC memory*/
+static void bench_wake_child(int fd) {
+	Bench_Wake_Boot_T boot;
+	uint8_t i;
+	int null;
+	if ((null = open("/dev/null", O_WRONLY)) >= 0) {
+		dup2(null, STDOUT_FILENO);
+	}
+	memset(&boot, 0, sizeof(boot));
+	shim_boot(REASON_DEEP_SLEEP_AWAKE);
+	shim_gpio_input(BTN_GPIO, 0);
+	shim_call(BENCH_WAKE_HOLD_US, bench_wake_release, NULL, BENCH_WAKE_TAG, NULL, 0);
+	user_rf_pre_init();
+	user_init();
+	boot.run = shim_run(BENCH_WAKE_LIMIT_US);
+	boot.awake = shim_now();
+	boot.sleep = shim_sleep_us();
+	for (i = 0; i < __TRACE_MAX; i++) {
+		boot.time[i] = trace_get(i);
+	}
+	if (write(fd, &boot, sizeof(boot)) != sizeof(boot)) {
+		_exit(1);
+	}
+	_exit(0);
+}
+
+static uint8_t bench_wake_boot(Bench_Wake_Boot_T* boot) {
+	Shim_Delay_T delay;
+	int fds[2];
+	int status;
+	pid_t pid;
+	uint8_t ok;
+	memset(&delay, 0, sizeof(delay));
+	delay.assoc = bench_rand(60000, 400000);
+	delay.dhcp = bench_rand(10000, 400000);
+	delay.ping = bench_rand(2000, 20000);
+	delay.dns = bench_rand(1000, 40000);
+	delay.connect = bench_rand(3000, 60000);
+	delay.recv = bench_rand(5000, 150000);
+	shim_delay(&delay);
+	if (pipe(fds)) {
+		return 0;
+	}
+	fflush(stdout);
+	if (!(pid = fork())) {
+		close(fds[0]);
+		bench_wake_child(fds[1]);
+	}
+	close(fds[1]);
+	ok = (pid > 0) && (read(fds[0], boot, sizeof(*boot)) == sizeof(*boot));
+	close(fds[0]);
+	if (pid > 0) {
+		waitpid(pid, &status, 0);
+	}
+	/*RTC time runs on through the awake time and the deep sleep*/
+	if (ok) {
+		shim_rtc_advance(boot->awake + boot->sleep);
+	}
+	return ok;
+}
+
+static int bench_cmp(const void* a, const void* b) {
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+/*nearest rank*/
+static uint32_t bench_percentile(uint32_t* sorted, uint32_t n, uint32_t p) {
+	uint32_t rank = (p * n + 99) / 100;
+	return sorted[rank ? rank - 1 : 0];
+}
+
+static void bench_print_percentiles(FILE* out, const char* name, uint32_t* values, uint32_t n) {
+	qsort(values, n, sizeof(values[0]), bench_cmp);
+	fprintf(out, "\"%s\":{\"p50\":%u,\"p95\":%u,\"p99\":%u}", name,
+		bench_percentile(values, n, 50), bench_percentile(values, n, 95), bench_percentile(values, n, 99));
+}
+
+static void bench_wake_print(FILE* out, Bench_Wake_Boot_T* boots, uint32_t count, uint32_t slept) {
+	uint32_t* at = malloc(count * sizeof(uint32_t));
+	uint32_t* took = malloc(count * sizeof(uint32_t));
+	uint32_t prev;
+	uint32_t n;
+	uint32_t i;
+	uint8_t stage;
+	uint8_t j;
+	fprintf(out, "{\"bench\":\"wake\",\"boots\":%u,\"slept\":%u,\"stages\":{", count, slept);
+	for (stage = 0; stage < __TRACE_MAX; stage++) {
+		n = 0;
+		for (i = 0; i < count; i++) {
+			if (!boots[i].time[stage]) {
+				continue;
+			}
+			prev = 0;
+			for (j = 0; j < stage; j++) {
+				if (boots[i].time[j] && (boots[i].time[j] <= boots[i].time[stage]) && (boots[i].time[j] > prev)) {
+					prev = boots[i].time[j];
+				}
+			}
+			at[n] = boots[i].time[stage];
+			took[n] = boots[i].time[stage] - prev;
+			n++;
+		}
+		fprintf(out, "%s\"%s\":{\"n\":%u", stage ? "," : "", trace_stage_name(stage), n);
+		if (n) {
+			fprintf(out, ",");
+			bench_print_percentiles(out, "at", at, n);
+			fprintf(out, ",");
+			bench_print_percentiles(out, "took", took, n);
+		}
+		fprintf(out, "}");
+	}
+	fprintf(out, "}}\n");
+	free(at);
+	free(took);
+}
+
+int main(int argc, char** argv) {
+	Bench_Wake_Boot_T* boots;
+	Server_T server;
+	uint32_t count = BENCH_WAKE_BOOTS;
+	uint32_t done = 0;
+	uint32_t slept = 0;
+	uint32_t i;
+	FILE* out;
+	if (argc > 1) {
+		count = strtoul(argv[1], NULL, 10);
+	}
+	if (!count || !(boots = calloc(count, sizeof(Bench_Wake_Boot_T)))) {
+		return 1;
+	}
+	server = server_new("{}");
+	shim_dns_add("bench.local", "127.0.0.1");
+	shim_wifi_ap("bench", "bench-password", -55);
+	bench_wake_provision(server_port(server));
+	for (i = 0; i < count; i++) {
+		if (!bench_wake_boot(&boots[done])) {
+			continue;
+		}
+		slept += (boots[done].run == SHIM_RUN_SLEEP);
+		done++;
+	}
+	CHECK(done == count);
+	CHECK(slept == done);
+	CHECK(server_stats(server).requests >= done);
+	bench_wake_print(stdout, boots, done, slept);
+	if ((argc > 2) && (out = fopen(argv[2], "w"))) {
+		bench_wake_print(out, boots, done, slept);
+		fclose(out);
+	}
+	server_delete(server);
+	free(boots);
+	TEST_DONE("bench wake");
+}
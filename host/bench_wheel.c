@@ -0,0 +1,213 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Wheel trace replayed against a simulated target: requests sent and how far
+// the target trails the wheel, for motion dropped while a request is in
+// flight, accumulated at the fixed pace and accumulated at the adaptive pace.
+// The trace holds the arguments of iqs_wheel_cb, as the "Count: %d, diff: %d"
+// debug lines of IQS333.c print them: obj/bench_wheel [trace], one
+// "ms count diff" per line, a built-in one of turns and spins otherwise
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "user_config.h"
+#include "peri_wheel.h"
+#include "test.h"
+
+#define BENCH_WHEEL_EVENTS 4096
+#define BENCH_WHEEL_SETTLE 10000
+
+typedef struct {
+	uint32_t ms;
+	uint16_t count;
+	int16_t diff;
+} Bench_Wheel_Event_T;
+
+typedef enum {
+	BENCH_WHEEL_DROP,
+	BENCH_WHEEL_FIXED,
+	BENCH_WHEEL_ADAPTIVE,
+	__BENCH_WHEEL_MAX
+} Bench_Wheel_Mode_T;
+
+typedef struct {
+	uint32_t requests;
+	uint32_t lost;
+	uint32_t jump;
+	uint32_t lag;
+	uint32_t settle;
+} Bench_Wheel_Result_T;
+
+static const char* bench_wheel_mode[__BENCH_WHEEL_MAX] = {"drop", "fixed", "adaptive"};
+
+static Bench_Wheel_Event_T bench_wheel_trace[BENCH_WHEEL_EVENTS];
+static uint32_t bench_wheel_events;
+static uint32_t seed = 1;
+
+static uint32_t bench_wheel_rand(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+/*IQS reads every 10-20 ms, the callback fires after 8 reads with some motion*/
+static void bench_wheel_gesture(uint32_t* ms, uint32_t length, int16_t speed) {
+	uint32_t end = *ms + length;
+	while ((*ms < end) && (bench_wheel_events < BENCH_WHEEL_EVENTS)) {
+		*ms += 80 + bench_wheel_rand() % 80;
+		bench_wheel_trace[bench_wheel_events].ms = *ms;
+		bench_wheel_trace[bench_wheel_events].count = 8 + bench_wheel_rand() % 4;
+		bench_wheel_trace[bench_wheel_events].diff = speed + (int16_t)(bench_wheel_rand() % 33) - 16;
+		bench_wheel_events++;
+	}
+	*ms += 1500;
+}
+
+static void bench_wheel_builtin(void) {
+	uint32_t ms = 1000;
+	bench_wheel_gesture(&ms, 3000, 40);
+	bench_wheel_gesture(&ms, 1200, -300);
+	bench_wheel_gesture(&ms, 6000, 24);
+	bench_wheel_gesture(&ms, 800, 600);
+	bench_wheel_gesture(&ms, 4000, -90);
+}
+
+static uint8_t bench_wheel_load(const char* name) {
+	FILE* file = fopen(name, "r");
+	unsigned ms;
+	unsigned count;
+	int diff;
+	if (!file) {
+		return 0;
+	}
+	while ((bench_wheel_events < BENCH_WHEEL_EVENTS) && (fscanf(file, "%u %u %d", &ms, &count, &diff) == 3)) {
+		bench_wheel_trace[bench_wheel_events].ms = ms;
+		bench_wheel_trace[bench_wheel_events].count = count;
+		bench_wheel_trace[bench_wheel_events].diff = diff;
+		bench_wheel_events++;
+	}
+	fclose(file);
+	return bench_wheel_events ? 1 : 0;
+}
+
+/*one ms steps, timers of user_main run at 10 ms, the target answers rtt ms +-25% after a send*/
+static Bench_Wheel_Result_T bench_wheel_run(Bench_Wheel_Mode_T mode, uint32_t rtt) {
+	Bench_Wheel_Result_T result;
+	Peri_Wheel_T wheel;
+	uint64_t lag = 0;
+	uint32_t event = 0;
+	uint32_t timer = 0;
+	uint32_t done = 0;
+	uint32_t measured = 0;
+	uint32_t sent = 0;
+	uint32_t last;
+	uint32_t wait;
+	uint32_t pace;
+	uint32_t ms;
+	int32_t owed = 0;
+	int32_t carried = 0;
+	int32_t step;
+	uint16_t value;
+	uint8_t busy = 0;
+	uint8_t flush;
+	memset(&result, 0, sizeof(result));
+	peri_wheel_init(&wheel);
+	last = bench_wheel_trace[bench_wheel_events - 1].ms;
+	for (ms = 1; ms < last + BENCH_WHEEL_SETTLE; ms++) {
+		if (busy && (ms >= done)) {
+			busy = 0;
+			measured = ms - sent;
+			owed -= carried;
+			result.settle = ms;
+		}
+		flush = timer && (ms >= timer);
+		if (flush) {
+			timer = 0;
+		}
+		if ((event < bench_wheel_events) && (ms >= bench_wheel_trace[event].ms)) {
+			if ((mode == BENCH_WHEEL_DROP) && busy) {
+				result.lost += abs(bench_wheel_trace[event].diff);
+			} else {
+				peri_wheel_add(&wheel, bench_wheel_trace[event].count, bench_wheel_trace[event].diff);
+				owed += bench_wheel_trace[event].diff;
+				flush = 1;
+			}
+			event++;
+		}
+		if (flush && peri_wheel_pending(&wheel)) {
+			pace = peri_wheel_pace((mode == BENCH_WHEEL_ADAPTIVE) ? measured : 0);
+			wait = (mode == BENCH_WHEEL_DROP) ? 0 : peri_wheel_wait(&wheel, ms * 1000, pace);
+			if (busy || wait) {
+				timer = ms + ((wait ? wait : WHEEL_MIN_INTERVAL) / 10 + 1) * 10;
+			} else {
+				value = peri_wheel_send(&wheel, ms * 1000);
+				step = (int8_t)(value & 0xFF);
+				carried = -step * 16;
+				if ((uint32_t)abs(step) > result.jump) {
+					result.jump = abs(step);
+				}
+				result.requests++;
+				busy = 1;
+				sent = ms;
+				done = ms + rtt * 3 / 4 + bench_wheel_rand() % (rtt / 2 + 1);
+				if (peri_wheel_pending(&wheel)) {
+					timer = ms + (pace / 10 + 1) * 10;
+				}
+			}
+			/*before the accumulator each event was sent alone, or not at all*/
+			if (mode == BENCH_WHEEL_DROP) {
+				result.lost += abs(wheel.diff);
+				owed -= wheel.diff;
+				peri_wheel_init(&wheel);
+				timer = 0;
+			}
+		}
+		lag += abs(owed);
+	}
+	result.lag = lag / 16 / (last + 1);
+	result.settle = (result.settle > last) ? (result.settle - last) : 0;
+	result.lost /= 16;
+	return result;
+}
+
+int main(int argc, char** argv) {
+	static const uint32_t rtt[] = {60, 250, 700};
+	Bench_Wheel_Result_T result[__BENCH_WHEEL_MAX];
+	uint32_t total = 0;
+	uint32_t mode;
+	uint32_t i;
+	if ((argc > 1) && !bench_wheel_load(argv[1])) {
+		printf("usage: %s [trace]\n", argv[0]);
+		return 1;
+	}
+	if (argc <= 1) {
+		bench_wheel_builtin();
+	}
+	for (i = 0; i < bench_wheel_events; i++) {
+		total += abs(bench_wheel_trace[i].diff);
+	}
+	for (i = 0; i < sizeof(rtt) / sizeof(rtt[0]); i++) {
+		printf("{\"bench\":\"wheel\",\"events\":%u,\"steps\":%u,\"rtt_ms\":%u", bench_wheel_events, total / 16, rtt[i]);
+		for (mode = 0; mode < __BENCH_WHEEL_MAX; mode++) {
+			result[mode] = bench_wheel_run(mode, rtt[i]);
+			printf(",\"%s\":{\"requests\":%u,\"lost_steps\":%u,\"max_jump\":%u,\"mean_lag_steps\":%u,\"settle_ms\":%u}",
+				bench_wheel_mode[mode], result[mode].requests, result[mode].lost, result[mode].jump,
+				result[mode].lag, result[mode].settle);
+		}
+		printf("}\n");
+		/*accumulated motion arrives whole*/
+		CHECK(!result[BENCH_WHEEL_FIXED].lost && !result[BENCH_WHEEL_ADAPTIVE].lost);
+		CHECK(result[BENCH_WHEEL_DROP].lost);
+	}
+	TEST_DONE("bench wheel");
+}
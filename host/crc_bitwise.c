@@ -0,0 +1,59 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Host build: the bit by bit CRC division the flash tables replaced, kept to
+// pin the results stores and URL sectors in the field were written with
+
+#include "crc_bitwise.h"
+
+/*works on a Crc_T from crc_init, the table it may carry is not used*/
+uint64_t crc_bitwise_calculate(Crc_T* crc, uint64_t value) {
+	uint64_t poly;
+	uint8_t i;
+	if (!crc) {
+		return 0;
+	}
+	poly = crc->poly << (crc->power - 1);
+	value <<= crc->power;
+	value |= crc->last_value;
+	for (i = ((crc->power * 2) - 1); i >= crc->power; i--) {
+		if (value & ((uint64_t)1 << i)) {
+			value ^= poly;
+		}
+		poly >>= 1;
+	}
+	crc->last_value = value;
+	return crc->last_value;
+}
+
+uint64_t crc_bitwise_check(Crc_T* crc, const uint8_t* buffer, uint16_t length) {
+	uint16_t i;
+	if (!crc || !buffer || !length) {
+		return 0;
+	}
+	for (i = 0; i < length; i++) {
+		crc_bitwise_calculate(crc, buffer[i]);
+	}
+	return crc->last_value;
+}
+
+uint64_t crc_bitwise_check_words(Crc_T* crc, const uint32_t* buffer, uint16_t count) {
+	uint16_t i;
+	if (!crc || !buffer || !count) {
+		return 0;
+	}
+	for (i = 0; i < count; i++) {
+		crc_bitwise_calculate(crc, buffer[i]);
+	}
+	return crc->last_value;
+}
@@ -0,0 +1,27 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Host build: the bit by bit CRC division the flash tables replaced, kept to
+// pin the results stores and URL sectors in the field were written with
+
+#ifndef CRC_BITWISE_H_INCLUDED
+#define CRC_BITWISE_H_INCLUDED 1
+
+#include <inttypes.h>
+#include "crc.h"
+
+uint64_t crc_bitwise_calculate(Crc_T* crc, uint64_t value);
+uint64_t crc_bitwise_check(Crc_T* crc, const uint8_t* buffer, uint16_t length);
+uint64_t crc_bitwise_check_words(Crc_T* crc, const uint32_t* buffer, uint16_t count);
+
+#endif
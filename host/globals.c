@@ -0,0 +1,29 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build: the state user_main.c owns, for tests that link the modules without it
+
+#include <osapi.h>
+#include "collect.h"
+#include "ns.h"
+#include "url_storage.h"
+#include "action_plan.h"
+
+Url_Storage_T url_storage;
+Action_Plan_T action_plan;
+Collect_T collect = NULL;
+Ns_T ns = NULL;
+char own_mac[13];
+uint32_t timer_ticks = 0;
+volatile uint32_t download_process = 0;
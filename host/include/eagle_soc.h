@@ -0,0 +1,109 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK eagle_soc.h, peripheral registers live in shim_gpio.c
+
+#ifndef EAGLE_SOC_H_INCLUDED
+#define EAGLE_SOC_H_INCLUDED 1
+
+#include "c_types.h"
+
+#define BIT31 0x80000000
+#define BIT15 0x00008000
+#define BIT9 0x00000200
+#define BIT8 0x00000100
+#define BIT7 0x00000080
+#define BIT6 0x00000040
+#define BIT5 0x00000020
+#define BIT4 0x00000010
+#define BIT3 0x00000008
+#define BIT2 0x00000004
+#define BIT1 0x00000002
+#define BIT0 0x00000001
+
+#define APB_CLK_FREQ 80000000
+#define UART_CLK_FREQ APB_CLK_FREQ
+#define TIMER_CLK_FREQ (APB_CLK_FREQ >> 8)
+
+uint32_t shim_reg_read(uint32_t addr);
+void shim_reg_write(uint32_t addr, uint32_t value);
+
+#define READ_PERI_REG(addr) shim_reg_read((uint32_t)(addr))
+#define WRITE_PERI_REG(addr, val) shim_reg_write((uint32_t)(addr), (uint32_t)(val))
+#define CLEAR_PERI_REG_MASK(reg, mask) WRITE_PERI_REG((reg), (READ_PERI_REG(reg) & (~(mask))))
+#define SET_PERI_REG_MASK(reg, mask) WRITE_PERI_REG((reg), (READ_PERI_REG(reg) | (mask)))
+
+#define PERIPHS_GPIO_BASEADDR 0x60000300
+#define PERIPHS_TIMER_BASEDDR 0x60000600
+#define PERIPHS_RTC_BASEADDR 0x60000700
+#define PERIPHS_IO_MUX 0x60000800
+#define REG_RTC_BASE PERIPHS_RTC_BASEADDR
+#define PAD_XPD_DCDC_CONF (REG_RTC_BASE + 0x0A0)
+
+#define GPIO_REG_READ(reg) READ_PERI_REG(PERIPHS_GPIO_BASEADDR + (reg))
+#define GPIO_REG_WRITE(reg, val) WRITE_PERI_REG(PERIPHS_GPIO_BASEADDR + (reg), val)
+#define GPIO_OUT_ADDRESS 0x00
+#define GPIO_OUT_W1TS_ADDRESS 0x04
+#define GPIO_OUT_W1TC_ADDRESS 0x08
+#define GPIO_ENABLE_ADDRESS 0x0c
+#define GPIO_ENABLE_W1TS_ADDRESS 0x10
+#define GPIO_ENABLE_W1TC_ADDRESS 0x14
+#define GPIO_OUT_W1TC_DATA_MASK 0x0000ffff
+#define GPIO_IN_ADDRESS 0x18
+#define GPIO_STATUS_ADDRESS 0x1c
+#define GPIO_STATUS_W1TS_ADDRESS 0x20
+#define GPIO_STATUS_W1TC_ADDRESS 0x24
+#define GPIO_PIN0_ADDRESS 0x28
+
+#define FRC1_LOAD_ADDRESS (PERIPHS_TIMER_BASEDDR + 0x0)
+#define FRC1_COUNT_ADDRESS (PERIPHS_TIMER_BASEDDR + 0x4)
+#define FRC1_CTRL_ADDRESS (PERIPHS_TIMER_BASEDDR + 0x8)
+#define FRC1_INT_ADDRESS (PERIPHS_TIMER_BASEDDR + 0xc)
+
+#define PERIPHS_IO_MUX_MTDI_U (PERIPHS_IO_MUX + 0x04)
+#define PERIPHS_IO_MUX_MTCK_U (PERIPHS_IO_MUX + 0x08)
+#define PERIPHS_IO_MUX_MTMS_U (PERIPHS_IO_MUX + 0x0C)
+#define PERIPHS_IO_MUX_MTDO_U (PERIPHS_IO_MUX + 0x10)
+#define PERIPHS_IO_MUX_U0RXD_U (PERIPHS_IO_MUX + 0x14)
+#define PERIPHS_IO_MUX_U0TXD_U (PERIPHS_IO_MUX + 0x18)
+#define PERIPHS_IO_MUX_SD_DATA2_U (PERIPHS_IO_MUX + 0x24)
+#define PERIPHS_IO_MUX_SD_DATA3_U (PERIPHS_IO_MUX + 0x28)
+#define PERIPHS_IO_MUX_GPIO0_U (PERIPHS_IO_MUX + 0x34)
+#define PERIPHS_IO_MUX_GPIO2_U (PERIPHS_IO_MUX + 0x38)
+#define PERIPHS_IO_MUX_GPIO4_U (PERIPHS_IO_MUX + 0x3C)
+#define PERIPHS_IO_MUX_GPIO5_U (PERIPHS_IO_MUX + 0x40)
+
+#define PERIPHS_IO_MUX_PULLUP BIT7
+#define PERIPHS_IO_MUX_FUNC 0x13
+#define PERIPHS_IO_MUX_FUNC_S 4
+#define PIN_PULLUP_DIS(PIN_NAME) CLEAR_PERI_REG_MASK(PIN_NAME, PERIPHS_IO_MUX_PULLUP)
+#define PIN_PULLUP_EN(PIN_NAME) SET_PERI_REG_MASK(PIN_NAME, PERIPHS_IO_MUX_PULLUP)
+#define PIN_FUNC_SELECT(PIN_NAME, FUNC) \
+	WRITE_PERI_REG(PIN_NAME, (READ_PERI_REG(PIN_NAME) & ~(PERIPHS_IO_MUX_FUNC << PERIPHS_IO_MUX_FUNC_S)) \
+		| ((((FUNC & BIT2) << 2) | (FUNC & 0x3)) << PERIPHS_IO_MUX_FUNC_S))
+
+#define FUNC_GPIO0 0
+#define FUNC_GPIO1 3
+#define FUNC_GPIO2 0
+#define FUNC_GPIO3 3
+#define FUNC_GPIO4 0
+#define FUNC_GPIO5 0
+#define FUNC_GPIO9 3
+#define FUNC_GPIO10 3
+#define FUNC_GPIO12 3
+#define FUNC_GPIO13 3
+#define FUNC_GPIO14 3
+#define FUNC_GPIO15 3
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK ets_sys.h, interrupts are delivered by shim_gpio.c
+
+#ifndef ETS_SYS_H_INCLUDED
+#define ETS_SYS_H_INCLUDED 1
+
+#include "c_types.h"
+#include "eagle_soc.h"
+
+#define ETS_GPIO_INUM 4
+#define ETS_FRC_TIMER1_INUM 9
+
+typedef void (*ets_isr_t)(void* arg);
+
+void ets_isr_attach(int intr, ets_isr_t handler, void* arg);
+void ets_isr_mask(uint32 mask);
+void ets_isr_unmask(uint32 unmask);
+void ets_delay_us(uint32 us);
+void ets_intr_lock(void);
+void ets_intr_unlock(void);
+
+#define ETS_INTR_LOCK() ets_intr_lock()
+#define ETS_INTR_UNLOCK() ets_intr_unlock()
+#define ETS_GPIO_INTR_ATTACH(func, arg) ets_isr_attach(ETS_GPIO_INUM, (ets_isr_t)(func), (void*)(arg))
+#define ETS_GPIO_INTR_ENABLE() ets_isr_unmask(1 << ETS_GPIO_INUM)
+#define ETS_GPIO_INTR_DISABLE() ets_isr_mask(1 << ETS_GPIO_INUM)
+#define ETS_FRC_TIMER1_INTR_ATTACH(func, arg) ets_isr_attach(ETS_FRC_TIMER1_INUM, (ets_isr_t)(func), (void*)(arg))
+#define ETS_FRC_TIMER1_NMI_INTR_ATTACH(func) ets_isr_attach(ETS_FRC_TIMER1_INUM, (ets_isr_t)(func), NULL)
+#define ETS_FRC1_INTR_ENABLE() ets_isr_unmask(1 << ETS_FRC_TIMER1_INUM)
+#define ETS_FRC1_INTR_DISABLE() ets_isr_mask(1 << ETS_FRC_TIMER1_INUM)
+#define TM1_EDGE_INT_ENABLE()
+#define TM1_EDGE_INT_DISABLE()
+
+#endif
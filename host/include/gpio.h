@@ -0,0 +1,57 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK gpio.h, pin levels are injected with shim_gpio_input
+
+#ifndef GPIO_H_INCLUDED
+#define GPIO_H_INCLUDED 1
+
+#include "c_types.h"
+#include "eagle_soc.h"
+
+#define GPIO_PIN_COUNT 16
+#define GPIO_ID_PIN0 0
+#define GPIO_ID_PIN(n) (GPIO_ID_PIN0 + (n))
+#define GPIO_PIN_ADDR(i) (GPIO_PIN0_ADDRESS + (i) * 4)
+
+#define GPIO_PIN_INT_TYPE_S 7
+#define GPIO_PIN_INT_TYPE_MASK (0x7 << GPIO_PIN_INT_TYPE_S)
+#define GPIO_PIN_INT_TYPE_GET(x) (((x) & GPIO_PIN_INT_TYPE_MASK) >> GPIO_PIN_INT_TYPE_S)
+#define GPIO_PIN_INT_TYPE_SET(x) (((x) << GPIO_PIN_INT_TYPE_S) & GPIO_PIN_INT_TYPE_MASK)
+#define GPIO_PIN_PAD_DRIVER_S 2
+#define GPIO_PIN_PAD_DRIVER_MASK (0x1 << GPIO_PIN_PAD_DRIVER_S)
+#define GPIO_PIN_PAD_DRIVER_SET(x) (((x) << GPIO_PIN_PAD_DRIVER_S) & GPIO_PIN_PAD_DRIVER_MASK)
+#define GPIO_PAD_DRIVER_ENABLE 1
+#define GPIO_PAD_DRIVER_DISABLE 0
+
+typedef enum {
+	GPIO_PIN_INTR_DISABLE = 0,
+	GPIO_PIN_INTR_POSEDGE = 1,
+	GPIO_PIN_INTR_NEGEDGE = 2,
+	GPIO_PIN_INTR_ANYEDGE = 3,
+	GPIO_PIN_INTR_LOLEVEL = 4,
+	GPIO_PIN_INTR_HILEVEL = 5
+} GPIO_INT_TYPE;
+
+#define GPIO_OUTPUT_SET(gpio_no, bit_value) \
+	gpio_output_set((bit_value) << (gpio_no), ((~(bit_value)) & 0x01) << (gpio_no), 1 << (gpio_no), 0)
+#define GPIO_DIS_OUTPUT(gpio_no) gpio_output_set(0, 0, 0, 1 << (gpio_no))
+#define GPIO_INPUT_GET(gpio_no) ((gpio_input_get() >> (gpio_no)) & BIT0)
+
+void gpio_init(void);
+void gpio_output_set(uint32 set_mask, uint32 clear_mask, uint32 enable_mask, uint32 disable_mask);
+uint32 gpio_input_get(void);
+void gpio_pin_intr_state_set(uint32 i, GPIO_INT_TYPE intr_state);
+
+#endif
@@ -0,0 +1,41 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the lwip ip_addr.h
+
+#ifndef IP_ADDR_H_INCLUDED
+#define IP_ADDR_H_INCLUDED 1
+
+#include "c_types.h"
+
+typedef struct ip_addr {
+	uint32_t addr;
+} ip_addr_t;
+
+#define ip4_addr1(ip) (((uint8_t*)(ip))[0])
+#define ip4_addr2(ip) (((uint8_t*)(ip))[1])
+#define ip4_addr3(ip) (((uint8_t*)(ip))[2])
+#define ip4_addr4(ip) (((uint8_t*)(ip))[3])
+#define IP2STR(ip) ip4_addr1(ip), ip4_addr2(ip), ip4_addr3(ip), ip4_addr4(ip)
+#define IPSTR "%d.%d.%d.%d"
+#define IP4_ADDR(ip, a, b, c, d) \
+	((ip)->addr = ((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a))
+
+struct ip_info {
+	ip_addr_t ip;
+	ip_addr_t netmask;
+	ip_addr_t gw;
+};
+
+#endif
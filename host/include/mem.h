@@ -0,0 +1,28 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK mem.h
+
+#ifndef MEM_H_INCLUDED
+#define MEM_H_INCLUDED 1
+
+#include <stdlib.h>
+
+#define os_malloc malloc
+#define os_zalloc(size) calloc(1, size)
+#define os_calloc calloc
+#define os_realloc realloc
+#define os_free free
+
+#endif
@@ -0,0 +1,36 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK os_type.h, timers run on the host event loop
+
+#ifndef OS_TYPE_H_INCLUDED
+#define OS_TYPE_H_INCLUDED 1
+
+#include "c_types.h"
+
+typedef void os_timer_func_t(void* arg);
+typedef void ETSTimerFunc(void* arg);
+
+typedef struct _ETSTIMER_ {
+	struct _ETSTIMER_* timer_next;
+	uint64_t timer_expire;
+	uint32_t timer_period;
+	ETSTimerFunc* timer_func;
+	void* timer_arg;
+	uint8_t timer_armed;
+} ETSTimer;
+
+typedef ETSTimer os_timer_t;
+
+#endif
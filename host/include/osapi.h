@@ -0,0 +1,47 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK osapi.h
+
+#ifndef OSAPI_H_INCLUDED
+#define OSAPI_H_INCLUDED 1
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "c_types.h"
+#include "os_type.h"
+#include "user_config.h"
+
+#define os_printf printf
+#define os_printf_plus printf
+#define os_sprintf sprintf
+#define os_memcpy memcpy
+#define os_memset memset
+#define os_memcmp memcmp
+#define os_strlen strlen
+#define os_strcpy strcpy
+#define os_strncpy strncpy
+#define os_strcmp strcmp
+#define os_strncmp strncmp
+#define os_strstr strstr
+#define os_delay_us(us) ets_delay_us(us)
+
+void ets_delay_us(uint32_t us);
+void os_timer_disarm(os_timer_t* timer);
+void os_timer_setfn(os_timer_t* timer, os_timer_func_t* func, void* arg);
+void os_timer_arm(os_timer_t* timer, uint32_t ms, bool repeat);
+void os_timer_arm_us(os_timer_t* timer, uint32_t us, bool repeat);
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK ping.h, a reply arrives after the simulated round trip
+
+#ifndef PING_H_INCLUDED
+#define PING_H_INCLUDED 1
+
+#include "c_types.h"
+
+typedef void (*ping_recv_function)(void* arg, void* pdata);
+typedef void (*ping_sent_function)(void* arg, void* pdata);
+
+struct ping_option {
+	uint32 count;
+	uint32 ip;
+	uint32 coarse_time;
+	ping_recv_function recv_function;
+	ping_sent_function sent_function;
+	void* reverse;
+};
+
+struct ping_resp {
+	uint32 total_count;
+	uint32 resp_time;
+	uint32 seqno;
+	uint32 timeout_count;
+	uint32 bytes;
+	uint32 total_bytes;
+	uint32 total_time;
+	sint8 ping_err;
+};
+
+bool ping_start(struct ping_option* ping_opt);
+
+#endif
@@ -0,0 +1,28 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK pwm.h
+
+#ifndef PWM_H_INCLUDED
+#define PWM_H_INCLUDED 1
+
+#include "c_types.h"
+
+void pwm_init(uint32 period, uint32* duty, uint32 pwm_channel_num, uint32 (*pin_info_list)[3]);
+void pwm_start(void);
+void pwm_set_duty(uint32 duty, uint8 channel);
+uint32 pwm_get_duty(uint8 channel);
+void pwm_set_period(uint32 period);
+
+#endif
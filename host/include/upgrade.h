@@ -0,0 +1,40 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK upgrade.h, images land in the simulated flash
+
+#ifndef UPGRADE_H_INCLUDED
+#define UPGRADE_H_INCLUDED 1
+
+#include "c_types.h"
+
+#define UPGRADE_FLAG_IDLE 0x00
+#define UPGRADE_FLAG_START 0x01
+#define UPGRADE_FLAG_FINISH 0x02
+
+#define LIMIT_ERASE_SIZE 0x10000
+
+#define UPGRADE_FW_BIN1 0x00
+#define UPGRADE_FW_BIN2 0x01
+
+void system_upgrade_init(void);
+void system_upgrade_deinit(void);
+bool system_upgrade(uint8* data, uint32 len);
+uint8 system_upgrade_userbin_check(void);
+void system_upgrade_reboot(void);
+uint8 system_upgrade_flag_check(void);
+void system_upgrade_flag_set(uint8 flag);
+void system_upgrade_erase_flash(uint16 erase_counter);
+
+#endif
@@ -0,0 +1,308 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build stand-in for the SDK user_interface.h, backed by the shims in host/
+
+#ifndef USER_INTERFACE_H_INCLUDED
+#define USER_INTERFACE_H_INCLUDED 1
+
+#include "c_types.h"
+#include "ip_addr.h"
+#include "os_type.h"
+#include "eagle_soc.h"
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+#define MACSTR "%02x:%02x:%02x:%02x:%02x:%02x"
+#define MAC2STR(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+
+typedef enum {
+	SPI_FLASH_RESULT_OK,
+	SPI_FLASH_RESULT_ERR,
+	SPI_FLASH_RESULT_TIMEOUT
+} SpiFlashOpResult;
+
+enum rst_reason {
+	REASON_DEFAULT_RST = 0,
+	REASON_WDT_RST,
+	REASON_EXCEPTION_RST,
+	REASON_SOFT_WDT_RST,
+	REASON_SOFT_RESTART,
+	REASON_DEEP_SLEEP_AWAKE,
+	REASON_EXT_SYS_RST
+};
+
+struct rst_info {
+	uint32_t reason;
+	uint32_t exccause;
+	uint32_t epc1;
+	uint32_t epc2;
+	uint32_t epc3;
+	uint32_t excvaddr;
+	uint32_t depc;
+};
+
+enum flash_size_map {
+	FLASH_SIZE_4M_MAP_256_256 = 0,
+	FLASH_SIZE_2M,
+	FLASH_SIZE_8M_MAP_512_512,
+	FLASH_SIZE_16M_MAP_512_512,
+	FLASH_SIZE_32M_MAP_512_512,
+	FLASH_SIZE_16M_MAP_1024_1024,
+	FLASH_SIZE_32M_MAP_1024_1024
+};
+
+#define SYS_CPU_80MHZ 80
+#define SYS_CPU_160MHZ 160
+
+#define NULL_MODE 0x00
+#define STATION_MODE 0x01
+#define SOFTAP_MODE 0x02
+#define STATIONAP_MODE 0x03
+
+#define STATION_IF 0x00
+#define SOFTAP_IF 0x01
+
+typedef enum _auth_mode {
+	AUTH_OPEN = 0,
+	AUTH_WEP,
+	AUTH_WPA_PSK,
+	AUTH_WPA2_PSK,
+	AUTH_WPA_WPA2_PSK,
+	AUTH_MAX
+} AUTH_MODE;
+
+enum {
+	STATION_IDLE = 0,
+	STATION_CONNECTING,
+	STATION_WRONG_PASSWORD,
+	STATION_NO_AP_FOUND,
+	STATION_CONNECT_FAIL,
+	STATION_GOT_IP
+};
+
+enum dhcp_status {
+	DHCP_STOPPED,
+	DHCP_STARTED
+};
+
+struct station_config {
+	uint8_t ssid[32];
+	uint8_t password[64];
+	uint8_t bssid_set;
+	uint8_t bssid[6];
+};
+
+struct softap_config {
+	uint8 ssid[32];
+	uint8 password[64];
+	uint8 ssid_len;
+	uint8 channel;
+	AUTH_MODE authmode;
+	uint8 ssid_hidden;
+	uint8 max_connection;
+	uint16 beacon_interval;
+};
+
+struct scan_config {
+	uint8* ssid;
+	uint8* bssid;
+	uint8 channel;
+	uint8 show_hidden;
+};
+
+struct bss_info {
+	struct {
+		struct bss_info* stqe_next;
+	} next;
+	uint8 bssid[6];
+	uint8 ssid[32];
+	uint8 ssid_len;
+	uint8 channel;
+	sint8 rssi;
+	AUTH_MODE authmode;
+	uint8 is_hidden;
+	sint16 freq_offset;
+	sint16 freqcal_val;
+	uint8* esp_mesh_ie;
+};
+
+typedef enum {
+	OK = 0,
+	FAIL,
+	PENDING,
+	BUSY,
+	CANCEL
+} STATUS;
+
+typedef void (*scan_done_cb_t)(void* arg, STATUS status);
+
+enum {
+	EVENT_STAMODE_CONNECTED = 0,
+	EVENT_STAMODE_DISCONNECTED,
+	EVENT_STAMODE_AUTHMODE_CHANGE,
+	EVENT_STAMODE_GOT_IP,
+	EVENT_STAMODE_DHCP_TIMEOUT,
+	EVENT_SOFTAPMODE_STACONNECTED,
+	EVENT_SOFTAPMODE_STADISCONNECTED,
+	EVENT_SOFTAPMODE_PROBEREQRECVED,
+	EVENT_MAX
+};
+
+enum {
+	REASON_UNSPECIFIED = 1,
+	REASON_AUTH_EXPIRE = 2,
+	REASON_ASSOC_EXPIRE = 4,
+	REASON_BEACON_TIMEOUT = 200,
+	REASON_NO_AP_FOUND = 201,
+	REASON_AUTH_FAIL = 202,
+	REASON_ASSOC_FAIL = 203,
+	REASON_HANDSHAKE_TIMEOUT = 204
+};
+
+typedef struct {
+	uint8 ssid[32];
+	uint8 ssid_len;
+	uint8 bssid[6];
+	uint8 channel;
+} Event_StaMode_Connected_t;
+
+typedef struct {
+	uint8 ssid[32];
+	uint8 ssid_len;
+	uint8 bssid[6];
+	uint8 reason;
+} Event_StaMode_Disconnected_t;
+
+typedef struct {
+	uint8 old_mode;
+	uint8 new_mode;
+} Event_StaMode_AuthMode_Change_t;
+
+typedef struct {
+	ip_addr_t ip;
+	ip_addr_t mask;
+	ip_addr_t gw;
+} Event_StaMode_Got_IP_t;
+
+typedef struct {
+	uint8 mac[6];
+	uint8 aid;
+} Event_SoftAPMode_StaConnected_t;
+
+typedef struct {
+	uint8 mac[6];
+	uint8 aid;
+} Event_SoftAPMode_StaDisconnected_t;
+
+typedef struct {
+	int rssi;
+	uint8 mac[6];
+} Event_SoftAPMode_ProbeReqRecved_t;
+
+typedef union {
+	Event_StaMode_Connected_t connected;
+	Event_StaMode_Disconnected_t disconnected;
+	Event_StaMode_AuthMode_Change_t auth_change;
+	Event_StaMode_Got_IP_t got_ip;
+	Event_SoftAPMode_StaConnected_t sta_connected;
+	Event_SoftAPMode_StaDisconnected_t sta_disconnected;
+	Event_SoftAPMode_ProbeReqRecved_t ap_probereqrecved;
+} Event_Info_u;
+
+typedef struct _esp_event {
+	uint32 event;
+	Event_Info_u event_info;
+} System_Event_t;
+
+typedef void (*wifi_event_handler_cb_t)(System_Event_t* event);
+
+typedef enum wps_type {
+	WPS_TYPE_DISABLE = 0,
+	WPS_TYPE_PBC,
+	WPS_TYPE_PIN,
+	WPS_TYPE_DISPLAY,
+	WPS_TYPE_MAX
+} WPS_TYPE_t;
+
+enum wps_cb_status {
+	WPS_CB_ST_SUCCESS = 0,
+	WPS_CB_ST_FAILED,
+	WPS_CB_ST_TIMEOUT,
+	WPS_CB_ST_WEP,
+	WPS_CB_ST_UNK
+};
+
+typedef void (*wps_st_cb_t)(int status);
+
+enum sleep_type {
+	NONE_SLEEP_T = 0,
+	LIGHT_SLEEP_T,
+	MODEM_SLEEP_T
+};
+
+SpiFlashOpResult spi_flash_read(uint32_t address, uint32_t* data, uint32_t len);
+SpiFlashOpResult spi_flash_write(uint32_t address, uint32_t* data, uint32_t len);
+SpiFlashOpResult spi_flash_erase_sector(uint16_t sector);
+
+bool system_rtc_mem_read(uint8_t offset, void* data, uint16_t len);
+bool system_rtc_mem_write(uint8_t offset, const void* data, uint16_t len);
+uint32 system_get_rtc_time(void);
+uint32 system_rtc_clock_cali_proc(void);
+
+struct rst_info* system_get_rst_info(void);
+uint32_t system_get_time(void);
+uint32 system_get_free_heap_size(void);
+enum flash_size_map system_get_flash_size_map(void);
+void system_restart(void);
+void system_restore(void);
+void system_deep_sleep(uint64 time_in_us);
+bool system_deep_sleep_set_option(uint8 option);
+bool system_update_cpu_freq(uint8 freq);
+uint16 system_adc_read(void);
+void system_phy_set_rfoption(uint8 option);
+void system_phy_freq_trace_enable(bool enable);
+void uart_div_modify(uint8 uart_no, uint32 div);
+
+uint8 wifi_get_opmode(void);
+bool wifi_set_opmode(uint8 opmode);
+bool wifi_set_opmode_current(uint8 opmode);
+bool wifi_station_get_config(struct station_config* config);
+bool wifi_station_set_config(struct station_config* config);
+bool wifi_station_connect(void);
+bool wifi_station_disconnect(void);
+uint8 wifi_station_get_connect_status(void);
+bool wifi_station_dhcpc_start(void);
+bool wifi_station_dhcpc_stop(void);
+enum dhcp_status wifi_station_dhcpc_status(void);
+bool wifi_station_set_hostname(char* name);
+uint8 wifi_station_get_auto_connect(void);
+bool wifi_station_set_auto_connect(uint8 set);
+bool wifi_station_set_reconnect_policy(bool set);
+sint8 wifi_station_get_rssi(void);
+bool wifi_station_scan(struct scan_config* config, scan_done_cb_t cb);
+bool wifi_get_ip_info(uint8 if_index, struct ip_info* info);
+bool wifi_set_ip_info(uint8 if_index, struct ip_info* info);
+bool wifi_get_macaddr(uint8 if_index, uint8* macaddr);
+bool wifi_softap_set_config_current(struct softap_config* config);
+bool wifi_softap_dhcps_start(void);
+bool wifi_softap_dhcps_stop(void);
+enum dhcp_status wifi_softap_dhcps_status(void);
+void wifi_set_event_handler_cb(wifi_event_handler_cb_t cb);
+bool wifi_wps_enable(WPS_TYPE_t wps_type);
+bool wifi_wps_disable(void);
+bool wifi_wps_start(void);
+bool wifi_set_wps_cb(wps_st_cb_t cb);
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build: forked HTTP/1.1 stub server, every request gets a 200 with the
+// fixed body, the connection stays open unless the request asks for close
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "server.h"
+
+#define SERVER_CLIENTS_MAX 16
+#define SERVER_REQUEST_MAX 2048
+#define SERVER_BODY_MAX 1024
+
+struct Server_T {
+	pid_t pid;
+	uint16_t port;
+	volatile Server_Stats_T* stats;
+};
+
+typedef struct {
+	int fd;
+	uint16_t len;
+	char data[SERVER_REQUEST_MAX + 1];
+} Server_Client_T;
+
+static void server_drop(Server_Client_T* client, volatile Server_Stats_T* stats) {
+	close(client->fd);
+	client->fd = -1;
+	client->len = 0;
+	stats->open--;
+}
+
+/*answers every complete request in the buffer, returns 0 when the connection has to go*/
+static uint8_t server_answer(Server_Client_T* client, const char* body, volatile Server_Stats_T* stats) {
+	char head[SERVER_REQUEST_MAX];
+	uint32_t reply;
+	char* end;
+	char* field;
+	uint32_t length;
+	uint32_t size;
+	uint8_t close_req;
+	client->data[client->len] = 0;
+	while ((end = strstr(client->data, "\r\n\r\n"))) {
+		*end = 0;
+		length = 0;
+		if ((field = strcasestr(client->data, "\r\nContent-Length:"))) {
+			length = strtoul(field + 17, NULL, 10);
+		}
+		close_req = strcasestr(client->data, "\r\nConnection: close") ? 1 : 0;
+		size = end + 4 - client->data + length;
+		if (size > client->len) {
+			*end = '\r';
+			return size <= SERVER_REQUEST_MAX;
+		}
+		stats->requests++;
+		snprintf((char*)stats->last, sizeof(stats->last), "%.*s", (int)strcspn(client->data, "\r"), client->data);
+		/*one write, the client sees the whole answer in one segment*/
+		reply = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Length: %u\r\nConnection: %s\r\n\r\n%s",
+			(unsigned)strlen(body), close_req ? "close" : "keep-alive", body);
+		if ((reply >= sizeof(head)) || (write(client->fd, head, reply) < 0) || close_req) {
+			return 0;
+		}
+		memmove(client->data, client->data + size, client->len - size + 1);
+		client->len -= size;
+	}
+	return client->len < SERVER_REQUEST_MAX;
+}
+
+static void server_loop(int listener, const char* body, volatile Server_Stats_T* stats) {
+	static Server_Client_T clients[SERVER_CLIENTS_MAX];
+	struct pollfd fds[SERVER_CLIENTS_MAX + 1];
+	uint8_t i;
+	ssize_t len;
+	int fd;
+	for (i = 0; i < SERVER_CLIENTS_MAX; i++) {
+		clients[i].fd = -1;
+	}
+	for (;;) {
+		fds[0].fd = listener;
+		fds[0].events = POLLIN;
+		for (i = 0; i < SERVER_CLIENTS_MAX; i++) {
+			fds[i + 1].fd = clients[i].fd;
+			fds[i + 1].events = POLLIN;
+		}
+		if (poll(fds, SERVER_CLIENTS_MAX + 1, -1) < 0) {
+			continue;
+		}
+		if ((fds[0].revents & POLLIN) && ((fd = accept(listener, NULL, NULL)) >= 0)) {
+			for (i = 0; (i < SERVER_CLIENTS_MAX) && (clients[i].fd >= 0); i++);
+			if (i == SERVER_CLIENTS_MAX) {
+				close(fd);
+			} else {
+				clients[i].fd = fd;
+				clients[i].len = 0;
+				stats->accepts++;
+				if (++stats->open > stats->peak) {
+					stats->peak = stats->open;
+				}
+			}
+		}
+		for (i = 0; i < SERVER_CLIENTS_MAX; i++) {
+			if ((clients[i].fd < 0) || !(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+				continue;
+			}
+			len = read(clients[i].fd, clients[i].data + clients[i].len, SERVER_REQUEST_MAX - clients[i].len);
+			if (len <= 0) {
+				server_drop(&clients[i], stats);
+				continue;
+			}
+			clients[i].len += len;
+			if (!server_answer(&clients[i], body, stats)) {
+				server_drop(&clients[i], stats);
+			}
+		}
+	}
+}
+
+Server_T server_new(const char* body) {
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	Server_T server;
+	int listener;
+	if ((strlen(body) > SERVER_BODY_MAX) || !(server = calloc(1, sizeof(struct Server_T)))) {
+		return NULL;
+	}
+	server->stats = mmap(NULL, sizeof(Server_Stats_T), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (server->stats == MAP_FAILED) {
+		goto error;
+	}
+	memset((void*)server->stats, 0, sizeof(Server_Stats_T));
+	if ((listener = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+		goto error_map;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) || listen(listener, SERVER_CLIENTS_MAX)
+		|| getsockname(listener, (struct sockaddr*)&addr, &addr_len)) {
+		goto error_socket;
+	}
+	server->port = ntohs(addr.sin_port);
+	if ((server->pid = fork()) < 0) {
+		goto error_socket;
+	}
+	if (!server->pid) {
+		prctl(PR_SET_PDEATHSIG, SIGKILL);
+		server_loop(listener, body, server->stats);
+		_exit(0);
+	}
+	close(listener);
+	return server;
+error_socket:
+	close(listener);
+error_map:
+	munmap((void*)server->stats, sizeof(Server_Stats_T));
+error:
+	free(server);
+	return NULL;
+}
+
+void server_delete(Server_T server) {
+	if (!server) {
+		return;
+	}
+	kill(server->pid, SIGKILL);
+	waitpid(server->pid, NULL, 0);
+	munmap((void*)server->stats, sizeof(Server_Stats_T));
+	free(server);
+}
+
+uint16_t server_port(Server_T server) {
+	return server->port;
+}
+
+Server_Stats_T server_stats(Server_T server) {
+	return *(Server_Stats_T*)server->stats;
+}
@@ -0,0 +1,38 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build: forked HTTP/1.1 stub server on a loopback port with keep-alive
+
+#ifndef SERVER_H_INCLUDED
+#define SERVER_H_INCLUDED 1
+
+#include <inttypes.h>
+
+typedef struct Server_T* Server_T;
+
+typedef struct {
+	uint32_t accepts;
+	uint32_t requests;
+	uint32_t open;
+	uint32_t peak;
+	/*request line of the latest request*/
+	char last[160];
+} Server_Stats_T;
+
+Server_T server_new(const char* body);
+void server_delete(Server_T server);
+uint16_t server_port(Server_T server);
+Server_Stats_T server_stats(Server_T server);
+
+#endif
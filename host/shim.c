@@ -0,0 +1,269 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build shim: NOR flash, RTC memory and the system calls around a boot
+
+#include <string.h>
+#include <sys/mman.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include <upgrade.h>
+#include "shim.h"
+
+#define SHIM_RTC_CALI (6 << 12)
+#define SHIM_UPGRADE_ADDR 0x101000
+
+/*survives a forked boot, as flash and RTC memory survive deep sleep*/
+typedef struct {
+	uint32_t rtc[SHIM_RTC_WORDS];
+	uint64_t rtc_us;
+	uint32_t rtc_tick;
+	uint32_t rtc_cali;
+	uint32_t erases;
+	uint32_t reads;
+	uint8_t flash[SHIM_FLASH_SIZE];
+} Shim_Shared_T;
+
+uint8_t* shim_flash;
+
+static Shim_Shared_T* shim_shared;
+static struct rst_info shim_rst_info;
+static int32_t shim_cut = -1;
+static uint8_t shim_upgrade_flag = UPGRADE_FLAG_IDLE;
+static uint32_t shim_upgrade_len = 0;
+static uint16_t shim_adc_value = 870;
+static uint8_t shim_rf = 0;
+
+__attribute__((constructor)) static void shim_init(void) {
+	shim_shared = mmap(NULL, sizeof(Shim_Shared_T), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shim_shared == MAP_FAILED) {
+		abort();
+	}
+	shim_flash = shim_shared->flash;
+	memset(shim_flash, 0xFF, SHIM_FLASH_SIZE);
+	shim_shared->rtc_tick = SHIM_RTC_CALI;
+	shim_shared->rtc_cali = SHIM_RTC_CALI;
+}
+
+void shim_flash_erase(void) {
+	memset(shim_flash, 0xFF, SHIM_FLASH_SIZE);
+	shim_cut = -1;
+}
+
+/*power is lost after this many more bytes are written, negative never*/
+void shim_flash_cut(int32_t bytes) {
+	shim_cut = bytes;
+}
+
+uint32_t shim_flash_erases(void) {
+	return shim_shared->erases;
+}
+
+uint32_t shim_flash_reads(void) {
+	return shim_shared->reads;
+}
+
+void shim_rtc_clear(void) {
+	memset(shim_shared->rtc, 0, sizeof(shim_shared->rtc));
+}
+
+void shim_reset(uint32_t reason) {
+	memset(&shim_rst_info, 0, sizeof(shim_rst_info));
+	shim_rst_info.reason = reason;
+	shim_cut = -1;
+	shim_rf = 0;
+}
+
+/*RF option set for this boot by system_phy_set_rfoption, 4 boots without RF*/
+uint8_t shim_rf_option(void) {
+	return shim_rf;
+}
+
+void shim_adc(uint16_t value) {
+	shim_adc_value = value;
+}
+
+/*RTC time keeps running across boots and through deep sleep*/
+void shim_rtc_advance(uint64_t us) {
+	shim_shared->rtc_us += us;
+}
+
+void shim_rtc_cali(uint32_t tick, uint32_t cali) {
+	shim_shared->rtc_tick = tick;
+	shim_shared->rtc_cali = cali;
+}
+
+/*the SDK counts deep sleep in ticks of its calibration, they last a true tick each*/
+uint64_t shim_rtc_slept(uint64_t us) {
+	if (!shim_shared->rtc_cali) {
+		return us;
+	}
+	return us * shim_shared->rtc_tick / shim_shared->rtc_cali;
+}
+
+/*word aligned address, the SDK reads any length but writes whole words*/
+static uint8_t shim_flash_check(uint32_t address, uint32_t len, uint8_t write) {
+	if ((address & 3) || (write && (len & 3))) {
+		return 0;
+	}
+	return (address + len) <= SHIM_FLASH_SIZE;
+}
+
+SpiFlashOpResult spi_flash_read(uint32_t address, uint32_t* data, uint32_t len) {
+	if (!data || !shim_flash_check(address, len, 0)) {
+		return SPI_FLASH_RESULT_ERR;
+	}
+	shim_shared->reads++;
+	memcpy(data, shim_flash + address, len);
+	return SPI_FLASH_RESULT_OK;
+}
+
+/*programming only clears bits, a cut write leaves the rest of the span as it was*/
+SpiFlashOpResult spi_flash_write(uint32_t address, uint32_t* data, uint32_t len) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint32_t i;
+	if (!data || !shim_flash_check(address, len, 1)) {
+		return SPI_FLASH_RESULT_ERR;
+	}
+	for (i = 0; i < len; i++) {
+		if (!shim_cut) {
+			return SPI_FLASH_RESULT_TIMEOUT;
+		}
+		if (shim_cut > 0) {
+			shim_cut--;
+		}
+		shim_flash[address + i] &= bytes[i];
+	}
+	return SPI_FLASH_RESULT_OK;
+}
+
+SpiFlashOpResult spi_flash_erase_sector(uint16_t sector) {
+	if (((uint32_t)sector + 1) * SPI_FLASH_SEC_SIZE > SHIM_FLASH_SIZE) {
+		return SPI_FLASH_RESULT_ERR;
+	}
+	if (!shim_cut) {
+		return SPI_FLASH_RESULT_TIMEOUT;
+	}
+	shim_shared->erases++;
+	memset(shim_flash + (uint32_t)sector * SPI_FLASH_SEC_SIZE, 0xFF, SPI_FLASH_SEC_SIZE);
+	return SPI_FLASH_RESULT_OK;
+}
+
+bool system_rtc_mem_read(uint8_t offset, void* data, uint16_t len) {
+	if (!data || ((uint32_t)offset * 4 + len) > sizeof(shim_shared->rtc)) {
+		return false;
+	}
+	memcpy(data, (uint8_t*)shim_shared->rtc + offset * 4, len);
+	return true;
+}
+
+bool system_rtc_mem_write(uint8_t offset, const void* data, uint16_t len) {
+	if (!data || ((uint32_t)offset * 4 + len) > sizeof(shim_shared->rtc)) {
+		return false;
+	}
+	memcpy((uint8_t*)shim_shared->rtc + offset * 4, data, len);
+	return true;
+}
+
+uint32 system_rtc_clock_cali_proc(void) {
+	return shim_shared->rtc_cali;
+}
+
+uint32 system_get_rtc_time(void) {
+	return (uint32)(((shim_shared->rtc_us + shim_now()) << 12) / shim_shared->rtc_tick);
+}
+
+struct rst_info* system_get_rst_info(void) {
+	return &shim_rst_info;
+}
+
+uint32_t system_get_time(void) {
+	return (uint32_t)shim_now();
+}
+
+uint32 system_get_free_heap_size(void) {
+	return 40960;
+}
+
+enum flash_size_map system_get_flash_size_map(void) {
+	return FLASH_SIZE_16M_MAP_1024_1024;
+}
+
+uint16 system_adc_read(void) {
+	return shim_adc_value;
+}
+
+bool system_update_cpu_freq(uint8 freq) {
+	return (freq == SYS_CPU_80MHZ) || (freq == SYS_CPU_160MHZ);
+}
+
+bool system_deep_sleep_set_option(uint8 option) {
+	return option <= 4;
+}
+
+void system_restore(void) {
+}
+
+void system_phy_set_rfoption(uint8 option) {
+	shim_rf = option;
+}
+
+void system_phy_freq_trace_enable(bool enable) {
+}
+
+void uart_div_modify(uint8 uart_no, uint32 div) {
+}
+
+void system_upgrade_init(void) {
+	shim_upgrade_len = 0;
+}
+
+void system_upgrade_deinit(void) {
+}
+
+/*the image goes to the second slot of the 1024+1024 map*/
+bool system_upgrade(uint8* data, uint32 len) {
+	uint32_t word;
+	uint32_t i;
+	for (i = 0; i < len; i++, shim_upgrade_len++) {
+		if (!(shim_upgrade_len & 3)) {
+			word = 0xFFFFFFFF;
+		}
+		((uint8_t*)&word)[shim_upgrade_len & 3] = data[i];
+		if ((shim_upgrade_len & 3) == 3) {
+			spi_flash_write(SHIM_UPGRADE_ADDR + shim_upgrade_len - 3, &word, 4);
+		}
+	}
+	return true;
+}
+
+void system_upgrade_erase_flash(uint16 erase_counter) {
+	uint16_t sector = (SHIM_UPGRADE_ADDR + shim_upgrade_len) / SPI_FLASH_SEC_SIZE;
+	uint32_t end = (uint32_t)sector + ((erase_counter == 0xFFFF) ? LIMIT_ERASE_SIZE : erase_counter) / SPI_FLASH_SEC_SIZE;
+	for (; sector < end; sector++) {
+		spi_flash_erase_sector(sector);
+	}
+}
+
+uint8 system_upgrade_userbin_check(void) {
+	return UPGRADE_FW_BIN1;
+}
+
+void system_upgrade_flag_set(uint8 flag) {
+	shim_upgrade_flag = flag;
+}
+
+uint8 system_upgrade_flag_check(void) {
+	return shim_upgrade_flag;
+}
@@ -0,0 +1,104 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build control over the simulated SDK: flash, RTC memory, reset reason,
+// the virtual clock and event loop, sockets behind espconn, the station and GPIO
+
+#ifndef SHIM_H_INCLUDED
+#define SHIM_H_INCLUDED 1
+
+#include <inttypes.h>
+
+struct espconn;
+
+#define SHIM_FLASH_SIZE (0x200 * 4096)
+#define SHIM_RTC_WORDS 192
+#define SHIM_NEVER UINT64_MAX
+
+typedef enum {
+	SHIM_RUN_IDLE,
+	SHIM_RUN_TIME,
+	SHIM_RUN_SLEEP,
+	SHIM_RUN_RESTART
+} Shim_Run_T;
+
+/*virtual delays applied by the simulated network and station, in microseconds*/
+typedef struct {
+	uint32_t dns;
+	uint32_t connect;
+	uint32_t tls;
+	uint32_t recv;
+	uint32_t scan;
+	uint32_t assoc;
+	uint32_t dhcp;
+	uint32_t ping;
+} Shim_Delay_T;
+
+typedef struct {
+	uint32_t connects;
+	uint32_t handshakes;
+	uint32_t accepts;
+	uint32_t sends;
+	uint32_t dns_queries;
+} Shim_Net_Stats_T;
+
+/*flash and RTC memory live in shared memory, a forked boot writes through to its parent*/
+extern uint8_t* shim_flash;
+
+void shim_flash_erase(void);
+void shim_flash_cut(int32_t bytes);
+uint32_t shim_flash_erases(void);
+uint32_t shim_flash_reads(void);
+void shim_rtc_clear(void);
+void shim_reset(uint32_t reason);
+uint8_t shim_rf_option(void);
+void shim_rtc_advance(uint64_t us);
+/*true RTC tick and the one calibration reports, us with 12 fractional bits, cali 0 for none*/
+void shim_rtc_cali(uint32_t tick, uint32_t cali);
+uint64_t shim_rtc_slept(uint64_t us);
+
+/*virtual clock, starts at zero on every boot*/
+uint64_t shim_now(void);
+void shim_boot(uint32_t reason);
+void shim_call(uint32_t delay_us, void (*fn)(void* arg, uint8_t* data, uint16_t len), void* arg, uint32_t tag,
+	const void* data, uint16_t len);
+void shim_cancel(uint32_t tag);
+Shim_Run_T shim_run(uint64_t until);
+Shim_Run_T shim_run_for(uint64_t us);
+uint64_t shim_sleep_us(void);
+void shim_patience(uint32_t ms);
+
+/*network*/
+void shim_delay(const Shim_Delay_T* delay);
+const Shim_Delay_T* shim_delays(void);
+/*extra recv delay of client connections to one port, a slow target*/
+void shim_port_delay(uint16_t port, uint32_t recv_us);
+void shim_dns_add(const char* host, const char* ip);
+uint16_t shim_espconn_port(struct espconn* conn);
+const Shim_Net_Stats_T* shim_net_stats(void);
+uint8_t shim_net_busy(void);
+uint8_t shim_net_poll(int timeout_ms);
+void shim_net_close_all(void);
+
+/*station, one access point is in range*/
+void shim_wifi_ap(const char* ssid, const char* password, int8_t rssi);
+void shim_wifi_ip(const char* ip, const char* gw);
+void shim_wifi_wps(int status, uint32_t after_ms);
+
+/*GPIO pins and the ADC*/
+void shim_gpio_input(uint8_t pin, uint8_t level);
+uint8_t shim_gpio_output(uint8_t pin);
+void shim_adc(uint16_t value);
+
+#endif
@@ -0,0 +1,738 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build shim: espconn over nonblocking loopback sockets, callbacks are deferred
+// to the event loop after the virtual network delays, TLS is plain TCP plus a delay
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include <espconn.h>
+#include "shim.h"
+
+#define SHIM_CONN_MAX 32
+#define SHIM_DNS_MAX 8
+#define SHIM_DNS_HOST_SIZE 64
+#define SHIM_SEGMENT 1460
+#define SHIM_UNREACHABLE_US 10000000
+#define SHIM_PORT_DELAY_MAX 8
+
+typedef struct {
+	struct espconn* conn;
+	int fd;
+	uint32_t tag;
+	uint16_t port;
+	uint32_t recv_us;
+	uint8_t used : 1;
+	uint8_t listen : 1;
+	uint8_t connecting : 1;
+	uint8_t connected : 1;
+	uint8_t await : 1;
+	uint8_t closing : 1;
+	uint8_t accepted : 1;
+	uint8_t udp : 1;
+	uint8_t secure : 1;
+} Shim_Conn_T;
+
+typedef struct {
+	char host[SHIM_DNS_HOST_SIZE];
+	ip_addr_t ip;
+} Shim_Dns_T;
+
+typedef struct {
+	dns_found_callback found;
+	ip_addr_t ip;
+	uint8_t ok;
+	char host[SHIM_DNS_HOST_SIZE];
+} Shim_Dns_Answer_T;
+
+typedef struct {
+	uint8_t ip[4];
+	uint16_t port;
+} Shim_Udp_From_T;
+
+typedef struct {
+	uint16_t port;
+	uint32_t recv_us;
+} Shim_Port_Delay_T;
+
+static Shim_Conn_T shim_conns[SHIM_CONN_MAX];
+static Shim_Dns_T shim_dns[SHIM_DNS_MAX];
+static ip_addr_t shim_dns_server[2];
+static Shim_Delay_T shim_delay_us = {0};
+static Shim_Port_Delay_T shim_port_delay_us[SHIM_PORT_DELAY_MAX];
+static Shim_Net_Stats_T shim_stats;
+static uint32_t shim_generation = 0;
+static uint16_t shim_local_port = 0;
+
+void shim_delay(const Shim_Delay_T* delay) {
+	shim_delay_us = *delay;
+}
+
+const Shim_Delay_T* shim_delays(void) {
+	return &shim_delay_us;
+}
+
+void shim_port_delay(uint16_t port, uint32_t recv_us) {
+	uint8_t i;
+	for (i = 0; i < SHIM_PORT_DELAY_MAX; i++) {
+		if (!shim_port_delay_us[i].port || (shim_port_delay_us[i].port == port)) {
+			shim_port_delay_us[i].port = port;
+			shim_port_delay_us[i].recv_us = recv_us;
+			return;
+		}
+	}
+}
+
+static uint32_t shim_port_recv_us(uint16_t port) {
+	uint8_t i;
+	for (i = 0; i < SHIM_PORT_DELAY_MAX; i++) {
+		if (shim_port_delay_us[i].port == port) {
+			return shim_port_delay_us[i].recv_us;
+		}
+	}
+	return 0;
+}
+
+const Shim_Net_Stats_T* shim_net_stats(void) {
+	return &shim_stats;
+}
+
+void shim_dns_add(const char* host, const char* ip) {
+	uint8_t i;
+	for (i = 0; i < SHIM_DNS_MAX; i++) {
+		if (!shim_dns[i].host[0] || !strcmp(shim_dns[i].host, host)) {
+			strncpy(shim_dns[i].host, host, SHIM_DNS_HOST_SIZE - 1);
+			shim_dns[i].ip.addr = inet_addr(ip);
+			return;
+		}
+	}
+}
+
+static Shim_Conn_T* shim_conn_find(struct espconn* conn) {
+	uint8_t i;
+	for (i = 0; i < SHIM_CONN_MAX; i++) {
+		if (shim_conns[i].used && (shim_conns[i].conn == conn)) {
+			return &shim_conns[i];
+		}
+	}
+	return NULL;
+}
+
+static Shim_Conn_T* shim_conn_new(struct espconn* conn, int fd) {
+	uint8_t i;
+	for (i = 0; i < SHIM_CONN_MAX; i++) {
+		if (!shim_conns[i].used) {
+			memset(&shim_conns[i], 0, sizeof(Shim_Conn_T));
+			shim_conns[i].used = 1;
+			shim_conns[i].conn = conn;
+			shim_conns[i].fd = fd;
+			shim_conns[i].tag = ((++shim_generation) << 8) | (i + 1);
+			return &shim_conns[i];
+		}
+	}
+	return NULL;
+}
+
+static void shim_conn_free(Shim_Conn_T* c) {
+	if (c->fd >= 0) {
+		close(c->fd);
+	}
+	shim_cancel(c->tag);
+	memset(c, 0, sizeof(Shim_Conn_T));
+	c->fd = -1;
+}
+
+static void shim_free_cb(void* arg, uint8_t* data, uint16_t len) {
+	free(arg);
+}
+
+static int shim_socket(int type) {
+	int fd;
+	int one = 1;
+	if ((fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0) {
+		return -1;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	if (type == SOCK_STREAM) {
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	} else {
+		setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+	}
+	return fd;
+}
+
+/*ports below 1024 need root, those and taken ones move to an ephemeral port*/
+static int shim_bind(int fd, int port) {
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = (port >= 1024) ? htons(port) : 0;
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+		addr.sin_port = 0;
+		if (bind(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+			return -1;
+		}
+	}
+	if (getsockname(fd, (struct sockaddr*)&addr, &addr_len)) {
+		return -1;
+	}
+	return ntohs(addr.sin_port);
+}
+
+uint16_t shim_espconn_port(struct espconn* conn) {
+	Shim_Conn_T* c = shim_conn_find(conn);
+	return c ? c->port : 0;
+}
+
+static void shim_connected_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Conn_T* c = arg;
+	c->connected = 1;
+	c->conn->state = ESPCONN_CONNECT;
+	if (c->conn->proto.tcp->connect_callback) {
+		c->conn->proto.tcp->connect_callback(c->conn);
+	}
+}
+
+static void shim_error_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Conn_T* c = arg;
+	struct espconn* conn = c->conn;
+	uint8_t accepted = c->accepted;
+	shim_conn_free(c);
+	conn->state = ESPCONN_CLOSE;
+	if (conn->proto.tcp->reconnect_callback) {
+		conn->proto.tcp->reconnect_callback(conn, (sint8)data[0]);
+	}
+	if (accepted) {
+		shim_call(0, shim_free_cb, conn, 0, NULL, 0);
+	}
+}
+
+static void shim_closed_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Conn_T* c = arg;
+	struct espconn* conn = c->conn;
+	uint8_t accepted = c->accepted;
+	shim_conn_free(c);
+	conn->state = ESPCONN_CLOSE;
+	if (conn->proto.tcp->disconnect_callback) {
+		conn->proto.tcp->disconnect_callback(conn);
+	}
+	if (accepted) {
+		shim_call(0, shim_free_cb, conn, 0, NULL, 0);
+	}
+}
+
+static void shim_recv_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Conn_T* c = arg;
+	if (c->conn->recv_callback) {
+		c->conn->recv_callback(c->conn, (char*)data, len);
+	}
+}
+
+static void shim_udp_recv_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Conn_T* c = arg;
+	Shim_Udp_From_T from;
+	memcpy(&from, data, sizeof(from));
+	memcpy(c->conn->proto.udp->remote_ip, from.ip, 4);
+	c->conn->proto.udp->remote_port = from.port;
+	if (c->conn->recv_callback) {
+		c->conn->recv_callback(c->conn, (char*)data + sizeof(from), len - sizeof(from));
+	}
+}
+
+static void shim_sent_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Conn_T* c = arg;
+	if (c->conn->sent_callback) {
+		c->conn->sent_callback(c->conn);
+	}
+}
+
+static void shim_error(Shim_Conn_T* c, uint32_t delay, sint8 err) {
+	uint8_t code = (uint8_t)err;
+	if (c->fd >= 0) {
+		close(c->fd);
+		c->fd = -1;
+	}
+	c->connecting = 0;
+	c->closing = 1;
+	c->await = 0;
+	shim_call(delay, shim_error_cb, c, c->tag, &code, 1);
+}
+
+static void shim_dns_cb(void* arg, uint8_t* data, uint16_t len) {
+	Shim_Dns_Answer_T answer;
+	memcpy(&answer, data, sizeof(answer));
+	answer.found(answer.host, answer.ok ? &answer.ip : NULL, arg);
+}
+
+err_t espconn_gethostbyname(struct espconn* pespconn, const char* hostname, ip_addr_t* addr, dns_found_callback found) {
+	Shim_Dns_Answer_T answer;
+	struct in_addr in;
+	uint8_t i;
+	if (!hostname || !addr || !found) {
+		return ESPCONN_ARG;
+	}
+	if (inet_aton(hostname, &in)) {
+		addr->addr = in.s_addr;
+		return ESPCONN_OK;
+	}
+	shim_stats.dns_queries++;
+	memset(&answer, 0, sizeof(answer));
+	answer.found = found;
+	strncpy(answer.host, hostname, SHIM_DNS_HOST_SIZE - 1);
+	if (!strcmp(hostname, "localhost")) {
+		answer.ip.addr = htonl(INADDR_LOOPBACK);
+		answer.ok = 1;
+	}
+	for (i = 0; i < SHIM_DNS_MAX; i++) {
+		if (shim_dns[i].host[0] && !strcmp(shim_dns[i].host, hostname)) {
+			answer.ip = shim_dns[i].ip;
+			answer.ok = 1;
+		}
+	}
+	shim_call(shim_delay_us.dns, shim_dns_cb, pespconn, 0, &answer, sizeof(answer));
+	return ESPCONN_INPROGRESS;
+}
+
+void espconn_dns_setserver(uint8 numdns, ip_addr_t* dnsserver) {
+	if ((numdns < 2) && dnsserver) {
+		shim_dns_server[numdns] = *dnsserver;
+	}
+}
+
+ip_addr_t espconn_dns_getserver(uint8 numdns) {
+	ip_addr_t none = {0};
+	return (numdns < 2) ? shim_dns_server[numdns] : none;
+}
+
+uint32 espconn_port(void) {
+	shim_local_port = (shim_local_port < 49152) ? 49152 : (shim_local_port + 1);
+	return shim_local_port;
+}
+
+static sint8 shim_connect(struct espconn* conn, uint8_t secure) {
+	struct sockaddr_in addr;
+	Shim_Conn_T* c;
+	int fd;
+	if (!conn || (conn->type != ESPCONN_TCP) || !conn->proto.tcp) {
+		return ESPCONN_ARG;
+	}
+	if (shim_conn_find(conn)) {
+		return ESPCONN_ISCONN;
+	}
+	if ((fd = shim_socket(SOCK_STREAM)) < 0) {
+		return ESPCONN_MEM;
+	}
+	if (!(c = shim_conn_new(conn, fd))) {
+		close(fd);
+		return ESPCONN_MAXNUM;
+	}
+	shim_stats.connects++;
+	if (secure) {
+		shim_stats.handshakes++;
+		c->secure = 1;
+	}
+	conn->state = ESPCONN_WAIT;
+	/*only the loopback network is simulated, anything else times out*/
+	if (conn->proto.tcp->remote_ip[0] != 127) {
+		shim_error(c, SHIM_UNREACHABLE_US, ESPCONN_TIMEOUT);
+		return ESPCONN_OK;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	memcpy(&addr.sin_addr.s_addr, conn->proto.tcp->remote_ip, 4);
+	addr.sin_port = htons(conn->proto.tcp->remote_port);
+	if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) && (errno != EINPROGRESS)) {
+		shim_error(c, shim_delay_us.connect, ESPCONN_RTE);
+		return ESPCONN_OK;
+	}
+	c->recv_us = shim_port_recv_us(conn->proto.tcp->remote_port);
+	c->connecting = 1;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_connect(struct espconn* espconn) {
+	return shim_connect(espconn, 0);
+}
+
+sint8 espconn_secure_connect(struct espconn* espconn) {
+	return shim_connect(espconn, 1);
+}
+
+sint8 espconn_accept(struct espconn* espconn) {
+	Shim_Conn_T* c;
+	int fd;
+	int port;
+	if (!espconn || (espconn->type != ESPCONN_TCP) || !espconn->proto.tcp) {
+		return ESPCONN_ARG;
+	}
+	if (shim_conn_find(espconn)) {
+		return ESPCONN_ISCONN;
+	}
+	if ((fd = shim_socket(SOCK_STREAM)) < 0) {
+		return ESPCONN_MEM;
+	}
+	if (((port = shim_bind(fd, espconn->proto.tcp->local_port)) < 0) || listen(fd, 8)) {
+		close(fd);
+		return ESPCONN_RTE;
+	}
+	if (!(c = shim_conn_new(espconn, fd))) {
+		close(fd);
+		return ESPCONN_MAXNUM;
+	}
+	c->listen = 1;
+	c->port = port;
+	espconn->state = ESPCONN_LISTEN;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_create(struct espconn* espconn) {
+	Shim_Conn_T* c;
+	int fd;
+	int port;
+	if (!espconn || (espconn->type != ESPCONN_UDP) || !espconn->proto.udp) {
+		return ESPCONN_ARG;
+	}
+	if (shim_conn_find(espconn)) {
+		return ESPCONN_ISCONN;
+	}
+	if ((fd = shim_socket(SOCK_DGRAM)) < 0) {
+		return ESPCONN_MEM;
+	}
+	if ((port = shim_bind(fd, espconn->proto.udp->local_port)) < 0) {
+		close(fd);
+		return ESPCONN_RTE;
+	}
+	if (!(c = shim_conn_new(espconn, fd))) {
+		close(fd);
+		return ESPCONN_MAXNUM;
+	}
+	c->udp = 1;
+	c->connected = 1;
+	c->port = port;
+	return ESPCONN_OK;
+}
+
+static sint8 shim_write(Shim_Conn_T* c, uint8* data, uint16 length) {
+	struct pollfd pfd;
+	ssize_t n;
+	uint16_t done = 0;
+	while (done < length) {
+		n = send(c->fd, data + done, length - done, MSG_NOSIGNAL);
+		if (n > 0) {
+			done += n;
+			continue;
+		}
+		if ((n < 0) && (errno == EAGAIN)) {
+			pfd.fd = c->fd;
+			pfd.events = POLLOUT;
+			poll(&pfd, 1, 100);
+			continue;
+		}
+		return ESPCONN_CONN;
+	}
+	return ESPCONN_OK;
+}
+
+sint8 espconn_send(struct espconn* espconn, uint8* psent, uint16 length) {
+	Shim_Conn_T* c = shim_conn_find(espconn);
+	sint8 result;
+	if (!c || c->listen || c->udp || !c->connected || c->closing || !psent) {
+		return ESPCONN_ARG;
+	}
+	if ((result = shim_write(c, psent, length))) {
+		return result;
+	}
+	shim_stats.sends++;
+	if (!c->accepted) {
+		c->await = 1;
+	}
+	shim_call(0, shim_sent_cb, c, c->tag, NULL, 0);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_secure_send(struct espconn* espconn, uint8* psent, uint16 length) {
+	return espconn_send(espconn, psent, length);
+}
+
+/*broadcasts and the simulated subnet land on the loopback interface*/
+sint8 espconn_sendto(struct espconn* espconn, uint8* psent, uint16 length) {
+	Shim_Conn_T* c = shim_conn_find(espconn);
+	struct sockaddr_in addr;
+	if (!c || !c->udp || !psent) {
+		return ESPCONN_ARG;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(espconn->proto.udp->remote_port);
+	if (sendto(c->fd, psent, length, 0, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		return ESPCONN_IF;
+	}
+	shim_stats.sends++;
+	shim_call(0, shim_sent_cb, c, c->tag, NULL, 0);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_disconnect(struct espconn* espconn) {
+	Shim_Conn_T* c = shim_conn_find(espconn);
+	if (!c || c->listen || c->udp) {
+		return ESPCONN_ARG;
+	}
+	if (c->connecting) {
+		return ESPCONN_INPROGRESS;
+	}
+	if (c->closing) {
+		return ESPCONN_OK;
+	}
+	shim_cancel(c->tag);
+	close(c->fd);
+	c->fd = -1;
+	c->closing = 1;
+	c->await = 0;
+	shim_call(0, shim_closed_cb, c, c->tag, NULL, 0);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_secure_disconnect(struct espconn* espconn) {
+	return espconn_disconnect(espconn);
+}
+
+sint8 espconn_delete(struct espconn* espconn) {
+	Shim_Conn_T* c = shim_conn_find(espconn);
+	if (!c) {
+		return ESPCONN_ARG;
+	}
+	if (c->accepted) {
+		shim_call(0, shim_free_cb, espconn, 0, NULL, 0);
+	}
+	shim_conn_free(c);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_secure_delete(struct espconn* espconn) {
+	return espconn_delete(espconn);
+}
+
+sint8 espconn_regist_connectcb(struct espconn* espconn, espconn_connect_callback connect_cb) {
+	if (!espconn || (espconn->type != ESPCONN_TCP) || !espconn->proto.tcp) {
+		return ESPCONN_ARG;
+	}
+	espconn->proto.tcp->connect_callback = connect_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_reconcb(struct espconn* espconn, espconn_reconnect_callback recon_cb) {
+	if (!espconn || (espconn->type != ESPCONN_TCP) || !espconn->proto.tcp) {
+		return ESPCONN_ARG;
+	}
+	espconn->proto.tcp->reconnect_callback = recon_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_disconcb(struct espconn* espconn, espconn_connect_callback discon_cb) {
+	if (!espconn || (espconn->type != ESPCONN_TCP) || !espconn->proto.tcp) {
+		return ESPCONN_ARG;
+	}
+	espconn->proto.tcp->disconnect_callback = discon_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_recvcb(struct espconn* espconn, espconn_recv_callback recv_cb) {
+	if (!espconn) {
+		return ESPCONN_ARG;
+	}
+	espconn->recv_callback = recv_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_sentcb(struct espconn* espconn, espconn_sent_callback sent_cb) {
+	if (!espconn) {
+		return ESPCONN_ARG;
+	}
+	espconn->sent_callback = sent_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_time(struct espconn* espconn, uint32 interval, uint8 type_flag) {
+	return espconn ? ESPCONN_OK : ESPCONN_ARG;
+}
+
+sint8 espconn_set_opt(struct espconn* espconn, uint8 opt) {
+	return espconn ? ESPCONN_OK : ESPCONN_ARG;
+}
+
+sint8 espconn_tcp_set_max_con_allow(struct espconn* espconn, uint8 num) {
+	return espconn ? ESPCONN_OK : ESPCONN_ARG;
+}
+
+/*the accepted connection takes the callbacks of the listening one*/
+static void shim_accept(Shim_Conn_T* listener) {
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	struct espconn* conn;
+	esp_tcp* tcp;
+	Shim_Conn_T* c;
+	int one = 1;
+	int fd;
+	if ((fd = accept4(listener->fd, (struct sockaddr*)&addr, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC)) < 0) {
+		return;
+	}
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	if (!(conn = calloc(1, sizeof(struct espconn) + sizeof(esp_tcp)))) {
+		close(fd);
+		return;
+	}
+	tcp = (esp_tcp*)(conn + 1);
+	*tcp = *listener->conn->proto.tcp;
+	*conn = *listener->conn;
+	conn->proto.tcp = tcp;
+	conn->state = ESPCONN_CONNECT;
+	conn->reverse = NULL;
+	memcpy(tcp->remote_ip, &addr.sin_addr.s_addr, 4);
+	tcp->remote_port = ntohs(addr.sin_port);
+	tcp->local_port = listener->port;
+	if (!(c = shim_conn_new(conn, fd))) {
+		close(fd);
+		free(conn);
+		return;
+	}
+	shim_stats.accepts++;
+	c->accepted = 1;
+	shim_call(0, shim_connected_cb, c, c->tag, NULL, 0);
+}
+
+static void shim_read(Shim_Conn_T* c) {
+	uint8_t buffer[sizeof(Shim_Udp_From_T) + SHIM_SEGMENT];
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	Shim_Udp_From_T from;
+	ssize_t n;
+	if (c->udp) {
+		while ((n = recvfrom(c->fd, buffer + sizeof(from), SHIM_SEGMENT, 0, (struct sockaddr*)&addr, &addr_len)) > 0) {
+			memcpy(from.ip, &addr.sin_addr.s_addr, 4);
+			from.port = ntohs(addr.sin_port);
+			memcpy(buffer, &from, sizeof(from));
+			shim_call(shim_delay_us.recv, shim_udp_recv_cb, c, c->tag, buffer, sizeof(from) + n);
+			addr_len = sizeof(addr);
+		}
+		return;
+	}
+	/*a segment at a time, as lwip hands them up*/
+	while ((n = recv(c->fd, buffer, SHIM_SEGMENT, 0)) > 0) {
+		c->await = 0;
+		shim_call(shim_delay_us.recv + c->recv_us, shim_recv_cb, c, c->tag, buffer, n);
+	}
+	if (!n) {
+		close(c->fd);
+		c->fd = -1;
+		c->closing = 1;
+		c->await = 0;
+		shim_call(shim_delay_us.recv + c->recv_us, shim_closed_cb, c, c->tag, NULL, 0);
+	} else if (errno != EAGAIN) {
+		shim_error(c, shim_delay_us.recv + c->recv_us, ESPCONN_RST);
+	}
+}
+
+static void shim_connect_done(Shim_Conn_T* c) {
+	socklen_t len = sizeof(int);
+	int err = 0;
+	c->connecting = 0;
+	if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len) || err) {
+		shim_error(c, shim_delay_us.connect, ESPCONN_CONN);
+		return;
+	}
+	shim_call(shim_delay_us.connect + (c->secure ? shim_delay_us.tls : 0), shim_connected_cb, c, c->tag, NULL, 0);
+}
+
+/*a request is out and its answer has not come back yet*/
+uint8_t shim_net_busy(void) {
+	uint8_t i;
+	for (i = 0; i < SHIM_CONN_MAX; i++) {
+		if (shim_conns[i].used && (shim_conns[i].connecting || shim_conns[i].await)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+uint8_t shim_net_poll(int timeout_ms) {
+	struct pollfd pfd[SHIM_CONN_MAX];
+	Shim_Conn_T* which[SHIM_CONN_MAX];
+	uint8_t count = 0;
+	uint8_t events = 0;
+	uint8_t i;
+	for (i = 0; i < SHIM_CONN_MAX; i++) {
+		Shim_Conn_T* c = &shim_conns[i];
+		if (!c->used || (c->fd < 0) || c->closing) {
+			continue;
+		}
+		if (c->connecting) {
+			pfd[count].events = POLLOUT;
+		} else if (c->listen || c->connected) {
+			pfd[count].events = POLLIN;
+		} else {
+			continue;
+		}
+		pfd[count].fd = c->fd;
+		pfd[count].revents = 0;
+		which[count++] = c;
+	}
+	if (!count) {
+		return 0;
+	}
+	if (poll(pfd, count, timeout_ms) <= 0) {
+		return 0;
+	}
+	for (i = 0; i < count; i++) {
+		if (!pfd[i].revents || !which[i]->used || (which[i]->fd != pfd[i].fd)) {
+			continue;
+		}
+		events++;
+		if (which[i]->connecting) {
+			shim_connect_done(which[i]);
+		} else if (which[i]->listen) {
+			shim_accept(which[i]);
+		} else {
+			shim_read(which[i]);
+		}
+	}
+	return events;
+}
+
+/*a boot starts without sockets, peers see the connections reset*/
+void shim_net_close_all(void) {
+	uint8_t i;
+	for (i = 0; i < SHIM_CONN_MAX; i++) {
+		if (shim_conns[i].used) {
+			if (shim_conns[i].accepted) {
+				free(shim_conns[i].conn);
+			}
+			shim_conn_free(&shim_conns[i]);
+		}
+	}
+}
@@ -0,0 +1,232 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build shim: GPIO and IO mux registers, pin levels driven by the test,
+// the GPIO interrupt and the FRC1 hardware timer on the virtual clock
+
+#include <string.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include <gpio.h>
+#include <ets_sys.h>
+#include "hw_timer.h"
+#include "shim.h"
+
+#define SHIM_REG_MAX 64
+#define SHIM_INUM_MAX 32
+
+typedef struct {
+	uint32_t addr;
+	uint32_t value;
+} Shim_Reg_T;
+
+static Shim_Reg_T shim_regs[SHIM_REG_MAX];
+static uint32_t shim_gpio_out = 0;
+static uint32_t shim_gpio_enable = 0;
+/*lines idle high on their pull ups until the test pulls them low*/
+static uint32_t shim_gpio_in = 0xFFFF;
+static uint32_t shim_gpio_od = 0;
+static uint32_t shim_gpio_status = 0;
+static uint8_t shim_gpio_type[GPIO_PIN_COUNT];
+static ets_isr_t shim_isr[SHIM_INUM_MAX];
+static void* shim_isr_arg[SHIM_INUM_MAX];
+static uint32_t shim_isr_masked = 0xFFFFFFFF;
+static os_timer_t shim_frc1;
+static void (*shim_frc1_fn)(void) = NULL;
+static uint8_t shim_frc1_reload = 0;
+
+static uint32_t* shim_reg(uint32_t addr) {
+	uint8_t i;
+	for (i = 0; i < SHIM_REG_MAX; i++) {
+		if (shim_regs[i].addr == addr) {
+			return &shim_regs[i].value;
+		}
+		if (!shim_regs[i].addr) {
+			shim_regs[i].addr = addr;
+			return &shim_regs[i].value;
+		}
+	}
+	abort();
+}
+
+/*an open drain output reads low when driven low or pulled low from outside*/
+static uint32_t shim_gpio_level(void) {
+	uint32_t pp = shim_gpio_enable & ~shim_gpio_od;
+	uint32_t od = shim_gpio_enable & shim_gpio_od;
+	return (shim_gpio_in & ~shim_gpio_enable) | (shim_gpio_out & pp) | (shim_gpio_out & shim_gpio_in & od);
+}
+
+uint32_t shim_reg_read(uint32_t addr) {
+	switch (addr - PERIPHS_GPIO_BASEADDR) {
+		case GPIO_OUT_ADDRESS:
+			return shim_gpio_out;
+		case GPIO_ENABLE_ADDRESS:
+			return shim_gpio_enable;
+		case GPIO_IN_ADDRESS:
+			return shim_gpio_level();
+		case GPIO_STATUS_ADDRESS:
+			return shim_gpio_status;
+		default:
+			return *shim_reg(addr);
+	}
+}
+
+void shim_reg_write(uint32_t addr, uint32_t value) {
+	uint32_t pin;
+	switch (addr - PERIPHS_GPIO_BASEADDR) {
+		case GPIO_OUT_ADDRESS:
+			shim_gpio_out = value;
+			return;
+		case GPIO_OUT_W1TS_ADDRESS:
+			shim_gpio_out |= value;
+			return;
+		case GPIO_OUT_W1TC_ADDRESS:
+			shim_gpio_out &= ~value;
+			return;
+		case GPIO_ENABLE_ADDRESS:
+			shim_gpio_enable = value;
+			return;
+		case GPIO_ENABLE_W1TS_ADDRESS:
+			shim_gpio_enable |= value;
+			return;
+		case GPIO_ENABLE_W1TC_ADDRESS:
+			shim_gpio_enable &= ~value;
+			return;
+		case GPIO_STATUS_ADDRESS:
+			shim_gpio_status = value;
+			return;
+		case GPIO_STATUS_W1TS_ADDRESS:
+			shim_gpio_status |= value;
+			return;
+		case GPIO_STATUS_W1TC_ADDRESS:
+			shim_gpio_status &= ~value;
+			return;
+		default:
+			break;
+	}
+	pin = (addr - PERIPHS_GPIO_BASEADDR - GPIO_PIN0_ADDRESS) / 4;
+	if ((addr >= PERIPHS_GPIO_BASEADDR + GPIO_PIN0_ADDRESS) && (pin < GPIO_PIN_COUNT)) {
+		shim_gpio_type[pin] = GPIO_PIN_INT_TYPE_GET(value);
+		if (value & GPIO_PIN_PAD_DRIVER_MASK) {
+			shim_gpio_od |= 1 << pin;
+		} else {
+			shim_gpio_od &= ~(1 << pin);
+		}
+	}
+	*shim_reg(addr) = value;
+}
+
+void ets_isr_attach(int intr, ets_isr_t handler, void* arg) {
+	if ((intr >= 0) && (intr < SHIM_INUM_MAX)) {
+		shim_isr[intr] = handler;
+		shim_isr_arg[intr] = arg;
+	}
+}
+
+void ets_isr_mask(uint32 mask) {
+	shim_isr_masked |= mask;
+}
+
+void ets_isr_unmask(uint32 unmask) {
+	shim_isr_masked &= ~unmask;
+}
+
+void ets_intr_lock(void) {
+}
+
+void ets_intr_unlock(void) {
+}
+
+static void shim_isr_raise(int intr) {
+	if (!(shim_isr_masked & (1 << intr)) && shim_isr[intr]) {
+		shim_isr[intr](shim_isr_arg[intr]);
+	}
+}
+
+void gpio_init(void) {
+}
+
+void gpio_pin_intr_state_set(uint32 i, GPIO_INT_TYPE intr_state) {
+	if (i < GPIO_PIN_COUNT) {
+		shim_gpio_type[i] = intr_state;
+	}
+}
+
+void gpio_output_set(uint32 set_mask, uint32 clear_mask, uint32 enable_mask, uint32 disable_mask) {
+	shim_gpio_out = (shim_gpio_out | set_mask) & ~clear_mask;
+	shim_gpio_enable = (shim_gpio_enable | enable_mask) & ~disable_mask;
+}
+
+uint32 gpio_input_get(void) {
+	return shim_gpio_level();
+}
+
+/*an edge matching the pin interrupt type sets its status bit and enters the handler*/
+void shim_gpio_input(uint8_t pin, uint8_t level) {
+	uint32_t bit = 1 << pin;
+	uint8_t was = (shim_gpio_in & bit) ? 1 : 0;
+	uint8_t fire = 0;
+	if (pin >= GPIO_PIN_COUNT) {
+		return;
+	}
+	shim_gpio_in = level ? (shim_gpio_in | bit) : (shim_gpio_in & ~bit);
+	switch (shim_gpio_type[pin]) {
+		case GPIO_PIN_INTR_POSEDGE:
+			fire = !was && level;
+			break;
+		case GPIO_PIN_INTR_NEGEDGE:
+			fire = was && !level;
+			break;
+		case GPIO_PIN_INTR_ANYEDGE:
+			fire = was != level;
+			break;
+		case GPIO_PIN_INTR_LOLEVEL:
+			fire = !level;
+			break;
+		case GPIO_PIN_INTR_HILEVEL:
+			fire = level;
+			break;
+		default:
+			break;
+	}
+	if (fire) {
+		shim_gpio_status |= bit;
+		shim_isr_raise(ETS_GPIO_INUM);
+	}
+}
+
+uint8_t shim_gpio_output(uint8_t pin) {
+	return (shim_gpio_out >> pin) & 1;
+}
+
+static void shim_frc1_cb(void* arg) {
+	if (!(shim_isr_masked & (1 << ETS_FRC_TIMER1_INUM)) && shim_frc1_fn) {
+		shim_frc1_fn();
+	}
+}
+
+void hw_timer_set_func(void (*user_hw_timer_cb_set)(void)) {
+	shim_frc1_fn = user_hw_timer_cb_set;
+}
+
+void hw_timer_init(frc1_timer_source_type source_type, uint8_t req) {
+	shim_frc1_reload = req ? 1 : 0;
+	os_timer_disarm(&shim_frc1);
+	os_timer_setfn(&shim_frc1, shim_frc1_cb, NULL);
+	ets_isr_unmask(1 << ETS_FRC_TIMER1_INUM);
+}
+
+void hw_timer_arm(uint32_t val) {
+	os_timer_arm_us(&shim_frc1, val, shim_frc1_reload);
+}
@@ -0,0 +1,270 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build shim: the SDK task loop on a virtual microsecond clock, os_timer and
+// deferred callbacks run in deadline order, sockets are polled in real time
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include <upgrade.h>
+#include "shim.h"
+
+#define SHIM_PATIENCE_MS 2000
+
+/*callback deferred to task context, data is copied along*/
+typedef struct Shim_Call_T {
+	struct Shim_Call_T* next;
+	uint64_t due;
+	void (*fn)(void* arg, uint8_t* data, uint16_t len);
+	void* arg;
+	uint32_t tag;
+	uint16_t len;
+	uint8_t data[];
+} Shim_Call_T;
+
+static uint64_t shim_time = 0;
+static os_timer_t* shim_timers = NULL;
+static Shim_Call_T* shim_calls = NULL;
+static Shim_Run_T shim_stop = SHIM_RUN_IDLE;
+static uint64_t shim_sleep = 0;
+static uint32_t shim_patience_ms = SHIM_PATIENCE_MS;
+
+uint64_t shim_now(void) {
+	return shim_time;
+}
+
+uint64_t shim_sleep_us(void) {
+	return shim_sleep;
+}
+
+/*how long to wait in real time for an answer before the clock may jump past it*/
+void shim_patience(uint32_t ms) {
+	shim_patience_ms = ms;
+}
+
+void shim_call(uint32_t delay_us, void (*fn)(void* arg, uint8_t* data, uint16_t len), void* arg, uint32_t tag,
+	const void* data, uint16_t len) {
+	Shim_Call_T** at = &shim_calls;
+	Shim_Call_T* call;
+	if (!(call = malloc(sizeof(Shim_Call_T) + len))) {
+		abort();
+	}
+	call->next = NULL;
+	call->due = shim_time + delay_us;
+	call->fn = fn;
+	call->arg = arg;
+	call->tag = tag;
+	call->len = len;
+	if (len) {
+		memcpy(call->data, data, len);
+	}
+	/*same deadline keeps the posting order*/
+	while (*at && ((*at)->due <= call->due)) {
+		at = &(*at)->next;
+	}
+	call->next = *at;
+	*at = call;
+}
+
+void shim_cancel(uint32_t tag) {
+	Shim_Call_T** at = &shim_calls;
+	Shim_Call_T* call;
+	while ((call = *at)) {
+		if (call->tag == tag) {
+			*at = call->next;
+			free(call);
+			continue;
+		}
+		at = &call->next;
+	}
+}
+
+static void shim_timer_remove(os_timer_t* timer) {
+	os_timer_t** at = &shim_timers;
+	while (*at) {
+		if (*at == timer) {
+			*at = timer->timer_next;
+			break;
+		}
+		at = &(*at)->timer_next;
+	}
+	timer->timer_next = NULL;
+	timer->timer_armed = 0;
+}
+
+static void shim_timer_insert(os_timer_t* timer) {
+	os_timer_t** at = &shim_timers;
+	while (*at && ((*at)->timer_expire <= timer->timer_expire)) {
+		at = &(*at)->timer_next;
+	}
+	timer->timer_next = *at;
+	*at = timer;
+	timer->timer_armed = 1;
+}
+
+void os_timer_disarm(os_timer_t* timer) {
+	if (timer && timer->timer_armed) {
+		shim_timer_remove(timer);
+	}
+}
+
+void os_timer_setfn(os_timer_t* timer, os_timer_func_t* func, void* arg) {
+	if (!timer) {
+		return;
+	}
+	os_timer_disarm(timer);
+	timer->timer_func = func;
+	timer->timer_arg = arg;
+}
+
+void os_timer_arm_us(os_timer_t* timer, uint32_t us, bool repeat) {
+	if (!timer) {
+		return;
+	}
+	os_timer_disarm(timer);
+	timer->timer_expire = shim_time + us;
+	timer->timer_period = repeat ? us : 0;
+	shim_timer_insert(timer);
+}
+
+void os_timer_arm(os_timer_t* timer, uint32_t ms, bool repeat) {
+	os_timer_arm_us(timer, ms * 1000, repeat);
+}
+
+/*busy wait, the clock moves on*/
+void ets_delay_us(uint32 us) {
+	shim_time += us;
+}
+
+void system_deep_sleep(uint64 time_in_us) {
+	shim_sleep = time_in_us;
+	shim_stop = SHIM_RUN_SLEEP;
+}
+
+void system_restart(void) {
+	shim_stop = SHIM_RUN_RESTART;
+}
+
+void system_upgrade_reboot(void) {
+	shim_stop = SHIM_RUN_RESTART;
+}
+
+/*fresh clock and an empty loop, flash and RTC memory stay*/
+void shim_boot(uint32_t reason) {
+	Shim_Call_T* call;
+	while (shim_timers) {
+		shim_timer_remove(shim_timers);
+	}
+	while ((call = shim_calls)) {
+		shim_calls = call->next;
+		free(call);
+	}
+	shim_net_close_all();
+	shim_time = 0;
+	shim_sleep = 0;
+	shim_stop = SHIM_RUN_IDLE;
+	shim_reset(reason);
+}
+
+static uint64_t shim_next(void) {
+	uint64_t next = SHIM_NEVER;
+	if (shim_timers) {
+		next = shim_timers->timer_expire;
+	}
+	if (shim_calls && (shim_calls->due < next)) {
+		next = shim_calls->due;
+	}
+	return next;
+}
+
+/*one due callback, deferred calls before timers of the same deadline*/
+static void shim_dispatch(void) {
+	os_timer_t* timer;
+	Shim_Call_T* call;
+	if (shim_calls && (shim_calls->due <= shim_time)) {
+		call = shim_calls;
+		shim_calls = call->next;
+		call->fn(call->arg, call->len ? call->data : NULL, call->len);
+		free(call);
+		return;
+	}
+	timer = shim_timers;
+	shim_timer_remove(timer);
+	if (timer->timer_period) {
+		timer->timer_expire += timer->timer_period;
+		shim_timer_insert(timer);
+	}
+	if (timer->timer_func) {
+		timer->timer_func(timer->timer_arg);
+	}
+}
+
+static uint64_t shim_real_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*runs callbacks until the virtual clock passes until, the firmware sleeps or reboots, or nothing is left*/
+Shim_Run_T shim_run(uint64_t until) {
+	uint64_t waiting = 0;
+	uint8_t gave_up = 0;
+	uint64_t next;
+	while (shim_stop == SHIM_RUN_IDLE) {
+		if (shim_net_poll(0)) {
+			waiting = 0;
+			gave_up = 0;
+		}
+		next = shim_next();
+		if ((next <= shim_time) && (next <= until)) {
+			shim_dispatch();
+			continue;
+		}
+		/*an answer is on its way, it arrives before any later deadline unless the peer stays silent*/
+		if (!gave_up && shim_net_busy()) {
+			if (!waiting) {
+				waiting = shim_real_ms();
+			}
+			if (shim_net_poll(1)) {
+				waiting = 0;
+				continue;
+			}
+			if ((shim_real_ms() - waiting) < shim_patience_ms) {
+				continue;
+			}
+			gave_up = 1;
+		}
+		waiting = 0;
+		if (next == SHIM_NEVER) {
+			if (until == SHIM_NEVER) {
+				return SHIM_RUN_IDLE;
+			}
+			shim_time = until;
+			return SHIM_RUN_TIME;
+		}
+		if (next > until) {
+			shim_time = until;
+			return SHIM_RUN_TIME;
+		}
+		shim_time = next;
+	}
+	return shim_stop;
+}
+
+Shim_Run_T shim_run_for(uint64_t us) {
+	return shim_run(shim_time + us);
+}
@@ -0,0 +1,388 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build shim: one access point in range, association, DHCP, scan, WPS and
+// the gateway ping take the virtual delays set with shim_delay
+
+#include <string.h>
+#include <arpa/inet.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include <espconn.h>
+#include <ping.h>
+#include "shim.h"
+
+#define SHIM_WIFI_TAG 0xF0
+#define SHIM_WPS_TAG 0xF1
+#define SHIM_PING_TAG 0xF2
+#define SHIM_SCAN_TAG 0xF3
+#define SHIM_WIFI_CHANNEL 6
+#define SHIM_WIFI_NO_RSSI 31
+#define SHIM_PING_TIMEOUT_US 1000000
+
+typedef struct {
+	char ssid[32];
+	char password[64];
+	uint8_t bssid[6];
+	int8_t rssi;
+} Shim_Ap_T;
+
+static Shim_Ap_T shim_ap = {
+	.ssid = "shim",
+	.password = "shim-password",
+	.bssid = {0x02, 0x00, 0x00, 0x5a, 0x11, 0x01},
+	.rssi = -60
+};
+static uint8_t shim_mac[6] = {0x5c, 0xcf, 0x7f, 0x12, 0x34, 0x56};
+static ip_addr_t shim_dhcp_ip = {0};
+static ip_addr_t shim_dhcp_gw = {0};
+static wifi_event_handler_cb_t shim_event_cb = NULL;
+static wps_st_cb_t shim_wps_cb = NULL;
+static int shim_wps_status = WPS_CB_ST_TIMEOUT;
+static uint32_t shim_wps_after_ms = 120000;
+static struct station_config shim_station;
+static struct ip_info shim_sta_info;
+static struct ip_info shim_static_info;
+static struct ip_info shim_ap_info;
+static struct bss_info shim_bss;
+static struct ping_resp shim_ping_resp;
+static uint8_t shim_opmode = STATION_MODE;
+static uint8_t shim_auto_connect = 1;
+static uint8_t shim_status = STATION_IDLE;
+static uint8_t shim_associated = 0;
+static enum dhcp_status shim_dhcpc = DHCP_STARTED;
+static enum dhcp_status shim_dhcps = DHCP_STOPPED;
+static uint32_t shim_wifi_generation = 0;
+
+void shim_wifi_ap(const char* ssid, const char* password, int8_t rssi) {
+	memset(shim_ap.ssid, 0, sizeof(shim_ap.ssid));
+	memset(shim_ap.password, 0, sizeof(shim_ap.password));
+	strncpy(shim_ap.ssid, ssid, sizeof(shim_ap.ssid));
+	strncpy(shim_ap.password, password, sizeof(shim_ap.password));
+	shim_ap.rssi = rssi;
+}
+
+void shim_wifi_ip(const char* ip, const char* gw) {
+	shim_dhcp_ip.addr = inet_addr(ip);
+	shim_dhcp_gw.addr = inet_addr(gw);
+}
+
+void shim_wifi_wps(int status, uint32_t after_ms) {
+	shim_wps_status = status;
+	shim_wps_after_ms = after_ms;
+}
+
+static uint32_t shim_wifi_tag(void) {
+	return (shim_wifi_generation << 8) | SHIM_WIFI_TAG;
+}
+
+static void shim_wifi_event(System_Event_t* event) {
+	if (shim_event_cb) {
+		shim_event_cb(event);
+	}
+}
+
+static void shim_got_ip_cb(void* arg, uint8_t* data, uint16_t len) {
+	System_Event_t event;
+	if (shim_dhcpc == DHCP_STARTED) {
+		if (!shim_dhcp_ip.addr) {
+			shim_wifi_ip("192.168.1.50", "192.168.1.1");
+		}
+		shim_sta_info.ip = shim_dhcp_ip;
+		shim_sta_info.gw = shim_dhcp_gw;
+		shim_sta_info.netmask.addr = inet_addr("255.255.255.0");
+		espconn_dns_setserver(0, &shim_dhcp_gw);
+	} else {
+		shim_sta_info = shim_static_info;
+	}
+	shim_status = STATION_GOT_IP;
+	memset(&event, 0, sizeof(event));
+	event.event = EVENT_STAMODE_GOT_IP;
+	event.event_info.got_ip.ip = shim_sta_info.ip;
+	event.event_info.got_ip.mask = shim_sta_info.netmask;
+	event.event_info.got_ip.gw = shim_sta_info.gw;
+	shim_wifi_event(&event);
+}
+
+static void shim_disconnected_cb(void* arg, uint8_t* data, uint16_t len) {
+	System_Event_t event;
+	memset(&event, 0, sizeof(event));
+	event.event = EVENT_STAMODE_DISCONNECTED;
+	memcpy(event.event_info.disconnected.ssid, shim_station.ssid, sizeof(event.event_info.disconnected.ssid));
+	event.event_info.disconnected.ssid_len = strnlen((char*)shim_station.ssid, sizeof(shim_station.ssid));
+	event.event_info.disconnected.reason = data[0];
+	shim_wifi_event(&event);
+}
+
+static void shim_assoc_cb(void* arg, uint8_t* data, uint16_t len) {
+	System_Event_t event;
+	uint8_t reason = 0;
+	if (strncmp((char*)shim_station.ssid, shim_ap.ssid, sizeof(shim_station.ssid)) ||
+		(shim_station.bssid_set && memcmp(shim_station.bssid, shim_ap.bssid, sizeof(shim_ap.bssid)))) {
+		shim_status = STATION_NO_AP_FOUND;
+		reason = REASON_NO_AP_FOUND;
+	} else if (strncmp((char*)shim_station.password, shim_ap.password, sizeof(shim_station.password))) {
+		shim_status = STATION_WRONG_PASSWORD;
+		reason = REASON_AUTH_FAIL;
+	}
+	if (reason) {
+		shim_disconnected_cb(NULL, &reason, 1);
+		return;
+	}
+	shim_associated = 1;
+	memset(&event, 0, sizeof(event));
+	event.event = EVENT_STAMODE_CONNECTED;
+	memcpy(event.event_info.connected.ssid, shim_station.ssid, sizeof(event.event_info.connected.ssid));
+	event.event_info.connected.ssid_len = strnlen((char*)shim_station.ssid, sizeof(shim_station.ssid));
+	memcpy(event.event_info.connected.bssid, shim_ap.bssid, sizeof(shim_ap.bssid));
+	event.event_info.connected.channel = SHIM_WIFI_CHANNEL;
+	shim_call((shim_dhcpc == DHCP_STARTED) ? shim_delays()->dhcp : 0, shim_got_ip_cb, NULL, shim_wifi_tag(), NULL, 0);
+	shim_wifi_event(&event);
+}
+
+bool wifi_station_connect(void) {
+	if (!(shim_opmode & STATION_MODE)) {
+		return false;
+	}
+	shim_cancel(shim_wifi_tag());
+	shim_wifi_generation++;
+	shim_associated = 0;
+	shim_status = STATION_CONNECTING;
+	memset(&shim_sta_info, 0, sizeof(shim_sta_info));
+	shim_call(shim_delays()->assoc, shim_assoc_cb, NULL, shim_wifi_tag(), NULL, 0);
+	return true;
+}
+
+bool wifi_station_disconnect(void) {
+	uint8_t reason = 8;
+	uint8_t associated = shim_associated;
+	shim_cancel(shim_wifi_tag());
+	shim_wifi_generation++;
+	shim_associated = 0;
+	shim_status = STATION_IDLE;
+	memset(&shim_sta_info, 0, sizeof(shim_sta_info));
+	/*leaving the access point is reported like any other loss*/
+	if (associated) {
+		shim_call(0, shim_disconnected_cb, NULL, shim_wifi_tag(), &reason, 1);
+	}
+	return true;
+}
+
+uint8 wifi_station_get_connect_status(void) {
+	return shim_status;
+}
+
+void wifi_set_event_handler_cb(wifi_event_handler_cb_t cb) {
+	shim_event_cb = cb;
+}
+
+uint8 wifi_get_opmode(void) {
+	return shim_opmode;
+}
+
+bool wifi_set_opmode(uint8 opmode) {
+	return wifi_set_opmode_current(opmode);
+}
+
+bool wifi_set_opmode_current(uint8 opmode) {
+	if (opmode > STATIONAP_MODE) {
+		return false;
+	}
+	if (!(opmode & STATION_MODE)) {
+		wifi_station_disconnect();
+	}
+	shim_opmode = opmode;
+	return true;
+}
+
+bool wifi_station_get_config(struct station_config* config) {
+	if (!config) {
+		return false;
+	}
+	*config = shim_station;
+	return true;
+}
+
+bool wifi_station_set_config(struct station_config* config) {
+	if (!config) {
+		return false;
+	}
+	shim_station = *config;
+	return true;
+}
+
+bool wifi_station_dhcpc_start(void) {
+	shim_dhcpc = DHCP_STARTED;
+	return true;
+}
+
+bool wifi_station_dhcpc_stop(void) {
+	shim_dhcpc = DHCP_STOPPED;
+	return true;
+}
+
+enum dhcp_status wifi_station_dhcpc_status(void) {
+	return shim_dhcpc;
+}
+
+bool wifi_station_set_hostname(char* name) {
+	return name != NULL;
+}
+
+uint8 wifi_station_get_auto_connect(void) {
+	return shim_auto_connect;
+}
+
+bool wifi_station_set_auto_connect(uint8 set) {
+	shim_auto_connect = set ? 1 : 0;
+	return true;
+}
+
+bool wifi_station_set_reconnect_policy(bool set) {
+	return true;
+}
+
+sint8 wifi_station_get_rssi(void) {
+	return (shim_status == STATION_GOT_IP) ? shim_ap.rssi : SHIM_WIFI_NO_RSSI;
+}
+
+static void shim_scan_cb(void* arg, uint8_t* data, uint16_t len) {
+	scan_done_cb_t cb;
+	uint8_t found;
+	memcpy(&cb, data, sizeof(cb));
+	found = data[sizeof(cb)];
+	cb(found ? &shim_bss : NULL, OK);
+}
+
+bool wifi_station_scan(struct scan_config* config, scan_done_cb_t cb) {
+	uint8_t data[sizeof(cb) + 1];
+	if (!cb || !(shim_opmode & STATION_MODE)) {
+		return false;
+	}
+	memset(&shim_bss, 0, sizeof(shim_bss));
+	memcpy(shim_bss.bssid, shim_ap.bssid, sizeof(shim_bss.bssid));
+	memcpy(shim_bss.ssid, shim_ap.ssid, sizeof(shim_bss.ssid));
+	shim_bss.ssid_len = strnlen(shim_ap.ssid, sizeof(shim_ap.ssid));
+	shim_bss.channel = SHIM_WIFI_CHANNEL;
+	shim_bss.rssi = shim_ap.rssi;
+	shim_bss.authmode = AUTH_WPA2_PSK;
+	memcpy(data, &cb, sizeof(cb));
+	data[sizeof(cb)] = (!config || !config->ssid || !strncmp((char*)config->ssid, shim_ap.ssid, sizeof(shim_ap.ssid))) ? 1 : 0;
+	shim_call(shim_delays()->scan, shim_scan_cb, NULL, SHIM_SCAN_TAG, data, sizeof(data));
+	return true;
+}
+
+bool wifi_get_ip_info(uint8 if_index, struct ip_info* info) {
+	if (!info || (if_index > SOFTAP_IF)) {
+		return false;
+	}
+	*info = (if_index == STATION_IF) ? shim_sta_info : shim_ap_info;
+	return true;
+}
+
+bool wifi_set_ip_info(uint8 if_index, struct ip_info* info) {
+	if (!info || (if_index > SOFTAP_IF)) {
+		return false;
+	}
+	if (if_index == STATION_IF) {
+		if (shim_dhcpc == DHCP_STARTED) {
+			return false;
+		}
+		shim_static_info = *info;
+	} else {
+		shim_ap_info = *info;
+	}
+	return true;
+}
+
+bool wifi_get_macaddr(uint8 if_index, uint8* macaddr) {
+	if (!macaddr) {
+		return false;
+	}
+	memcpy(macaddr, shim_mac, sizeof(shim_mac));
+	if (if_index == SOFTAP_IF) {
+		macaddr[0] |= 0x02;
+	}
+	return true;
+}
+
+bool wifi_softap_set_config_current(struct softap_config* config) {
+	return (config != NULL) && (shim_opmode & SOFTAP_MODE);
+}
+
+bool wifi_softap_dhcps_start(void) {
+	shim_dhcps = DHCP_STARTED;
+	return true;
+}
+
+bool wifi_softap_dhcps_stop(void) {
+	shim_dhcps = DHCP_STOPPED;
+	return true;
+}
+
+enum dhcp_status wifi_softap_dhcps_status(void) {
+	return shim_dhcps;
+}
+
+static void shim_wps_done_cb(void* arg, uint8_t* data, uint16_t len) {
+	if (shim_wps_status == WPS_CB_ST_SUCCESS) {
+		memset(&shim_station, 0, sizeof(shim_station));
+		memcpy(shim_station.ssid, shim_ap.ssid, sizeof(shim_station.ssid));
+		memcpy(shim_station.password, shim_ap.password, sizeof(shim_station.password));
+	}
+	if (shim_wps_cb) {
+		shim_wps_cb(shim_wps_status);
+	}
+}
+
+bool wifi_wps_enable(WPS_TYPE_t wps_type) {
+	return wps_type == WPS_TYPE_PBC;
+}
+
+bool wifi_wps_disable(void) {
+	shim_cancel(SHIM_WPS_TAG);
+	return true;
+}
+
+bool wifi_set_wps_cb(wps_st_cb_t cb) {
+	shim_wps_cb = cb;
+	return true;
+}
+
+bool wifi_wps_start(void) {
+	shim_call(shim_wps_after_ms * 1000, shim_wps_done_cb, NULL, SHIM_WPS_TAG, NULL, 0);
+	return true;
+}
+
+static void shim_ping_cb(void* arg, uint8_t* data, uint16_t len) {
+	struct ping_option* opt = arg;
+	memset(&shim_ping_resp, 0, sizeof(shim_ping_resp));
+	shim_ping_resp.total_count = 1;
+	shim_ping_resp.ping_err = data[0] ? 0 : -1;
+	shim_ping_resp.resp_time = shim_delays()->ping / 1000;
+	if (opt->recv_function) {
+		opt->recv_function(opt, &shim_ping_resp);
+	}
+}
+
+/*only the gateway answers*/
+bool ping_start(struct ping_option* ping_opt) {
+	uint8_t answer;
+	if (!ping_opt || (shim_status != STATION_GOT_IP)) {
+		return false;
+	}
+	answer = (ping_opt->ip == shim_sta_info.gw.addr) ? 1 : 0;
+	shim_call(answer ? shim_delays()->ping : SHIM_PING_TIMEOUT_US, shim_ping_cb, ping_opt, SHIM_PING_TAG, &answer, 1);
+	return true;
+}
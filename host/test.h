@@ -0,0 +1,38 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Minimal checks for the host tests
+
+#ifndef TEST_H_INCLUDED
+#define TEST_H_INCLUDED 1
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond)															\
+	do {																	\
+		if (!(cond)) {														\
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);	\
+			test_failures++;												\
+		}																	\
+	} while (0)
+
+#define TEST_DONE(name)														\
+	do {																	\
+		printf("%s: %s\n", name, test_failures ? "FAIL" : "OK");			\
+		return test_failures ? 1 : 0;										\
+	} while (0)
+
+#endif
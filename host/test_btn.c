@@ -0,0 +1,149 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// peri_btn gesture classifier fed with recorded button traces, the clock
+// runs every ms like peri_clk and edges are debounced levels in us. then
+// one press through the real GPIO interrupt and button clock of peri
+
+#include <string.h>
+#include <user_interface.h>
+#include <gpio.h>
+#include <ets_sys.h>
+#include "peri_btn.h"
+#include "shim.h"
+#include "test.h"
+
+#define TEST_BTN_ACTIONS 16
+#define TEST_BTN_MS 1000
+
+typedef struct {
+	uint8_t level;
+	uint32_t ms;
+} Test_Btn_Edge_T;
+
+typedef struct {
+	const char* name;
+	Test_Btn_Edge_T edges[8];
+	uint32_t end_ms;
+	Btn_Action_T actions[TEST_BTN_ACTIONS];
+} Test_Btn_Trace_T;
+
+static const Test_Btn_Trace_T test_traces[] = {
+	{"short", {{0, 100}, {1, 250}}, 2000,
+		{BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_SHORT}},
+	{"double", {{0, 100}, {1, 250}, {0, 450}, {1, 600}}, 2000,
+		{BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_DOUBLE}},
+	/*second press after the short window are two shorts*/
+	{"two short", {{0, 100}, {1, 250}, {0, 700}, {1, 850}}, 2000,
+		{BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_SHORT,
+		BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_SHORT}},
+	/*short then a held second press is a short and a long*/
+	{"short long", {{0, 100}, {1, 250}, {0, 450}, {1, 2000}}, 3000,
+		{BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_PRESS,
+		BTN_ACTION_LONG, BTN_ACTION_SHORT, BTN_ACTION_RELEASE}},
+	{"long", {{0, 100}, {1, 1600}}, 3000,
+		{BTN_ACTION_PRESS, BTN_ACTION_LONG, BTN_ACTION_RELEASE}},
+	{"service", {{0, 100}, {1, 6100}}, 7000,
+		{BTN_ACTION_PRESS, BTN_ACTION_LONG, BTN_ACTION_RELEASE, BTN_ACTION_SERVICE}},
+	/*held past the service window is neither service nor reset*/
+	{"past service", {{0, 100}, {1, 8000}}, 9000,
+		{BTN_ACTION_PRESS, BTN_ACTION_LONG, BTN_ACTION_RELEASE}},
+	{"reset", {{0, 100}, {1, 11000}}, 12000,
+		{BTN_ACTION_PRESS, BTN_ACTION_LONG, BTN_ACTION_RESET, BTN_ACTION_RELEASE}},
+	/*repeated levels are not edges*/
+	{"repeat level", {{1, 50}, {0, 100}, {0, 150}, {1, 250}, {1, 260}}, 2000,
+		{BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_SHORT}},
+};
+
+static Btn_Action_T test_actions[TEST_BTN_ACTIONS];
+static uint8_t test_count;
+
+static void test_btn_action(Btn_Action_T action) {
+	if (test_count < TEST_BTN_ACTIONS) {
+		test_actions[test_count] = action;
+	}
+	test_count++;
+}
+
+/*start shifts the trace so the us clock wraps in the middle of it*/
+static void test_btn_trace(const Test_Btn_Trace_T* trace, uint32_t start) {
+	Peri_Btn_T btn;
+	uint32_t ms;
+	uint8_t edge = 0;
+	uint8_t expected = 0;
+	uint8_t i;
+	test_count = 0;
+	peri_btn_init(&btn, test_btn_action);
+	for (ms = 0; ms <= trace->end_ms; ms++) {
+		while ((edge < 8) && trace->edges[edge].ms && (trace->edges[edge].ms == ms)) {
+			peri_btn_gesture(&btn, trace->edges[edge].level, start + ms * TEST_BTN_MS);
+			edge++;
+		}
+		if (peri_btn_pending(&btn)) {
+			peri_btn_timeout(&btn, start + ms * TEST_BTN_MS);
+		}
+	}
+	while ((expected < TEST_BTN_ACTIONS) && trace->actions[expected]) {
+		expected++;
+	}
+	if (test_count != expected) {
+		printf("%s: %u actions, expected %u\n", trace->name, test_count, expected);
+	}
+	CHECK(test_count == expected);
+	for (i = 0; (i < expected) && (i < test_count); i++) {
+		if (test_actions[i] != trace->actions[i]) {
+			printf("%s: action %u is %u, expected %u\n", trace->name, i, test_actions[i], trace->actions[i]);
+		}
+		CHECK(test_actions[i] == trace->actions[i]);
+	}
+	CHECK(!peri_btn_pending(&btn));
+}
+
+/*the button isr leaves the status bit of another pending pin alone*/
+static void test_btn_peri(void) {
+	static const Btn_Action_T expected[] = {BTN_ACTION_PRESS, BTN_ACTION_RELEASE, BTN_ACTION_SHORT};
+	uint8_t i;
+	shim_boot(REASON_DEFAULT_RST);
+	test_count = 0;
+	peri_set_btn_cb(test_btn_action);
+	CHECK(peri_init());
+	gpio_pin_intr_state_set(GPIO_ID_PIN(0), GPIO_PIN_INTR_NEGEDGE);
+	shim_gpio_input(0, 0);
+	shim_run_for(10000);
+	shim_gpio_input(BTN_GPIO, 0);
+	/*contact bounce inside the debounce period*/
+	shim_run_for(1000);
+	shim_gpio_input(BTN_GPIO, 1);
+	shim_run_for(1000);
+	shim_gpio_input(BTN_GPIO, 0);
+	shim_run_for(150000);
+	shim_gpio_input(BTN_GPIO, 1);
+	shim_run_for(1000000);
+	CHECK(GPIO_REG_READ(GPIO_STATUS_ADDRESS) & BIT(0));
+	CHECK(!(GPIO_REG_READ(GPIO_STATUS_ADDRESS) & BIT(BTN_GPIO)));
+	CHECK(test_count == sizeof(expected) / sizeof(expected[0]));
+	for (i = 0; (i < test_count) && (i < sizeof(expected) / sizeof(expected[0])); i++) {
+		CHECK(test_actions[i] == expected[i]);
+	}
+	peri_deinit();
+}
+
+int main(void) {
+	uint8_t i;
+	for (i = 0; i < sizeof(test_traces) / sizeof(test_traces[0]); i++) {
+		test_btn_trace(&test_traces[i], 0);
+		test_btn_trace(&test_traces[i], 0xFFFFFFFF - 3000000);
+	}
+	test_btn_peri();
+	TEST_DONE("btn");
+}
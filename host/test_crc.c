@@ -0,0 +1,115 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// CRC results must not change, stores and URL sectors in the field depend on them
+
+#include <string.h>
+#include <stdlib.h>
+#include "crc.h"
+#include "crc_bitwise.h"
+#include "test.h"
+
+#define STORE_CRC_POLY 0x1EDC6F41
+#define URL_CRC_POLY 0x741B8CD7
+/*no table, crc_init leaves it on the bitwise division*/
+#define PLAIN_CRC_POLY 0x04C11DB7
+#define CRC_STREAMS 200
+#define CRC_STREAM_MAX 512
+
+typedef struct {
+	uint64_t poly;
+	uint32_t bytes;
+	uint32_t words;
+	uint32_t block;
+	uint32_t block_init;
+} Crc_Golden_T;
+
+/*from the bitwise implementation the tables replaced*/
+static const Crc_Golden_T golden[] = {
+	{STORE_CRC_POLY, 0x00D64CAA, 0x0D644005, 0x02C82897, 0x00FC7EEF},
+	{URL_CRC_POLY, 0x2FEF5A7D, 0x33108CB1, 0x37E9AD54, 0x25DDFB2C},
+};
+
+/*random streams of bytes, words and values of any width up to 32 bits*/
+static void test_crc_streams(uint64_t poly) {
+	uint32_t words[CRC_STREAM_MAX / sizeof(uint32_t)];
+	uint8_t bytes[CRC_STREAM_MAX];
+	uint64_t init;
+	uint32_t value;
+	Crc_T crc;
+	Crc_T ref;
+	uint16_t len;
+	uint16_t n;
+	uint16_t i;
+	for (n = 0; n < CRC_STREAMS; n++) {
+		len = 1 + rand() % CRC_STREAM_MAX;
+		for (i = 0; i < len; i++) {
+			bytes[i] = rand();
+		}
+		/*every tenth init is too wide for the tables*/
+		init = (n % 10) ? (uint64_t)rand() : ((uint64_t)rand() << 32);
+		crc_init(&crc, poly, init);
+		crc_init(&ref, poly, init);
+		CHECK(crc_check(&crc, bytes, len) == crc_bitwise_check(&ref, bytes, len));
+		memcpy(words, bytes, len & ~3);
+		crc_init(&crc, poly, init);
+		crc_init(&ref, poly, init);
+		CHECK(crc_check_words(&crc, words, len / 4) == crc_bitwise_check_words(&ref, words, len / 4));
+		crc_init(&crc, poly, init);
+		crc_init(&ref, poly, init);
+		for (i = 0; i < len / 4; i++) {
+			value = words[i] >> (rand() % 32);
+			CHECK(crc_calculate(&crc, value) == crc_bitwise_calculate(&ref, value));
+		}
+	}
+}
+
+int main(void) {
+	static const uint32_t words[] = {0x01020304, 0xDEADBEEF, 0x00000000, 0xFFFFFFFF};
+	uint8_t block[1000];
+	Crc_T crc;
+	uint16_t i;
+	uint8_t k;
+	for (i = 0; i < sizeof(block); i++) {
+		block[i] = i * 7 + 3;
+	}
+	for (k = 0; k < sizeof(golden) / sizeof(golden[0]); k++) {
+		crc_init(&crc, golden[k].poly, 0);
+		CHECK((crc_bitwise_check(&crc, (const uint8_t*)"123456789", 9) & 0xFFFFFFFF) == golden[k].bytes);
+		crc_init(&crc, golden[k].poly, 0);
+		CHECK((crc_bitwise_check(&crc, block, sizeof(block)) & 0xFFFFFFFF) == golden[k].block);
+		crc_init(&crc, golden[k].poly, 0);
+		CHECK((crc_check(&crc, (const uint8_t*)"123456789", 9) & 0xFFFFFFFF) == golden[k].bytes);
+		crc_init(&crc, golden[k].poly, 0);
+		for (i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+			crc_calculate(&crc, words[i]);
+		}
+		CHECK((crc_last(&crc) & 0xFFFFFFFF) == golden[k].words);
+		crc_init(&crc, golden[k].poly, 0);
+		crc_check_words(&crc, words, sizeof(words) / sizeof(words[0]));
+		CHECK((crc_last(&crc) & 0xFFFFFFFF) == golden[k].words);
+		crc_init(&crc, golden[k].poly, 0);
+		CHECK((crc_check(&crc, block, sizeof(block)) & 0xFFFFFFFF) == golden[k].block);
+		crc_init(&crc, golden[k].poly, 0x12345678);
+		CHECK((crc_check(&crc, block, sizeof(block)) & 0xFFFFFFFF) == golden[k].block_init);
+		/*reset starts over from the init value*/
+		crc_reset(&crc);
+		CHECK((crc_check(&crc, block, sizeof(block)) & 0xFFFFFFFF) == golden[k].block_init);
+	}
+	srand(1);
+	test_crc_streams(STORE_CRC_POLY);
+	test_crc_streams(URL_CRC_POLY);
+	test_crc_streams(PLAIN_CRC_POLY);
+	TEST_DONE("crc");
+}
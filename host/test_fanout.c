@@ -0,0 +1,93 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// One gesture with three targets of different latency: with parallel slots the
+// gesture completes with the slowest target, one slot pays for all of them
+
+#include <stdio.h>
+#include <string.h>
+#include <user_interface.h>
+#include "ns.h"
+#include "sleep.h"
+#include "server.h"
+#include "shim.h"
+#include "test.h"
+
+#define TEST_FANOUT_TARGETS 3
+
+static const uint32_t test_fanout_ms[TEST_FANOUT_TARGETS] = {100, 300, 500};
+static uint8_t done;
+static uint8_t errors;
+static uint64_t last_us;
+
+static uint8_t test_fanout_recv(void* owner, uint8_t* data, uint32_t len) {
+	return 0;
+}
+
+static void test_fanout_done(void* owner, uint8_t error) {
+	done++;
+	errors += error ? 1 : 0;
+	last_us = shim_now();
+}
+
+/*virtual ms from the press to the last target answered*/
+static uint32_t test_fanout_run(uint8_t slots) {
+	Server_T server[TEST_FANOUT_TARGETS];
+	char url[256];
+	uint16_t len = 0;
+	uint64_t start;
+	Ns_T ns;
+	uint8_t i;
+	shim_boot(REASON_DEFAULT_RST);
+	/*no deep sleep in the middle of the test*/
+	sleep_lock(SLEEP_DELAY);
+	for (i = 0; i < TEST_FANOUT_TARGETS; i++) {
+		server[i] = server_new("{}");
+		shim_port_delay(server_port(server[i]), test_fanout_ms[i] * 1000);
+		len += sprintf(url + len, "%sget://127.0.0.1:%u/target%u", i ? "||" : "", server_port(server[i]), i);
+	}
+	ns = ns_new();
+	ns_slots(ns, slots);
+	ns_connect(ns, 1);
+	done = 0;
+	errors = 0;
+	start = shim_now();
+	CHECK(ns_multi_query(ns, url, NULL, NULL, test_fanout_recv, test_fanout_done) == TEST_FANOUT_TARGETS);
+	shim_run_for(5000000);
+	CHECK((done == TEST_FANOUT_TARGETS) && !errors);
+	ns_delete(ns);
+	for (i = 0; i < TEST_FANOUT_TARGETS; i++) {
+		shim_port_delay(server_port(server[i]), 0);
+		server_delete(server[i]);
+	}
+	return (last_us - start) / 1000;
+}
+
+int main(void) {
+	uint32_t slowest = test_fanout_ms[TEST_FANOUT_TARGETS - 1];
+	uint32_t sum = 0;
+	uint32_t parallel;
+	uint32_t serial;
+	uint8_t i;
+	for (i = 0; i < TEST_FANOUT_TARGETS; i++) {
+		sum += test_fanout_ms[i];
+	}
+	serial = test_fanout_run(1);
+	parallel = test_fanout_run(TEST_FANOUT_TARGETS);
+	printf("fanout: 1 slot %u ms, %u slots %u ms, slowest %u ms, sum %u ms\n", serial, TEST_FANOUT_TARGETS, parallel,
+		slowest, sum);
+	/*within 10% of the slowest target, the sum only in series*/
+	CHECK((parallel >= slowest) && (parallel <= slowest + slowest / 10));
+	CHECK(serial >= sum);
+	TEST_DONE("fanout");
+}
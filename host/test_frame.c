@@ -0,0 +1,180 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// payload_frame_feed split at every point: Content-Length and chunked responses,
+// a body larger than the arena and malformed ones must come out the same as
+// when the whole response arrives in one segment
+
+#include <stdio.h>
+#include <string.h>
+#include "payload_frame.h"
+#include "test.h"
+
+#define TEST_FRAME_BODY "{ \"repeat\": 3,\r\n \"speed\": 2, \"r\": false, \"w\": false,\n\t\"g\": true, \"time\": \"2019-01-01T00:00:00Z\", \"s\": \"a \\\" b\" }"
+#define TEST_FRAME_COMPACT "{\"repeat\":3,\"speed\":2,\"r\":false,\"w\":false,\"g\":true,\"time\":\"2019-01-01T00:00:00Z\",\"s\":\"a \\\" b\"}"
+
+typedef struct {
+	uint8_t ok;
+	Payload_Frame_T frame;
+	char arena[PAYLOAD_FRAME_ARENA_SIZE];
+} Test_Frame_Result_T;
+
+static char big[4096];
+static char response[8192];
+static uint16_t splits;
+
+/*feeds the response cut at the given offsets, stops at the first error like payload_recv*/
+static void test_frame_feed(const char* data, uint32_t len, const uint32_t* cuts, uint8_t count, Test_Frame_Result_T* result) {
+	uint32_t from = 0;
+	uint32_t to;
+	uint8_t i;
+	memset(result, 0, sizeof(Test_Frame_Result_T));
+	payload_frame_init(&result->frame, result->arena);
+	result->ok = 1;
+	for (i = 0; i <= count; i++) {
+		to = (i < count) ? cuts[i] : len;
+		if ((to > from) && !payload_frame_feed(&result->frame, (uint8_t*)data + from, to - from)) {
+			result->ok = 0;
+			return;
+		}
+		from = to;
+	}
+}
+
+static uint8_t test_frame_same(const Test_Frame_Result_T* a, const Test_Frame_Result_T* b) {
+	if ((a->ok != b->ok) || (a->frame.state != b->frame.state)) {
+		return 0;
+	}
+	if (!a->ok || (a->frame.state != PAYLOAD_FRAME_DONE)) {
+		return 1;
+	}
+	return (a->frame.code == b->frame.code) && (a->frame.fill == b->frame.fill) &&
+		(a->frame.overflow == b->frame.overflow) && !memcmp(a->arena, b->arena, a->frame.fill);
+}
+
+/*every single split, every pair of splits when pairs is set, and one byte at a time*/
+static void test_frame_splits(const char* data, uint8_t pairs, const Test_Frame_Result_T* expected) {
+	static Test_Frame_Result_T result;
+	uint32_t len = strlen(data);
+	uint32_t cuts[2];
+	uint32_t i;
+	uint32_t j;
+	uint8_t bad = 0;
+	for (i = 1; i < len; i++) {
+		cuts[0] = i;
+		test_frame_feed(data, len, cuts, 1, &result);
+		bad |= !test_frame_same(&result, expected);
+		splits++;
+		for (j = i + 1; pairs && (j < len); j++) {
+			cuts[1] = j;
+			test_frame_feed(data, len, cuts, 2, &result);
+			bad |= !test_frame_same(&result, expected);
+			splits++;
+		}
+	}
+	memset(&result, 0, sizeof(result));
+	payload_frame_init(&result.frame, result.arena);
+	result.ok = 1;
+	for (i = 0; (i < len) && result.ok; i++) {
+		result.ok = payload_frame_feed(&result.frame, (uint8_t*)data + i, 1);
+	}
+	bad |= !test_frame_same(&result, expected);
+	CHECK(!bad);
+}
+
+static void test_frame_whole(const char* data, Test_Frame_Result_T* result) {
+	test_frame_feed(data, strlen(data), NULL, 0, result);
+}
+
+static uint16_t test_frame_chunked(const char* body, const uint16_t* sizes) {
+	uint16_t len = sprintf(response, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n");
+	uint16_t left = strlen(body);
+	uint16_t size;
+	uint8_t i;
+	for (i = 0; left; i++) {
+		size = (sizes[i] && (sizes[i] < left)) ? sizes[i] : left;
+		len += sprintf(response + len, (i & 1) ? "%X;name=value\r\n" : "%x\r\n", size);
+		memcpy(response + len, body, size);
+		len += size;
+		len += sprintf(response + len, "\r\n");
+		body += size;
+		left -= size;
+	}
+	len += sprintf(response + len, "0\r\n\r\n");
+	return len;
+}
+
+int main(void) {
+	static const uint16_t sizes[] = {7, 1, 30, 2, 0};
+	static const uint16_t big_sizes[] = {100, 1000, 0};
+	Test_Frame_Result_T expected;
+	uint32_t i;
+
+	sprintf(response, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n%s",
+		(unsigned)strlen(TEST_FRAME_BODY), TEST_FRAME_BODY);
+	test_frame_whole(response, &expected);
+	CHECK(expected.ok && (expected.frame.state == PAYLOAD_FRAME_DONE) && (expected.frame.code == 200));
+	CHECK((expected.frame.fill == strlen(TEST_FRAME_COMPACT)) && !memcmp(expected.arena, TEST_FRAME_COMPACT, expected.frame.fill));
+	CHECK(!expected.frame.overflow);
+	test_frame_splits(response, 1, &expected);
+
+	test_frame_chunked(TEST_FRAME_BODY, sizes);
+	test_frame_whole(response, &expected);
+	CHECK(expected.ok && (expected.frame.state == PAYLOAD_FRAME_DONE));
+	CHECK((expected.frame.fill == strlen(TEST_FRAME_COMPACT)) && !memcmp(expected.arena, TEST_FRAME_COMPACT, expected.frame.fill));
+	test_frame_splits(response, 1, &expected);
+
+	/*longer than the arena, the end is dropped and flagged*/
+	for (i = 0; i < (sizeof(big) - 1); i++) {
+		big[i] = 'a' + (i % 26);
+	}
+	sprintf(response, "HTTP/1.1 200 OK\r\nContent-Length: %u\r\n\r\n%s", (unsigned)strlen(big), big);
+	test_frame_whole(response, &expected);
+	CHECK(expected.ok && (expected.frame.state == PAYLOAD_FRAME_DONE) && expected.frame.overflow);
+	CHECK((expected.frame.fill == (PAYLOAD_FRAME_ARENA_SIZE - 1)) && !memcmp(expected.arena, big, expected.frame.fill));
+	test_frame_splits(response, 0, &expected);
+	test_frame_chunked(big, big_sizes);
+	test_frame_whole(response, &expected);
+	CHECK(expected.ok && (expected.frame.state == PAYLOAD_FRAME_DONE) && expected.frame.overflow);
+	test_frame_splits(response, 0, &expected);
+
+	/*status and header lines longer than the arena are cut, not overrun*/
+	memset(big + PAYLOAD_FRAME_ARENA_SIZE * 2, 0, 1);
+	sprintf(response, "HTTP/1.1 404 Not Found\r\nX-Long: %s\r\nContent-Length: 2\r\n\r\n{}", big);
+	test_frame_whole(response, &expected);
+	CHECK(expected.ok && (expected.frame.state == PAYLOAD_FRAME_DONE) && (expected.frame.code == 404));
+	test_frame_splits(response, 0, &expected);
+
+	/*malformed and cut short, the split must not change the verdict*/
+	test_frame_whole("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n{}\r\n0\r\n\r\n", &expected);
+	CHECK(!expected.ok);
+	test_frame_splits("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n{}\r\n0\r\n\r\n", 1, &expected);
+	test_frame_whole("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n123456789\r\n", &expected);
+	CHECK(!expected.ok);
+	test_frame_splits("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n123456789\r\n", 1, &expected);
+	test_frame_whole("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n{}XX0\r\n\r\n", &expected);
+	CHECK(!expected.ok);
+	test_frame_splits("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n{}XX0\r\n\r\n", 1, &expected);
+	test_frame_whole("HTTP/1.1 200 OK\r\nContent-Length: 99\r\n\r\n{\"repeat\"", &expected);
+	CHECK(expected.ok && (expected.frame.state == PAYLOAD_FRAME_BODY));
+	test_frame_splits("HTTP/1.1 200 OK\r\nContent-Length: 99\r\n\r\n{\"repeat\"", 1, &expected);
+	test_frame_whole("HTTP/1.1 200 OK\r\nContent-Length: 70000\r\n\r\n{}", &expected);
+	CHECK(!expected.ok);
+	test_frame_whole("HTTP/1.1 999 Nope\r\n\r\n", &expected);
+	CHECK(!expected.ok);
+	test_frame_splits("HTTP/1.1 999 Nope\r\n\r\n", 1, &expected);
+
+	printf("frame: %u split feeds\n", splits);
+	TEST_DONE("frame");
+}
@@ -0,0 +1,220 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// json_measure and json_print_window against a full print, json_parse_values
+// against a corpus of valid and broken documents
+
+#include <string.h>
+#include <stdlib.h>
+#include "json.h"
+#include "buffer.h"
+#include "test.h"
+
+#define TEST_JSON_SIZE 1024
+#define TEST_JSON_DEEP 300
+
+enum {
+	TEST_ID,
+	TEST_NAME,
+	TEST_ON,
+	__TEST_MAX
+};
+
+static const Rule_T test_rule[] = {
+	[TEST_ID] = {
+		.name = "id",
+		.type = RULE_UNSIGNED_INT,
+		.required = 1,
+		.detail = {
+			.unsigned_int = {
+				.min_val = 0,
+				.max_val = 100
+			}
+		}
+	},
+	[TEST_NAME] = {
+		.name = "name",
+		.type = RULE_CHAR,
+		.min_len = 0,
+		.max_len = 32
+	},
+	[TEST_ON] = {
+		.name = "on",
+		.type = RULE_BOOLEAN
+	}
+};
+
+typedef struct {
+	const char* json;
+	uint8_t ok;
+	uint32_t id;
+	const char* name;
+} Test_Json_Case_T;
+
+static const Test_Json_Case_T test_corpus[] = {
+	{"{\"id\":7}", 1, 7, NULL},
+	{"  { \"id\" : 7 , \"name\" : \"a b\" }  ", 1, 7, "a b"},
+	{"{}", 0},
+	{"{\"name\":\"x\"}", 0},
+	/*escapes*/
+	{"{\"id\":1,\"name\":\"q\\\"x\\\\y\"}", 1, 1, "q\"x\\y"},
+	{"{\"id\":1,\"name\":\"\\n\\t\\u0041\"}", 1, 1, "\n\tA"},
+	{"{\"i\\u0064\":3}", 1, 3, NULL},
+	{"{\"id\":1,\"name\":\"\\u00\"}", 0},
+	{"{\"id\":1,\"name\":\"bad\\\"}", 0},
+	/*unknown and nested fields are skipped*/
+	{"{\"x\":{\"a\":[1,{\"b\":\"}]\"}]},\"id\":2}", 1, 2, NULL},
+	{"{\"x\":[[],{}],\"id\":2,\"y\":null}", 1, 2, NULL},
+	{"{\"id\":{\"a\":1}}", 0},
+	/*unbalanced or crossed brackets in a skipped field*/
+	{"{\"x\":{\"a\":1,\"id\":2}", 0},
+	{"{\"x\":[1,2},\"id\":2}", 0},
+	{"{\"x\":{\"a\":[1}],\"id\":2}", 0},
+	{"{\"x\":]1],\"id\":2}", 0},
+	/*truncated*/
+	{"{\"id\":2", 0},
+	{"{\"id\":", 0},
+	{"{\"id\"", 0},
+	{"{\"id", 0},
+	{"{", 0},
+	{"", 0},
+	{"{\"id\":2,\"name\":\"abc", 0},
+	{"{\"id\":2,", 0},
+	/*trailing garbage*/
+	{"{\"id\":2}x", 0},
+	{"{\"id\":2}}", 0},
+	{"{\"id\":2} {\"id\":3}", 0},
+	{"{\"id\":2 3}", 0},
+	{"{\"id\":2,,\"on\":1}", 0},
+	/*duplicate keys, the first one wins*/
+	{"{\"id\":4,\"id\":5}", 1, 4, NULL},
+	{"{\"id\":4,\"name\":\"a\",\"name\":\"b\"}", 1, 4, "a"},
+	/*rule violations*/
+	{"{\"id\":101}", 0},
+	{"{\"id\":\"x\"}", 0},
+	{"{\"id\":1,\"on\":true}", 1, 1, NULL},
+	{"{\"id\":1,\"on\":1}", 0},
+	{"{\"id\":1,\"name\":\"123456789012345678901234567890123\"}", 0},
+};
+
+static void test_json_corpus(void) {
+	char data[TEST_JSON_SIZE];
+	struct Value_T values[__TEST_MAX];
+	uint8_t ok;
+	uint16_t i;
+	for (i = 0; i < sizeof(test_corpus) / sizeof(test_corpus[0]); i++) {
+		strcpy(data, test_corpus[i].json);
+		ok = json_parse_values(data, test_rule, __TEST_MAX, values);
+		if (ok != test_corpus[i].ok) {
+			printf("corpus %u: %s\n", i, test_corpus[i].json);
+		}
+		CHECK(ok == test_corpus[i].ok);
+		if (!ok || !test_corpus[i].ok) {
+			continue;
+		}
+		CHECK(values[TEST_ID].uint_value == test_corpus[i].id);
+		CHECK(values[TEST_NAME].present == !!test_corpus[i].name);
+		if (test_corpus[i].name && values[TEST_NAME].present) {
+			CHECK(!strcmp(values[TEST_NAME].string_value, test_corpus[i].name));
+		}
+	}
+}
+
+/*opens nested levels in a skipped field, closes with close brackets*/
+static uint8_t test_json_deep(uint16_t open, uint16_t close, const char* tail) {
+	static char data[2 * TEST_JSON_DEEP + 64];
+	struct Value_T values[__TEST_MAX];
+	uint16_t len = 0;
+	uint16_t i;
+	len += sprintf(data, "{\"x\":");
+	for (i = 0; i < open; i++) {
+		data[len++] = '[';
+	}
+	for (i = 0; i < close; i++) {
+		data[len++] = ']';
+	}
+	strcpy(data + len, tail);
+	return json_parse_values(data, test_rule, __TEST_MAX, values);
+}
+
+static Json_T test_json_doc(void) {
+	Json_T json;
+	Json_T obj;
+	Json_T array;
+	json = json_new();
+	obj = json_new();
+	array = json_new();
+	json_set_format(array, 1, 0);
+	json_add_string(json, "name", "Button \"Plus\"\ttab\\");
+	json_add_int(json, "rssi", -67);
+	json_add_bool(json, "connected", 1);
+	json_add_null(json, "next");
+	json_add_ip(obj, "ip", 0x0A01A8C0);
+	json_add_real(obj, "voltage", 3.3);
+	json_add_string(obj, "mac", "5C:CF:7F:00:00:01");
+	json_add_obj(json, "wifi", obj);
+	json_add_int(array, NULL, 1);
+	json_add_int(array, NULL, 2);
+	json_add_string(array, NULL, "three");
+	json_add_array(json, "list", array);
+	return json;
+}
+
+int main(void) {
+	static uint8_t full_storage[TEST_JSON_SIZE];
+	static uint8_t joined[TEST_JSON_SIZE];
+	uint8_t window_storage[32];
+	struct Buffer_T full;
+	struct Buffer_T window;
+	uint16_t size;
+	uint16_t offset;
+	uint16_t len;
+	uint16_t part;
+	Json_T json;
+	json = test_json_doc();
+	buffer_init(&full, sizeof(full_storage), full_storage);
+	size = json_print(json, &full, 0);
+	CHECK(size > 0);
+	CHECK(!buffer_overflow(&full));
+	CHECK(json_measure(json) == size);
+	/*windows of every size reassemble to the full print*/
+	for (part = 1; part <= sizeof(window_storage); part++) {
+		memset(joined, 0, sizeof(joined));
+		offset = 0;
+		while (offset < size) {
+			buffer_init(&window, part, window_storage);
+			if (!(len = json_print_window(json, &window, offset))) {
+				break;
+			}
+			CHECK(len <= part);
+			memcpy(joined + offset, window_storage, len);
+			offset += len;
+		}
+		CHECK(offset == size);
+		CHECK(!memcmp(joined, full_storage, size));
+	}
+	/*window past the end is empty*/
+	buffer_init(&window, sizeof(window_storage), window_storage);
+	CHECK(json_print_window(json, &window, size) == 0);
+	json_delete(json);
+	test_json_corpus();
+	/*nesting up to the limit is skipped, deeper documents are rejected*/
+	CHECK(test_json_deep(JSON_NEST_MAX, JSON_NEST_MAX, ",\"id\":1}"));
+	CHECK(!test_json_deep(JSON_NEST_MAX + 1, JSON_NEST_MAX + 1, ",\"id\":1}"));
+	CHECK(!test_json_deep(TEST_JSON_DEEP, TEST_JSON_DEEP, ",\"id\":1}"));
+	/*a level count wrapping at 256 would close after the second bracket*/
+	CHECK(!test_json_deep(257, 1, ",\"id\":1}"));
+	CHECK(!test_json_deep(256, 0, "[],\"id\":1}"));
+	TEST_DONE("json");
+}
@@ -0,0 +1,95 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Events queued behind a request in flight: wheel deltas always fold into the
+// latest queued wheel event, generic actions merge only for URL types enabled
+// in store.merge_types
+
+#include <stdio.h>
+#include <string.h>
+#include <user_interface.h>
+#include "user_config.h"
+#include "payload.h"
+#include "store.h"
+#include "url_storage.h"
+#include "action_plan.h"
+#include "sleep.h"
+#include "server.h"
+#include "shim.h"
+#include "test.h"
+
+extern struct Store_T store;
+extern Url_Storage_T url_storage;
+extern Action_Plan_T action_plan;
+
+static uint8_t test_payload_count(const char* str, const char* key) {
+	uint8_t count = 0;
+	while ((str = strstr(str, key))) {
+		count++;
+		str += strlen(key);
+	}
+	return count;
+}
+
+/*one press, then more while it is in flight*/
+static Server_Stats_T test_payload_burst(uint8_t merge, Btn_Action_T action, uint16_t value, uint8_t more) {
+	Server_T server = server_new("{}");
+	Server_Stats_T stats;
+	Payload_T payload;
+	char url[64];
+	uint8_t i;
+	shim_flash_erase();
+	shim_rtc_clear();
+	shim_boot(REASON_DEFAULT_RST);
+	sleep_lock(SLEEP_DELAY);
+	store_init();
+	store.merge_types = merge;
+	url_storage_init(&url_storage, URL_STORAGE_SECTOR);
+	sprintf(url, "get://127.0.0.1:%u/generic", server_port(server));
+	CHECK(url_storage_write(&url_storage, URL_TYPE_GENERIC, url));
+	action_plan_init(&action_plan, ACTION_PLAN_SECTOR);
+	CHECK(action_plan_update(&action_plan, &url_storage));
+	CHECK((payload = payload_new()));
+	payload_connect(payload, 1);
+	payload_action(payload, "5CCF7F000001", BTN_ACTION_SHORT, 0);
+	for (i = 0; i < more; i++) {
+		payload_action(payload, "5CCF7F000001", action, value);
+	}
+	shim_run_for(5000000);
+	CHECK(!payload_pending(payload));
+	stats = server_stats(server);
+	server_delete(server);
+	return stats;
+}
+
+int main(void) {
+	Server_Stats_T stats;
+	/*off by default, every press is its own request*/
+	stats = test_payload_burst(0, BTN_ACTION_DOUBLE, 0, 2);
+	CHECK(stats.requests == 3);
+	CHECK(test_payload_count(stats.last, "action=") == 1);
+	/*on for the generic type, the queued presses go as one*/
+	stats = test_payload_burst(1 << URL_TYPE_GENERIC, BTN_ACTION_DOUBLE, 0, 2);
+	CHECK(stats.requests == 2);
+	CHECK(test_payload_count(stats.last, "action=2") == 2);
+	CHECK(test_payload_count(stats.last, "mac=") == 1);
+	CHECK(test_payload_count(stats.last, "battery=") == 1);
+	/*other types do not turn it on*/
+	stats = test_payload_burst(1 << URL_TYPE_SINGLE, BTN_ACTION_DOUBLE, 0, 2);
+	CHECK(stats.requests == 3);
+	/*wheel deltas add up with merging off*/
+	stats = test_payload_burst(0, BTN_ACTION_WHEEL, 5, 3);
+	CHECK(stats.requests == 2);
+	CHECK(strstr(stats.last, "wheel=15") != NULL);
+	TEST_DONE("test payload");
+}
@@ -0,0 +1,86 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Kept alive connections against a stub server that counts accepts: targets of
+// one gesture on the same server share a connection, so does the next gesture
+
+#include <stdio.h>
+#include <string.h>
+#include <user_interface.h>
+#include "ns.h"
+#include "sleep.h"
+#include "server.h"
+#include "shim.h"
+#include "test.h"
+
+static uint8_t done;
+static uint8_t errors;
+
+static uint8_t test_pool_recv(void* owner, uint8_t* data, uint32_t len) {
+	return 0;
+}
+
+static void test_pool_done(void* owner, uint8_t error) {
+	done++;
+	errors += error ? 1 : 0;
+}
+
+/*one gesture, count targets joined with || the way actions store them*/
+static void test_pool_gesture(Ns_T ns, uint16_t port, uint8_t count) {
+	char url[256];
+	uint16_t len = 0;
+	uint8_t i;
+	for (i = 0; i < count; i++) {
+		len += sprintf(url + len, "%sget://127.0.0.1:%u/target%u", i ? "||" : "", port, i);
+	}
+	CHECK(ns_multi_query(ns, url, NULL, NULL, test_pool_recv, test_pool_done) == count);
+}
+
+static Server_Stats_T test_pool_run(uint8_t keep_alive, uint8_t gestures, uint8_t count) {
+	Server_T server = server_new("{}");
+	Server_Stats_T stats;
+	Ns_T ns;
+	uint8_t i;
+	shim_boot(REASON_DEFAULT_RST);
+	/*no deep sleep in the middle of the test*/
+	sleep_lock(SLEEP_DELAY);
+	ns = ns_new();
+	ns_slots(ns, 3);
+	ns_keep_alive(ns, keep_alive);
+	ns_connect(ns, 1);
+	done = 0;
+	errors = 0;
+	for (i = 0; i < gestures; i++) {
+		test_pool_gesture(ns, server_port(server), count);
+		shim_run_for(2000000);
+	}
+	CHECK((done == gestures * count) && !errors);
+	ns_pool_close(ns);
+	shim_run_for(1000000);
+	stats = server_stats(server);
+	ns_delete(ns);
+	server_delete(server);
+	return stats;
+}
+
+int main(void) {
+	Server_Stats_T stats;
+	stats = test_pool_run(0, 2, 3);
+	CHECK((stats.accepts == 6) && (stats.requests == 6));
+	printf("pool off: %u accepts for %u requests\n", stats.accepts, stats.requests);
+	stats = test_pool_run(1, 2, 3);
+	CHECK((stats.accepts == 1) && (stats.requests == 6));
+	printf("pool on: %u accepts for %u requests\n", stats.accepts, stats.requests);
+	TEST_DONE("pool");
+}
@@ -0,0 +1,214 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The SDK shims themselves: timer order, espconn both ways over loopback, UDP,
+// DNS, the station event sequence and keep-alive against the stub server
+
+#include <string.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include <espconn.h>
+#include "server.h"
+#include "shim.h"
+#include "test.h"
+
+static uint32_t fired[2];
+static uint64_t last_fired;
+static uint8_t events[8];
+static uint8_t event_count;
+static char received[256];
+static uint16_t received_len;
+static uint8_t closed;
+static uint8_t resolved;
+
+static void test_shim_timer_cb(void* arg) {
+	fired[(uintptr_t)arg]++;
+	last_fired = shim_now();
+}
+
+static void test_shim_recv(void* arg, char* data, unsigned short len) {
+	if ((received_len + len) < sizeof(received)) {
+		memcpy(received + received_len, data, len);
+		received_len += len;
+	}
+}
+
+/*the server end echoes what it gets*/
+static void test_shim_echo(void* arg, char* data, unsigned short len) {
+	espconn_send(arg, (uint8*)data, len);
+}
+
+static void test_shim_accepted(void* arg) {
+	espconn_regist_recvcb(arg, test_shim_echo);
+}
+
+static void test_shim_connected(void* arg) {
+	espconn_send(arg, (uint8*)"ping", 4);
+}
+
+static void test_shim_closed(void* arg) {
+	closed++;
+}
+
+static void test_shim_dns(const char* name, ip_addr_t* ip, void* arg) {
+	ip_addr_t expected;
+	IP4_ADDR(&expected, 127, 0, 0, 2);
+	resolved = (ip && (ip->addr == expected.addr)) ? 1 : 2;
+}
+
+static void test_shim_event(System_Event_t* event) {
+	if (event_count < sizeof(events)) {
+		events[event_count++] = event->event;
+	}
+}
+
+static void test_shim_request(void* arg) {
+	const char* get = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+	espconn_send(arg, (uint8*)get, strlen(get));
+}
+
+static void test_shim_timers(void) {
+	static os_timer_t once;
+	static os_timer_t repeat;
+	shim_boot(REASON_DEFAULT_RST);
+	os_timer_setfn(&once, test_shim_timer_cb, (void*)0);
+	os_timer_setfn(&repeat, test_shim_timer_cb, (void*)1);
+	os_timer_arm(&once, 30, 0);
+	os_timer_arm(&repeat, 10, 1);
+	CHECK(shim_run_for(35000) == SHIM_RUN_TIME);
+	CHECK((fired[0] == 1) && (fired[1] == 3));
+	CHECK(last_fired == 30000);
+	os_timer_disarm(&repeat);
+	CHECK(shim_run(SHIM_NEVER) == SHIM_RUN_IDLE);
+	CHECK(fired[1] == 3);
+	os_timer_arm(&once, 5, 0);
+	system_deep_sleep(1000000);
+	CHECK(shim_run(SHIM_NEVER) == SHIM_RUN_SLEEP);
+	CHECK(shim_sleep_us() == 1000000);
+}
+
+static void test_shim_tcp(void) {
+	struct espconn server = {.type = ESPCONN_TCP};
+	struct espconn client = {.type = ESPCONN_TCP};
+	esp_tcp server_tcp = {.local_port = 80};
+	esp_tcp client_tcp = {.remote_ip = {127, 0, 0, 1}};
+	shim_boot(REASON_DEFAULT_RST);
+	server.proto.tcp = &server_tcp;
+	client.proto.tcp = &client_tcp;
+	espconn_regist_connectcb(&server, test_shim_accepted);
+	CHECK(espconn_accept(&server) == ESPCONN_OK);
+	CHECK(shim_espconn_port(&server) != 0);
+	client_tcp.remote_port = shim_espconn_port(&server);
+	espconn_regist_connectcb(&client, test_shim_connected);
+	espconn_regist_recvcb(&client, test_shim_recv);
+	espconn_regist_disconcb(&client, test_shim_closed);
+	received_len = 0;
+	CHECK(espconn_connect(&client) == ESPCONN_OK);
+	shim_run(SHIM_NEVER);
+	CHECK((received_len == 4) && !memcmp(received, "ping", 4));
+	CHECK(shim_net_stats()->accepts == 1);
+	CHECK(espconn_disconnect(&client) == ESPCONN_OK);
+	shim_run(SHIM_NEVER);
+	CHECK(closed == 1);
+	espconn_delete(&server);
+	/*only loopback is reachable, the rest times out on the virtual clock*/
+	client_tcp.remote_ip[0] = 10;
+	espconn_regist_reconcb(&client, NULL);
+	CHECK(espconn_connect(&client) == ESPCONN_OK);
+	shim_run(SHIM_NEVER);
+	CHECK(shim_now() >= 10000000);
+}
+
+static void test_shim_udp(void) {
+	struct espconn a = {.type = ESPCONN_UDP};
+	struct espconn b = {.type = ESPCONN_UDP};
+	esp_udp a_udp = {.local_port = 0};
+	esp_udp b_udp = {.local_port = 0};
+	ip_addr_t ip;
+	shim_boot(REASON_DEFAULT_RST);
+	a.proto.udp = &a_udp;
+	b.proto.udp = &b_udp;
+	CHECK(espconn_create(&a) == ESPCONN_OK);
+	CHECK(espconn_create(&b) == ESPCONN_OK);
+	espconn_regist_recvcb(&a, test_shim_recv);
+	b_udp.remote_port = shim_espconn_port(&a);
+	received_len = 0;
+	CHECK(espconn_sendto(&b, (uint8*)"hello", 5) == ESPCONN_OK);
+	shim_run(SHIM_NEVER);
+	CHECK((received_len == 5) && !memcmp(received, "hello", 5));
+	CHECK(a_udp.remote_port == shim_espconn_port(&b));
+	espconn_delete(&a);
+	espconn_delete(&b);
+	shim_dns_add("device.test", "127.0.0.2");
+	CHECK(espconn_gethostbyname(&a, "device.test", &ip, test_shim_dns) == ESPCONN_INPROGRESS);
+	shim_run(SHIM_NEVER);
+	CHECK(resolved == 1);
+	CHECK(espconn_gethostbyname(&a, "unknown.test", &ip, test_shim_dns) == ESPCONN_INPROGRESS);
+	shim_run(SHIM_NEVER);
+	CHECK(resolved == 2);
+}
+
+static void test_shim_station(void) {
+	struct station_config config;
+	shim_boot(REASON_DEFAULT_RST);
+	wifi_set_event_handler_cb(test_shim_event);
+	memset(&config, 0, sizeof(config));
+	strcpy((char*)config.ssid, "shim");
+	strcpy((char*)config.password, "wrong");
+	wifi_station_set_config(&config);
+	wifi_station_connect();
+	shim_run(SHIM_NEVER);
+	CHECK((event_count == 1) && (events[0] == EVENT_STAMODE_DISCONNECTED));
+	strcpy((char*)config.password, "shim-password");
+	wifi_station_set_config(&config);
+	event_count = 0;
+	wifi_station_connect();
+	shim_run(SHIM_NEVER);
+	CHECK((event_count == 2) && (events[0] == EVENT_STAMODE_CONNECTED) && (events[1] == EVENT_STAMODE_GOT_IP));
+	CHECK(wifi_station_get_connect_status() == STATION_GOT_IP);
+	wifi_set_event_handler_cb(NULL);
+}
+
+static void test_shim_server(void) {
+	struct espconn client = {.type = ESPCONN_TCP};
+	esp_tcp client_tcp = {.remote_ip = {127, 0, 0, 1}};
+	Server_T server = server_new("hello");
+	Server_Stats_T stats;
+	CHECK(server != NULL);
+	shim_boot(REASON_DEFAULT_RST);
+	client.proto.tcp = &client_tcp;
+	client_tcp.remote_port = server_port(server);
+	espconn_regist_connectcb(&client, test_shim_request);
+	espconn_regist_recvcb(&client, test_shim_recv);
+	received_len = 0;
+	espconn_connect(&client);
+	shim_run(SHIM_NEVER);
+	CHECK((received_len > 5) && !memcmp(received + received_len - 5, "hello", 5));
+	received_len = 0;
+	test_shim_request(&client);
+	shim_run(SHIM_NEVER);
+	CHECK((received_len > 5) && !memcmp(received + received_len - 5, "hello", 5));
+	stats = server_stats(server);
+	CHECK((stats.accepts == 1) && (stats.requests == 2));
+	server_delete(server);
+}
+
+int main(void) {
+	test_shim_timers();
+	test_shim_tcp();
+	test_shim_udp();
+	test_shim_station();
+	test_shim_server();
+	TEST_DONE("shim");
+}
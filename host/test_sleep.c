@@ -0,0 +1,170 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Wake counter over deep sleep: the sleep limit from the RTC calibration, the
+// measured sleep and its 1/8 sanity bound, wc.drift and RF-less counting wakes
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <user_interface.h>
+#include "user_config.h"
+#include "sleep.h"
+#include "rtc.h"
+#include "shim.h"
+#include "test.h"
+
+#define TEST_SLEEP_START 100000
+/*RTC tick period in us with 12 fractional bits*/
+#define TEST_SLEEP_TICK(us_x1000) ((uint32_t)(((uint64_t)(us_x1000) << 12) / 1000))
+
+typedef struct {
+	uint8_t pass;
+	uint8_t rf;
+	uint8_t report;
+	uint64_t sleep;
+} Test_Sleep_Boot_T;
+
+/*one timer wake in a child, as user_rf_pre_init and user_init start it*/
+static Test_Sleep_Boot_T test_sleep_boot(void) {
+	Test_Sleep_Boot_T boot;
+	int fds[2];
+	int status;
+	pid_t pid;
+	memset(&boot, 0, sizeof(boot));
+	if (pipe(fds)) {
+		return boot;
+	}
+	fflush(stdout);
+	if (!(pid = fork())) {
+		close(fds[0]);
+		shim_boot(REASON_DEEP_SLEEP_AWAKE);
+		boot.pass = sleep_wc_pre_init() && sleep_wc_pass();
+		boot.rf = shim_rf_option();
+		if (!boot.pass) {
+			sleep_init(0, NULL);
+			boot.report = sleep_wc_event(1);
+		}
+		boot.sleep = shim_sleep_us();
+		fflush(stdout);
+		_exit(write(fds[1], &boot, sizeof(boot)) != sizeof(boot));
+	}
+	close(fds[1]);
+	if ((pid < 0) || (read(fds[0], &boot, sizeof(boot)) != sizeof(boot))) {
+		memset(&boot, 0, sizeof(boot));
+	}
+	close(fds[0]);
+	if (pid > 0) {
+		waitpid(pid, &status, 0);
+	}
+	return boot;
+}
+
+/*went to sleep for period s at TEST_SLEEP_START, since s after the last report*/
+static void test_sleep_arm(uint32_t period, uint32_t since, uint32_t tick, uint32_t cali) {
+	RWC_T wc;
+	shim_rtc_clear();
+	shim_rtc_cali(tick, cali);
+	memset(&wc, 0, sizeof(wc));
+	wc.sleep_timestamp = TEST_SLEEP_START;
+	wc.sleep_period = period;
+	wc.begin_timestamp = TEST_SLEEP_START - since;
+	wc.rtc_ticks = system_get_rtc_time();
+	wc.rtc_cali = cali;
+	CHECK(rtc_write(RTC_WC_OFFSET, &wc, sizeof(wc)));
+}
+
+static RWC_T test_sleep_wc(void) {
+	RWC_T wc;
+	memset(&wc, 0, sizeof(wc));
+	CHECK(rtc_read(RTC_WC_OFFSET, &wc, sizeof(wc)));
+	return wc;
+}
+
+/*woke after slept s, returns the sleep taken next in s*/
+static uint32_t test_sleep_wake(uint64_t slept_us, uint8_t pass) {
+	Test_Sleep_Boot_T boot;
+	shim_rtc_advance(slept_us);
+	boot = test_sleep_boot();
+	CHECK(boot.pass == pass);
+	CHECK(boot.rf == (pass ? 4 : 0));
+	/*a wake let through with RF is the report*/
+	CHECK(boot.report == !pass);
+	return boot.sleep / 1000000;
+}
+
+static void test_sleep_bound(uint32_t period, int32_t off, uint8_t taken) {
+	RWC_T wc;
+	uint32_t tick = TEST_SLEEP_TICK(5750);
+	test_sleep_arm(period, 0, tick, tick);
+	test_sleep_wake((uint64_t)(period + off) * 1000000, 1);
+	wc = test_sleep_wc();
+	if (taken) {
+		/*measured to the tick, rounded down to the second*/
+		CHECK(abs((int32_t)(wc.sleep_timestamp - TEST_SLEEP_START) - (int32_t)(period + off)) <= 1);
+		CHECK(abs(wc.drift - off) <= 1);
+	} else {
+		CHECK(wc.sleep_timestamp == TEST_SLEEP_START + period);
+		CHECK(!wc.drift);
+	}
+}
+
+int main(void) {
+	RWC_T wc;
+	uint32_t tick;
+	uint32_t i;
+	sleep_lock(SLEEP_DELAY);
+
+	/*2^31 ticks less 1/16: 0x78000000 * 5.75 us*/
+	tick = TEST_SLEEP_TICK(5750);
+	test_sleep_arm(3600, 0, tick, tick);
+	CHECK(test_sleep_wake(3600000000ULL, 1) == 11576);
+	wc = test_sleep_wc();
+	CHECK((wc.sleep_period == 11576) && (wc.rtc_cali == tick));
+	CHECK(abs((int32_t)(wc.sleep_timestamp - TEST_SLEEP_START) - 3600) <= 1);
+	/*the next report is nearer than the limit*/
+	test_sleep_arm(3600, WAKEUP_PERIOD_S - 3600 - 5000, tick, tick);
+	i = test_sleep_wake(3600000000ULL, 1);
+	CHECK((i >= 4999) && (i <= 5001));
+	/*beyond 2^32 us, and capped by the report*/
+	test_sleep_arm(3600, 0, TEST_SLEEP_TICK(40000), TEST_SLEEP_TICK(40000));
+	CHECK(test_sleep_wake(3600000000ULL, 1) == WAKEUP_PERIOD_S - 3600);
+	/*without calibration the fixed period, and the requested time is taken as slept*/
+	test_sleep_arm(3600, 0, tick, 0);
+	CHECK(test_sleep_wake(3700000000ULL, 1) == 3600);
+	wc = test_sleep_wc();
+	CHECK((wc.sleep_timestamp == TEST_SLEEP_START + 3600) && !wc.drift);
+	/*the report wake runs the full firmware with RF*/
+	test_sleep_arm(3600, WAKEUP_PERIOD_S - 3600, tick, tick);
+	CHECK(test_sleep_wake(3600000000ULL, 0) == 0);
+	test_sleep_arm(3600, WAKEUP_PERIOD_S - 3600 - 8, tick, tick);
+	CHECK(test_sleep_wake(3600000000ULL, 0) == 0);
+
+	/*a measured sleep within 1/8 of the requested one is taken and drifts*/
+	test_sleep_bound(8000, 900, 1);
+	test_sleep_bound(8000, -900, 1);
+	test_sleep_bound(8000, 1100, 0);
+	test_sleep_bound(8000, -1100, 0);
+	test_sleep_bound(8000, 7000, 0);
+
+	/*drift adds up over wakes, the SDK sleeps ticks of its calibration*/
+	test_sleep_arm(3600, 0, TEST_SLEEP_TICK(5750), TEST_SLEEP_TICK(5744));
+	for (i = 0; i < 3; i++) {
+		wc = test_sleep_wc();
+		test_sleep_wake(shim_rtc_slept((uint64_t)wc.sleep_period * 1000000), 1);
+	}
+	wc = test_sleep_wc();
+	CHECK(abs(wc.drift) <= 3);
+	TEST_DONE("test sleep");
+}
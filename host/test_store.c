@@ -0,0 +1,107 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Store log on a RAM flash: reloads, deep sleep wakes and power cut during saves
+
+#include <string.h>
+#include <stddef.h>
+#include <user_interface.h>
+#include "store.h"
+#include "rtc.h"
+#include "shim.h"
+#include "test.h"
+
+#define TEST_STORE_SAVES 2000
+#define TEST_STORE_CUTS 1200
+
+extern struct Store_T store;
+
+static struct Store_T expected;
+static uint32_t seed = 1;
+
+static uint32_t test_store_rand(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+static void test_store_reboot(uint32_t reason) {
+	shim_reset(reason);
+	memset(&store, 0xA5, sizeof(store));
+	store_init();
+}
+
+/*touch a few bytes of the config, or most of it to force a snapshot sized record*/
+static void test_store_change(uint8_t wide) {
+	uint8_t* data = (uint8_t*)&store;
+	uint16_t first = offsetof(struct Store_T, token);
+	uint16_t count = wide ? (sizeof(store) - first) : (1 + test_store_rand() % 8);
+	while (count--) {
+		data[first + test_store_rand() % (sizeof(store) - first)] = test_store_rand();
+	}
+}
+
+static uint8_t test_store_same(const struct Store_T* content) {
+	return !memcmp(&store, content, sizeof(store));
+}
+
+int main(void) {
+	struct Store_T old;
+	struct Store_T new;
+	uint32_t erases;
+	uint16_t i;
+	shim_flash_erase();
+	shim_rtc_clear();
+	test_store_reboot(REASON_DEFAULT_RST);
+	CHECK(store.version == STORE_VERSION);
+	memcpy(&expected, &store, sizeof(store));
+	test_store_reboot(REASON_DEFAULT_RST);
+	CHECK(test_store_same(&expected));
+
+	/*appends replay to the same content, cold and from the RTC copy*/
+	erases = shim_flash_erases();
+	for (i = 0; i < TEST_STORE_SAVES; i++) {
+		test_store_change(!(i % 97));
+		CHECK(store_save());
+		memcpy(&expected, &store, sizeof(store));
+		if (!(i % 25)) {
+			test_store_reboot((i % 50) ? REASON_DEEP_SLEEP_AWAKE : REASON_DEFAULT_RST);
+			CHECK(test_store_same(&expected));
+		}
+	}
+	CHECK((shim_flash_erases() - erases) < (TEST_STORE_SAVES / 10));
+
+	/*power lost after every byte count of a save gives old or new content,*/
+	/*and the saves after it are not written over what the torn one left*/
+	for (i = 0; i < TEST_STORE_CUTS; i++) {
+		memcpy(&old, &store, sizeof(store));
+		test_store_change(!(i % 7));
+		memcpy(&new, &store, sizeof(store));
+		shim_flash_cut(i % (sizeof(store) + 64));
+		store_save();
+		test_store_reboot((i & 1) ? REASON_DEEP_SLEEP_AWAKE : REASON_DEFAULT_RST);
+		CHECK(test_store_same(&old) || test_store_same(&new));
+		/*RTC copy written at boot must match the log the wake finds*/
+		memcpy(&expected, &store, sizeof(store));
+		test_store_reboot(REASON_DEEP_SLEEP_AWAKE);
+		CHECK(test_store_same(&expected));
+		test_store_change(0);
+		CHECK(store_save());
+		memcpy(&expected, &store, sizeof(store));
+		test_store_reboot(REASON_DEEP_SLEEP_AWAKE);
+		CHECK(test_store_same(&expected));
+		test_store_reboot(REASON_DEFAULT_RST);
+		CHECK(test_store_same(&expected));
+	}
+	TEST_DONE("store");
+}
@@ -0,0 +1,119 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// URL sectors: the block reader against the word by word code that shipped
+// before it, both ways, and the RTC index going stale under writes
+
+#include <string.h>
+#include <stdlib.h>
+#include <user_interface.h>
+#include "url_storage.h"
+#include "url_legacy.h"
+#include "shim.h"
+#include "test.h"
+
+#define TEST_URL_SECTOR 0xF8
+
+static char test_url[__URL_TYPE_MAX][URL_MAX_SIZE + 1];
+
+static void test_url_fill(uint32_t round) {
+	uint32_t type;
+	uint32_t len;
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		/*empty, short, odd lengths and a full slot without terminator*/
+		len = (round * 7 + type * 131) % (URL_MAX_SIZE + 1);
+		if (type == (round % __URL_TYPE_MAX)) {
+			len = round % 2 ? URL_MAX_SIZE : 0;
+		}
+		memset(test_url[type], 'a' + (round + type) % 26, len);
+		test_url[type][len] = '\0';
+	}
+}
+
+static uint8_t test_url_same(const char* expected, char* str) {
+	uint8_t same = *expected ? (str && !strcmp(expected, str)) : !str;
+	free(str);
+	return same;
+}
+
+static void test_url_new_reads(Url_Storage_T* url) {
+	uint32_t type;
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		CHECK(test_url_same(test_url[type], url_storage_read(url, type)));
+	}
+}
+
+static void test_url_legacy_reads(void) {
+	uint32_t type;
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		CHECK(test_url_same(test_url[type], url_legacy_read(TEST_URL_SECTOR, type)));
+	}
+}
+
+int main(void) {
+	Url_Storage_T url;
+	Url_Storage_T kept;
+	uint32_t round;
+	uint32_t type;
+	uint32_t counter;
+	shim_flash_erase();
+	shim_rtc_clear();
+	url_storage_init(&url, TEST_URL_SECTOR);
+	CHECK(!url_storage_read(&url, URL_TYPE_SINGLE));
+	CHECK(!url_storage_counter(&url, &counter));
+	url_storage_init(&url, TEST_URL_SECTOR);
+
+	/*each round written by one side, read by both, cold and from the RTC index*/
+	for (round = 0; round < 40; round++) {
+		test_url_fill(round);
+		for (type = 0; type < __URL_TYPE_MAX; type++) {
+			if (round % 2) {
+				CHECK(url_storage_write(&url, type, test_url[type]));
+			} else {
+				CHECK(url_legacy_write(TEST_URL_SECTOR, type, test_url[type]));
+			}
+		}
+		/*after legacy writes the RTC index is stale, the headers give it away*/
+		test_url_new_reads(&url);
+		test_url_legacy_reads();
+		url_storage_init(&kept, TEST_URL_SECTOR);
+		test_url_new_reads(&kept);
+		if (!(round % 3)) {
+			shim_rtc_clear();
+		}
+		url_storage_init(&url, TEST_URL_SECTOR);
+	}
+	CHECK(url_storage_counter(&url, &counter) && (counter == 40 * __URL_TYPE_MAX - 1));
+
+	/*torn newest sector, both fall back to the previous copy*/
+	test_url_fill(100);
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		CHECK(url_storage_write(&url, type, test_url[type]));
+	}
+	test_url_new_reads(&url);
+	CHECK(url_storage_write(&url, URL_TYPE_LONG, "torn"));
+	shim_flash[(TEST_URL_SECTOR + ((counter + __URL_TYPE_MAX + 1) % 2)) * SPI_FLASH_SEC_SIZE + 100] ^= 0x01;
+	url_storage_init(&url, TEST_URL_SECTOR);
+	test_url_new_reads(&url);
+	test_url_legacy_reads();
+
+	/*erase drops the index with the sectors*/
+	url_storage_erase_all(&url);
+	url_storage_init(&kept, TEST_URL_SECTOR);
+	for (type = 0; type < __URL_TYPE_MAX; type++) {
+		CHECK(!url_storage_read(&url, type));
+		CHECK(!url_storage_read(&kept, type));
+		CHECK(!url_legacy_read(TEST_URL_SECTOR, type));
+	}
+	TEST_DONE("test url");
+}
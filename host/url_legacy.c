@@ -0,0 +1,152 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host build: the word by word URL sector reader and writer that shipped before
+// the block read and the RTC index, kept to pin the sector format
+
+#include <string.h>
+#include <stdlib.h>
+#include <user_interface.h>
+#include "url_legacy.h"
+#include "crc.h"
+
+#define URL_CRC_POLY 0x741B8CD7
+
+static uint8_t url_legacy_check_crc(uint32_t stored_crc, uint32_t sector) {
+	Crc_T crc;
+	uint32_t value;
+	uint32_t i;
+	crc_init(&crc, URL_CRC_POLY, 0);
+	for (i = 1; i < (SPI_FLASH_SEC_SIZE / sizeof(value)); i++) {
+		if (spi_flash_read((sector * SPI_FLASH_SEC_SIZE) + (i * sizeof(value)), &value, sizeof(value)) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+		crc_calculate(&crc, value);
+	}
+	return (crc_last(&crc) & 0xFFFFFFFF) == stored_crc;
+}
+
+/*valid bits of both sectors, headers left in header*/
+static uint8_t url_legacy_headers(uint32_t base_sector, Url_Storage_Herader_T* header) {
+	uint8_t valid = 0;
+	uint32_t i;
+	for (i = 0; i < 2; i++) {
+		if (spi_flash_read((base_sector + i) * SPI_FLASH_SEC_SIZE, (uint32_t*)&header[i], sizeof(Url_Storage_Herader_T)) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+		if (url_legacy_check_crc(header[i].crc, base_sector + i)) {
+			valid |= (1 << i);
+		}
+	}
+	return valid;
+}
+
+uint8_t url_legacy_write(uint32_t base_sector, Url_Storage_Type_T type, const char* str) {
+	Url_Storage_Herader_T header[2];
+	Crc_T crc;
+	uint32_t start;
+	uint32_t sector;
+	uint32_t counter;
+	uint32_t len;
+	uint32_t value;
+	uint32_t i;
+	uint32_t j;
+	uint8_t valid;
+	if ((type >= __URL_TYPE_MAX) || !str) {
+		return 0;
+	}
+	valid = url_legacy_headers(base_sector, header);
+	if (!valid) {
+		sector = 0;
+		counter = 0;
+	} else if (valid != 3) {
+		sector = (valid == 1) ? 1 : 0;
+		counter = header[(valid == 1) ? 0 : 1].counter + 1;
+	} else {
+		sector = (header[0].counter < header[1].counter) ? 0 : 1;
+		counter = header[sector ? 0 : 1].counter + 1;
+	}
+	if (spi_flash_erase_sector(base_sector + sector) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	start = sizeof(Url_Storage_Herader_T) + ((uint32_t)URL_MAX_SIZE * type);
+	len = strlen(str);
+	crc_init(&crc, URL_CRC_POLY, 0);
+	crc_calculate(&crc, counter);
+	for (i = sizeof(Url_Storage_Herader_T); i < SPI_FLASH_SEC_SIZE; i += sizeof(value)) {
+		if ((i >= start) && (i < (start + URL_MAX_SIZE))) {
+			value = 0;
+			for (j = 0; j < sizeof(value); j++) {
+				if ((i + j - start) < len) {
+					((uint8_t*)&value)[j] = str[i + j - start];
+				}
+			}
+		} else if (spi_flash_read(((base_sector + (sector + 1) % 2) * SPI_FLASH_SEC_SIZE) + i, &value, sizeof(value)) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+		if (spi_flash_write(((base_sector + sector) * SPI_FLASH_SEC_SIZE) + i, &value, sizeof(value)) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+		crc_calculate(&crc, value);
+	}
+	if (spi_flash_write(((base_sector + sector) * SPI_FLASH_SEC_SIZE) + sizeof(counter), &counter, sizeof(counter)) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	value = crc_last(&crc);
+	return spi_flash_write((base_sector + sector) * SPI_FLASH_SEC_SIZE, &value, sizeof(value)) == SPI_FLASH_RESULT_OK;
+}
+
+char* url_legacy_read(uint32_t base_sector, Url_Storage_Type_T type) {
+	Url_Storage_Herader_T header[2];
+	uint32_t start;
+	uint32_t sector;
+	uint32_t len = 0;
+	uint32_t i;
+	uint8_t data[4];
+	uint8_t valid;
+	char* res;
+	if (type >= __URL_TYPE_MAX) {
+		return NULL;
+	}
+	valid = url_legacy_headers(base_sector, header);
+	if (!valid) {
+		return NULL;
+	}
+	if (valid == 3) {
+		sector = (header[0].counter < header[1].counter) ? 1 : 0;
+	} else {
+		sector = (valid == 2) ? 1 : 0;
+	}
+	start = sizeof(Url_Storage_Herader_T) + ((uint32_t)URL_MAX_SIZE * type);
+	for (i = start; i < (start + URL_MAX_SIZE); i++) {
+		if (!(i % sizeof(data))) {
+			if (spi_flash_read(((base_sector + sector) * SPI_FLASH_SEC_SIZE) + i, (uint32_t*)data, sizeof(data)) != SPI_FLASH_RESULT_OK) {
+				return NULL;
+			}
+		}
+		if (!data[i % sizeof(data)] || (data[i % sizeof(data)] == 0xFF)) {
+			break;
+		}
+		len++;
+	}
+	if (!len || !(res = calloc(1, len + 5))) {
+		return NULL;
+	}
+	if (spi_flash_read(((base_sector + sector) * SPI_FLASH_SEC_SIZE) + start, (uint32_t*)res, len) != SPI_FLASH_RESULT_OK) {
+		free(res);
+		return NULL;
+	}
+	res[len] = '\0';
+	return res;
+}
@@ -0,0 +1,26 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Host build: the word by word URL sector reader and writer that shipped before
+// the block read and the RTC index, kept to pin the sector format
+
+#ifndef URL_LEGACY_H_INCLUDED
+#define URL_LEGACY_H_INCLUDED 1
+
+#include <inttypes.h>
+#include "url_storage.h"
+
+uint8_t url_legacy_write(uint32_t base_sector, Url_Storage_Type_T type, const char* str);
+char* url_legacy_read(uint32_t base_sector, Url_Storage_Type_T type);
+
+#endif
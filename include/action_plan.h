@@ -0,0 +1,44 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ACTION_PLAN_H_INCLUDED
+#define ACTION_PLAN_H_INCLUDED 1
+
+#include <inttypes.h>
+#include "url_storage.h"
+
+#define ACTION_PLAN_TYPE_SIZE 1536
+#define ACTION_PLAN_NONE 0xFFFF
+
+typedef struct {
+	uint32_t crc;
+	uint32_t counter;
+	uint16_t offset[__URL_TYPE_MAX];
+	uint16_t len[__URL_TYPE_MAX];
+	uint32_t crc_type[__URL_TYPE_MAX];
+} Action_Plan_Header_T;
+
+typedef struct {
+	uint32_t sector;
+} Action_Plan_T;
+
+Action_Plan_T* action_plan_init(Action_Plan_T* plan, uint32_t sector);
+uint8_t action_plan_build(Action_Plan_T* plan, Url_Storage_T* url);
+uint8_t action_plan_update(Action_Plan_T* plan, Url_Storage_T* url);
+uint8_t action_plan_read(Action_Plan_T* plan, Url_Storage_T* url, Url_Storage_Type_T type, uint8_t** data, uint16_t* len);
+uint8_t action_plan_head(Action_Plan_T* plan, Url_Storage_T* url, Url_Storage_Type_T type, uint32_t* data, uint16_t* len);
+void action_plan_erase(Action_Plan_T* plan);
+
+#endif
@@ -26,5 +26,7 @@ uint8_t payload_action(Payload_T p, const char* mac, Btn_Action_T action, uint16
 uint8_t payload_connect(Payload_T p, uint8_t yes);
 uint8_t payload_connected(Payload_T p);
 uint16_t payload_size(Payload_T p);
+uint16_t payload_pending(Payload_T p);
+uint32_t payload_rtt(Payload_T p);
 
 #endif
@@ -0,0 +1,54 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PAYLOAD_FRAME_H_INCLUDED
+#define PAYLOAD_FRAME_H_INCLUDED 1
+
+#include <inttypes.h>
+
+/*longest compact body payload_resp_rule accepts, the arena has room for*/
+/*fields the server adds later. whitespace outside strings is not stored*/
+#define PAYLOAD_RESP_LONGEST "{\"repeat\":10,\"speed\":8,\"r\":false,\"w\":false,\"g\":false,\"time\":\"2019-01-01T00:00:00Z\"}"
+#define PAYLOAD_FRAME_ARENA_SIZE (4 * sizeof(PAYLOAD_RESP_LONGEST))
+
+typedef enum {
+	PAYLOAD_FRAME_STATUS = 0,
+	PAYLOAD_FRAME_HEADER,
+	PAYLOAD_FRAME_BODY,
+	PAYLOAD_FRAME_CHUNK_SIZE,
+	PAYLOAD_FRAME_CHUNK_DATA,
+	PAYLOAD_FRAME_CHUNK_END,
+	PAYLOAD_FRAME_DONE
+} Payload_Frame_State_T;
+
+/*http response split over any number of segments, the arena holds the*/
+/*current header line and then the body without whitespace*/
+typedef struct {
+	char* arena;
+	uint32_t len;
+	uint16_t fill;
+	uint16_t code;
+	uint8_t state;
+	uint8_t digits;
+	uint8_t chunked;
+	uint8_t extension : 1;
+	uint8_t overflow : 1;
+	uint8_t quoted : 1;
+	uint8_t escaped : 1;
+} Payload_Frame_T;
+
+void payload_frame_init(Payload_Frame_T* frame, char* arena);
+uint8_t payload_frame_feed(Payload_Frame_T* frame, uint8_t* data, uint32_t len);
+
+#endif
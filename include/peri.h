@@ -47,7 +47,6 @@
 	#define LED_W_GPIO 5
 	#define LED_G_ACU_GPIO 13
 	#define INHIBIT_GPIO 12
-	#define PWM_LEVELS 32
 #endif
 
 typedef struct I2C_Order_T* I2C_Order_T;
@@ -0,0 +1,42 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PERI_BTN_H_INCLUDED
+#define PERI_BTN_H_INCLUDED 1
+
+#include <inttypes.h>
+#include "peri.h"
+
+#define BTN_PERIOD_DEBOUNCE (5)
+#define BTN_PERIOD_SHORT (400)
+#define BTN_PERIOD_LONG (1000)
+#define BTN_PERIOD_SERVICE (5000)
+#define BTN_PERIOD_RESET (10000)
+
+/*gesture state of one button, fed with debounced levels and edge times in us*/
+typedef struct {
+	void (*action)(Btn_Action_T action);
+	uint32_t press_time;
+	uint32_t release_time;
+	uint8_t level : 1;
+	uint8_t wait_next : 1;
+	uint8_t held_long : 1;
+	uint8_t held_reset : 1;
+} Peri_Btn_T;
+
+void peri_btn_init(Peri_Btn_T* btn, void (*action)(Btn_Action_T action));
+void peri_btn_gesture(Peri_Btn_T* btn, uint8_t level, uint32_t time);
+void peri_btn_timeout(Peri_Btn_T* btn, uint32_t now);
+uint8_t peri_btn_pending(Peri_Btn_T* btn);
+
+#endif
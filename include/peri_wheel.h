@@ -0,0 +1,34 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PERI_WHEEL_H_INCLUDED
+#define PERI_WHEEL_H_INCLUDED 1
+
+#include <inttypes.h>
+
+/*wheel motion not yet sent, raw IQS units, 16 make one step*/
+typedef struct {
+	int32_t diff;
+	uint32_t count;
+	uint32_t sent;
+} Peri_Wheel_T;
+
+void peri_wheel_init(Peri_Wheel_T* wheel);
+void peri_wheel_add(Peri_Wheel_T* wheel, uint16_t count, int16_t diff);
+uint8_t peri_wheel_pending(Peri_Wheel_T* wheel);
+uint16_t peri_wheel_take(Peri_Wheel_T* wheel);
+uint16_t peri_wheel_send(Peri_Wheel_T* wheel, uint32_t now);
+uint32_t peri_wheel_pace(uint32_t rtt);
+uint32_t peri_wheel_wait(Peri_Wheel_T* wheel, uint32_t now, uint32_t pace);
+
+#endif
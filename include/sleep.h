@@ -46,6 +46,8 @@ uint8_t sleep_reset(void);
 void sleep_done(void);
 void sleep_immediately(void);
 void sleep_restart(void);
+uint8_t sleep_wc_pre_init(void);
+uint8_t sleep_wc_pass(void);
 uint8_t sleep_wc_event(uint8_t timer);
 void sleep_update_timestamp(uint32_t timestamp);
 uint32_t sleep_get_current_timestamp(void);
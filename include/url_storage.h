@@ -34,13 +34,24 @@ typedef enum {
 	__URL_TYPE_MAX
 } Url_Storage_Type_T;
 
+/*validated sectors and string lengths of the read sector*/
+typedef struct {
+	Url_Storage_Herader_T header[2];
+	uint16_t len[__URL_TYPE_MAX];
+	uint8_t valid;
+	uint8_t sector;
+} Url_Storage_Index_T;
+
 typedef struct {
 	uint32_t base_sector;
+	Url_Storage_Index_T index;
+	uint8_t indexed : 1;
 } Url_Storage_T;
 
 Url_Storage_T* url_storage_init(Url_Storage_T* url, uint32_t base_sector);
 uint8_t url_storage_write(Url_Storage_T* url, Url_Storage_Type_T type, const char* str);
 char* url_storage_read(Url_Storage_T* url, Url_Storage_Type_T type);
+uint8_t url_storage_counter(Url_Storage_T* url, uint32_t* counter);
 void url_storage_erase_all(Url_Storage_T* storage);
 
 #endif
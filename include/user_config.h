@@ -26,6 +26,19 @@
 #define AP_BLINK_PERIOD 2000
 #define WAKEUP_PERIOD_S 43200
 #define PERIODIC_WAKEUP_TIME 35000
+#define WHEEL_MIN_INTERVAL 100
+#define WHEEL_MAX_INTERVAL 500
+#define WHEEL_PACE_ADAPTIVE 1
+
+/*flash map, SPI_SIZE_MAP 5 (2 MB, 1024+1024), 4 KB sectors:
+  0x000 boot, 0x001 user1 image, 0x101 user2 image
+  0xF8-0xF9 url storage
+  0xFA action plan, rebuilt from the url storage when stale
+  0xFB-0xFD unused
+  0xFE-0xFF store log (STORE_SECTOR_A/B in store.c)
+  0x1FB rf cal, 0x1FC rf init data, 0x1FD-0x1FF sdk parameters*/
+#define URL_STORAGE_SECTOR 0xF8
+#define ACTION_PLAN_SECTOR 0xFA
 //#define WAKEUP_PERIOD_S 240
 
 #endif
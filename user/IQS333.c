@@ -34,6 +34,7 @@
 #include "rule.h"
 #include "wifi.h"
 #include "store.h"
+#include "pin.h"
 
 typedef struct {
 	uint8_t command;
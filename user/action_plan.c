@@ -0,0 +1,201 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include <stdlib.h>
+#include <osapi.h>
+#include <user_interface.h>
+#include "action_plan.h"
+#include "buffer.h"
+#include "crc.h"
+#include "debug.h"
+#include "ns.h"
+
+#define ACTION_PLAN_CRC_POLY 0x741B8CD7
+
+static uint32_t ICACHE_FLASH_ATTR action_plan_crc(const uint8_t* data, uint16_t len) {
+	Crc_T crc;
+	crc_init(&crc, ACTION_PLAN_CRC_POLY, 0);
+	return crc_check(&crc, data, len) & 0xFFFFFFFF;
+}
+
+static uint8_t ICACHE_FLASH_ATTR action_plan_header(Action_Plan_T* plan, Action_Plan_Header_T* header) {
+	if (!plan || !header) {
+		return 0;
+	}
+	if (spi_flash_read(plan->sector * SPI_FLASH_SEC_SIZE, (uint32_t*)header, sizeof(Action_Plan_Header_T)) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	if (header->crc != action_plan_crc((uint8_t*)header + sizeof(header->crc), sizeof(Action_Plan_Header_T) - sizeof(header->crc))) {
+		return 0;
+	}
+	return 1;
+}
+
+Action_Plan_T* ICACHE_FLASH_ATTR action_plan_init(Action_Plan_T* plan, uint32_t sector) {
+	if (!plan) {
+		return 0;
+	}
+	memset(plan, 0, sizeof(Action_Plan_T));
+	plan->sector = sector;
+	return plan;
+}
+
+uint8_t ICACHE_FLASH_ATTR action_plan_build(Action_Plan_T* plan, Url_Storage_T* url) {
+	Action_Plan_Header_T header;
+	Buffer_T buffer = NULL;
+	char* str;
+	uint16_t offset = sizeof(Action_Plan_Header_T);
+	uint16_t size;
+	uint8_t i;
+	if (!plan || !url) {
+		return 0;
+	}
+	memset(&header, 0, sizeof(Action_Plan_Header_T));
+	if (!url_storage_counter(url, &header.counter)) {
+		return 0;
+	}
+	if (spi_flash_erase_sector(plan->sector) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	for (i = 0; i < __URL_TYPE_MAX; i++) {
+		if (!(str = url_storage_read(url, i))) {
+			continue;
+		}
+		/*types that do not fit are sent the slow way*/
+		header.offset[i] = ACTION_PLAN_NONE;
+		size = SPI_FLASH_SEC_SIZE - offset;
+		if (size > ACTION_PLAN_TYPE_SIZE) {
+			size = ACTION_PLAN_TYPE_SIZE;
+		}
+		if (!size || !(buffer = buffer_new(size))) {
+			free(str);
+			continue;
+		}
+		if (ns_plan(str, buffer) && !buffer_overflow(buffer)) {
+			size = buffer_size(buffer);
+			if (spi_flash_write((plan->sector * SPI_FLASH_SEC_SIZE) + offset, (uint32_t*)buffer_data(buffer, 0), size) == SPI_FLASH_RESULT_OK) {
+				header.offset[i] = offset;
+				header.len[i] = size;
+				header.crc_type[i] = action_plan_crc(buffer_data(buffer, 0), size);
+				offset += size;
+			}
+		}
+		buffer_delete(buffer);
+		free(str);
+	}
+	debug_value(offset);
+	/*header last, an interrupted build stays invalid*/
+	header.crc = action_plan_crc((uint8_t*)&header + sizeof(header.crc), sizeof(Action_Plan_Header_T) - sizeof(header.crc));
+	if (spi_flash_write(plan->sector * SPI_FLASH_SEC_SIZE, (uint32_t*)&header, sizeof(Action_Plan_Header_T)) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	return 1;
+}
+
+uint8_t ICACHE_FLASH_ATTR action_plan_update(Action_Plan_T* plan, Url_Storage_T* url) {
+	Action_Plan_Header_T header;
+	uint32_t counter;
+	if (!plan || !url) {
+		return 0;
+	}
+	if (!url_storage_counter(url, &counter)) {
+		return 0;
+	}
+	if (action_plan_header(plan, &header) && (header.counter == counter)) {
+		return 1;
+	}
+	debug_describe_P("Action plan stale");
+	return action_plan_build(plan, url);
+}
+
+/*header of a plan built from the current urls, with the type planned*/
+static uint8_t ICACHE_FLASH_ATTR action_plan_type(Action_Plan_T* plan, Url_Storage_T* url, Url_Storage_Type_T type, Action_Plan_Header_T* header) {
+	uint32_t counter;
+	if (!url_storage_counter(url, &counter)) {
+		return 0;
+	}
+	if (!action_plan_header(plan, header) || (header->counter != counter)) {
+		return 0;
+	}
+	if (header->offset[type] == ACTION_PLAN_NONE) {
+		return 0;
+	}
+	if (header->len[type] && ((header->offset[type] % sizeof(uint32_t)) || ((header->offset[type] + header->len[type]) > SPI_FLASH_SEC_SIZE))) {
+		return 0;
+	}
+	return 1;
+}
+
+uint8_t ICACHE_FLASH_ATTR action_plan_read(Action_Plan_T* plan, Url_Storage_T* url, Url_Storage_Type_T type, uint8_t** data, uint16_t* len) {
+	Action_Plan_Header_T header;
+	uint8_t* res;
+	if (!plan || !url || (type >= __URL_TYPE_MAX) || !data || !len) {
+		return 0;
+	}
+	*data = NULL;
+	*len = 0;
+	if (!action_plan_type(plan, url, type, &header)) {
+		return 0;
+	}
+	if (!header.len[type]) {
+		return 1;
+	}
+	if (!(res = malloc(header.len[type]))) {
+		return 0;
+	}
+	if (spi_flash_read((plan->sector * SPI_FLASH_SEC_SIZE) + header.offset[type], (uint32_t*)res, header.len[type]) != SPI_FLASH_RESULT_OK) {
+		free(res);
+		return 0;
+	}
+	if (header.crc_type[type] != action_plan_crc(res, header.len[type])) {
+		free(res);
+		return 0;
+	}
+	*data = res;
+	*len = header.len[type];
+	return 1;
+}
+
+/*leading bytes of a type, enough to tell where its first request goes, not crc checked*/
+uint8_t ICACHE_FLASH_ATTR action_plan_head(Action_Plan_T* plan, Url_Storage_T* url, Url_Storage_Type_T type, uint32_t* data, uint16_t* len) {
+	Action_Plan_Header_T header;
+	uint16_t size;
+	if (!plan || !url || (type >= __URL_TYPE_MAX) || !data || !len) {
+		return 0;
+	}
+	size = *len & ~3;
+	*len = 0;
+	if (!action_plan_type(plan, url, type, &header)) {
+		return 0;
+	}
+	if (size > header.len[type]) {
+		size = header.len[type];
+	}
+	if (!size) {
+		return 1;
+	}
+	if (spi_flash_read((plan->sector * SPI_FLASH_SEC_SIZE) + header.offset[type], data, size) != SPI_FLASH_RESULT_OK) {
+		return 0;
+	}
+	*len = size;
+	return 1;
+}
+
+void ICACHE_FLASH_ATTR action_plan_erase(Action_Plan_T* plan) {
+	if (!plan) {
+		return;
+	}
+	spi_flash_erase_sector(plan->sector);
+}
@@ -31,6 +31,7 @@
 #include "store.h"
 #include "array_size.h"
 #include "sleep.h"
+#include "url_storage.h"
 
 extern struct Store_T store;
 
@@ -77,6 +78,17 @@ static const Rule_T control_set_rule[] ICACHE_RODATA_ATTR = {
 		.type = RULE_BOOLEAN,
 		.required = 0,
 	},
+	{
+		.name = "merge",
+		.type = RULE_UNSIGNED_INT,
+		.required = 0,
+		.detail = {
+			.unsigned_int = {
+				.min_val = 0,
+				.max_val = (1 << __URL_TYPE_MAX) - 1
+			}
+		}
+	},
 };
 
 static const Rule_T control_keep_rule[] ICACHE_RODATA_ATTR = {
@@ -126,6 +138,7 @@ static Parser_State_T ICACHE_FLASH_ATTR control_panel_get_exec(Buffer_T* buffer,
 	json_add_bool(json, "rest", store.rest_dis ? 0 : 1);
 	json_add_bool(json, "token", strnlen(store.token, sizeof(store.token)) ? 1 : 0);
 	json_add_bool(json, "bssid", store.bssid_enable);
+	json_add_int(json, "merge", store.merge_types);
 	if ((*buffer = json_to_buffer(json))) {
 		return Parser_State_OK_200;
 	}
@@ -147,18 +160,13 @@ static const struct Http_Page_T control_panel_get_page ICACHE_RODATA_ATTR = {
 
 static Parser_State_T ICACHE_FLASH_ATTR control_panel_set_exec(Buffer_T* buffer, Item_T* args, Value_T query_path, Buffer_T content) {
 	struct Value_T query[ARRAY_SIZE(control_set_rule)];
-	Json_T json;
-	memset(&query, 0, sizeof(query));
 	if (!content ||
 		!buffer_size(content) ||
-		!(json = json_parse(buffer_string(content), control_set_rule, ARRAY_SIZE(control_set_rule)))) {
+		!json_parse_values(buffer_string(content), control_set_rule, ARRAY_SIZE(control_set_rule), query)) {
 		return Parser_State_Bad_Request_400;
 	}
-	if (!json_to_values(json, query)) {
-		goto error;
-	}
-	if (!query[0].present && !query[1].present && !query[2].present && !query[3].present) {
-		goto error;
+	if (!query[0].present && !query[1].present && !query[2].present && !query[3].present && !query[4].present) {
+		return Parser_State_Bad_Request_400;
 	}
 	if (query[0].present) {
 		store.panel_dis = query[0].bool_value ? 0 : 1;
@@ -173,12 +181,11 @@ static Parser_State_T ICACHE_FLASH_ATTR control_panel_set_exec(Buffer_T* buffer,
 	if (query[3].present) {
 		store.bssid_enable = query[3].bool_value;
 	}
-	json_delete(json);
+	if (query[4].present) {
+		store.merge_types = query[4].uint_value;
+	}
 	store_save();
 	return Parser_State_OK_200;
-error:
-	json_delete(json);
-	return Parser_State_Bad_Request_400;
 }
 
 static const struct Http_Page_T control_panel_set_page ICACHE_RODATA_ATTR = {
@@ -35,6 +35,7 @@
 #include "parser.h"
 #include "sleep.h"
 #include "url_storage.h"
+#include "IQS333.h"
 
 extern Collect_T collect;
 extern struct Store_T store;
@@ -228,22 +229,18 @@ static const Rule_T device_veryfication_rule[] ICACHE_RODATA_ATTR = {
 	}
 };
 
-static Parser_State_T ICACHE_FLASH_ATTR device_exec_1(Buffer_T* buffer, Item_T* args, Value_T query, Buffer_T content) {
-	Json_T root;
-	if (!(root = collect_get_devices(collect))) {
+static Parser_State_T ICACHE_FLASH_ATTR device_exec_1(Json_T* json, Item_T* args, Value_T query, Buffer_T content) {
+	if (!(*json = collect_get_devices(collect))) {
 		return Parser_State_Internal_Server_Error_500;
 	}
-	if ((*buffer = json_to_buffer(root))) {
-		return Parser_State_OK_200;
-	}
-	return Parser_State_Internal_Server_Error_500;
+	return Parser_State_OK_200;
 }
 
 static const struct Http_Page_T device_page_1 ICACHE_RODATA_ATTR = {
 	.path = "api",
 	.content = NULL,
 	.type = "application/json",
-	.exec = device_exec_1,
+	.exec_json = device_exec_1,
 	.len = 0,
 	.dynamic = 1,
 	.method = Parser_Method_GET,
@@ -17,7 +17,6 @@
 #include <strings.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <ctype.h>
 #include <osapi.h>
 #include <user_interface.h>
 #include <ip_addr.h>
@@ -33,23 +32,31 @@
 #include "rtc.h"
 #include "store.h"
 #include "buffer.h"
-#include "slash.h"
 #include "rule.h"
 #include "json.h"
 #include "peri.h"
 #include "list.h"
+#include "array_size.h"
 #include "url_storage.h"
+#include "action_plan.h"
+#include "trace.h"
+#include "payload_frame.h"
+#include "sleep.h"
 
-#define PAYLOAD_BUFFER_SIZE 3072
 #define PAYLOAD_EVENT_PORT 7980
+#define PAYLOAD_NS_SLOTS 3
+#define PAYLOAD_MERGE_MAX 256
 
 typedef struct Payload_Action_T* Payload_Action_T;
+typedef struct Payload_Resp_T* Payload_Resp_T;
 
 struct Payload_T {
 	Ns_T ns;
 	List_T udp_events;
 	List_T ns_queue;
+	uint32_t rtt;
 	uint8_t connected : 1;
+	uint8_t warm : 1;
 };
 
 typedef struct {
@@ -68,6 +75,12 @@ typedef struct {
 	uint8_t local : 1;
 } Payload_Ns_Event_T;
 
+/*queued events of these url types can be folded into one request when enabled in*/
+/*store.merge_types, the key is repeated per event (action=1&action=2), other params once*/
+static const char* const payload_merge_key[__URL_TYPE_MAX] = {
+	[URL_TYPE_GENERIC] = "action="
+};
+
 typedef struct Udp_Event_T* Udp_Event_T;
 
 struct Udp_Event_T {
@@ -81,21 +94,26 @@ struct Udp_Event_T {
 
 struct Payload_Action_T {
 	Payload_T payload;
-	Buffer_T buffer;
 	Btn_Action_T action;
-	uint32_t len;
-	uint32_t read;
-	uint16_t code;
 	uint16_t items;
-	uint8_t chunked;
+	uint32_t begin;
 	uint8_t local : 1;
-	uint8_t handled : 1;
-	uint8_t body : 1;
-	uint8_t headers : 1;
+	uint8_t done : 1;
+	uint8_t failed : 1;
 };
 
+struct Payload_Resp_T {
+	Payload_Action_T pa;
+	Payload_Frame_T frame;
+};
+
+/*one slot per ns connection, holds the current header line and then the body*/
+static char payload_arena[PAYLOAD_NS_SLOTS][PAYLOAD_FRAME_ARENA_SIZE];
+static uint8_t payload_arena_used;
+
 extern struct Store_T store;
 extern Url_Storage_T url_storage;
+extern Action_Plan_T action_plan;
 
 enum {
 	RESP_REPEAT = 0,
@@ -154,24 +172,9 @@ static const Rule_T payload_resp_rule[] ICACHE_RODATA_ATTR = {
 	},
 };
 
-static const Rule_T payload_rule_hex ICACHE_RODATA_ATTR = {
-	.type = RULE_HEX,
-	.min_len = 1,
-	.max_len = 8
-};
-
-static const Rule_T payload_rule_len ICACHE_RODATA_ATTR = {
-	.type = RULE_UNSIGNED_INT,
-	.detail = {
-			.unsigned_int = {
-					.min_val = 0,
-					.max_val = PAYLOAD_BUFFER_SIZE - 1
-			}
-	}
-};
-
 static uint8_t ICACHE_FLASH_ATTR payload_udp_action(Payload_T p, const char* mac, Btn_Action_T action, uint16_t value);
 static uint8_t ICACHE_FLASH_ATTR payload_send_ns_event(Payload_T p);
+static void ICACHE_FLASH_ATTR payload_action_peri_blink(Payload_Action_T pa, uint8_t r, uint8_t w, uint8_t g, uint8_t speed, uint8_t repeat);
 
 static Payload_Action_T ICACHE_FLASH_ATTR payload_action_new(Payload_T payload, uint8_t local, Btn_Action_T action) {
 	Payload_Action_T payload_action;
@@ -185,16 +188,10 @@ static Payload_Action_T ICACHE_FLASH_ATTR payload_action_new(Payload_T payload,
 	payload_action->payload = payload;
 	payload_action->local = local ? 1 : 0;
 	payload_action->action = action;
+	payload_action->begin = system_get_time();
 	return payload_action;
 }
 
-static void ICACHE_FLASH_ATTR payload_action_set_items_items_count(Payload_Action_T pa, uint16_t count) {
-	if (!pa) {
-		return;
-	}
-	pa->items = count;
-}
-
 static uint8_t ICACHE_FLASH_ATTR payload_action_is_last_item(Payload_Action_T pa) {
 	if (!pa) {
 		return 0;
@@ -212,12 +209,55 @@ static void ICACHE_FLASH_ATTR payload_action_delete(Payload_Action_T payload_act
 	if (!payload_action) {
 		return;
 	}
-	if (payload_action->buffer) {
-		buffer_delete(payload_action->buffer);
-	}
 	free(payload_action);
 }
 
+static void ICACHE_FLASH_ATTR payload_action_put(Payload_Action_T pa) {
+	Payload_T p;
+	if (!pa || !(p = pa->payload)) {
+		return;
+	}
+	if (payload_action_is_last_item(pa)) {
+		uint32_t rtt = (system_get_time() - pa->begin) / 1000;
+		/*smoothed time from queueing an action to its last response*/
+		p->rtt = p->rtt ? ((p->rtt * 3) + rtt) / 4 : rtt;
+		if (pa->local) {
+			if (pa->done) {
+				/*red when any target failed*/
+				payload_action_peri_blink(pa, pa->failed, 0, !pa->failed, 4, 1);
+			}
+			trace_mark(TRACE_DONE);
+			trace_report();
+		}
+		payload_action_delete(pa);
+		list_remove(p->ns_queue, 0);
+		payload_send_ns_event(p);
+	}
+}
+
+static Payload_Resp_T ICACHE_FLASH_ATTR payload_resp_new(Payload_Action_T pa) {
+	Payload_Resp_T resp;
+	if (!pa) {
+		return NULL;
+	}
+	if (!(resp = malloc(sizeof(struct Payload_Resp_T)))) {
+		return NULL;
+	}
+	memset(resp, 0, sizeof(struct Payload_Resp_T));
+	resp->pa = pa;
+	return resp;
+}
+
+static void ICACHE_FLASH_ATTR payload_resp_delete(Payload_Resp_T resp) {
+	if (!resp) {
+		return;
+	}
+	if (resp->frame.arena) {
+		payload_arena_used &= ~(1 << ((resp->frame.arena - payload_arena[0]) / PAYLOAD_FRAME_ARENA_SIZE));
+	}
+	free(resp);
+}
+
 static void ICACHE_FLASH_ATTR payload_action_peri_blink(Payload_Action_T pa, uint8_t r, uint8_t w, uint8_t g, uint8_t speed, uint8_t repeat) {
 	if (!pa) {
 		return;
@@ -235,115 +275,52 @@ static void ICACHE_FLASH_ATTR payload_action_peri_blink(Payload_Action_T pa, uin
 	peri_blink(r, w, g, speed, repeat);
 }
 
-static uint8_t ICACHE_FLASH_ATTR payload_action_blink(Payload_Action_T payload_action, uint8_t error) {
+/*local targets report here, the action blinks once when the last one is done*/
+static uint8_t ICACHE_FLASH_ATTR payload_action_result(Payload_Action_T payload_action, uint8_t error) {
 	if (!payload_action) {
 		return 0;
 	}
-	if (payload_action->handled) {
-		return 0;
-	}
 	if (!payload_action->local) {
 		return 0;
 	}
+	payload_action->done = 1;
 	if (error) {
-		payload_action_peri_blink(payload_action, 1, 0, 0, 4, 1);
-	} else {
-		payload_action_peri_blink(payload_action, 0, 0, 1, 4, 1);
+		payload_action->failed = 1;
 	}
-	payload_action->handled = 1;
 	return 1;
 }
 
-static Buffer_T ICACHE_FLASH_ATTR payload_action_buffer(Payload_Action_T payload_action) {
-	if (!payload_action) {
+static char* ICACHE_FLASH_ATTR payload_resp_arena(Payload_Resp_T resp) {
+	uint8_t i;
+	if (!resp) {
 		return NULL;
 	}
-	if (!payload_action->buffer) {
-		debug_describe_P("PA new buffer");
-		payload_action->buffer = buffer_new(PAYLOAD_BUFFER_SIZE);
+	if (resp->frame.arena) {
+		return resp->frame.arena;
+	}
+	for (i = 0; i < PAYLOAD_NS_SLOTS; i++) {
+		if (!(payload_arena_used & (1 << i))) {
+			payload_arena_used |= (1 << i);
+			resp->frame.arena = payload_arena[i];
+			break;
+		}
 	}
-	return payload_action->buffer;
+	return resp->frame.arena;
 }
 
 static void ICACHE_FLASH_ATTR payload_done(void* owner, uint8_t error) {
+	Payload_Resp_T resp;
 	Payload_Action_T pa;
-	Payload_T p;
-	uint8_t local;
-	if (!(pa = owner) || !(p = pa->payload)) {
+	if (!(resp = owner) || !(pa = resp->pa)) {
 		return;
 	}
 	debug_describe_P("---Payload done");
-	local = pa->local;
-	payload_action_blink(pa, error);
-	if (payload_action_is_last_item(pa)) {
-		payload_action_delete(pa);
-		list_remove(p->ns_queue, 0);
-		payload_send_ns_event(p);
+	if (resp->frame.state != PAYLOAD_FRAME_DONE) {
+		/*complete responses are reported by payload_recv, anything short of one failed*/
+		payload_action_result(pa, 1);
 	}
-}
-
-static uint8_t ICACHE_FLASH_ATTR payload_parse_status(Buffer_T buffer, uint16_t* ret_code) {
-	Slash_T slash;
-	char* version;
-	char* code;
-	char* describe;
-	int32_t ret_val;
-	if (!buffer) {
-		return 0;
-	}
-	if (!buffer_size(buffer)) {
-		debug_describe_P("Bad status size");
-		return 0;
-	}
-	slash_init(&slash, buffer_string(buffer), ' ');
-	if (!(version = slash_next(&slash)) ||
-		!(code = slash_next(&slash)) ||
-		!(describe = slash_current(&slash))) {
-			debug_describe_P("Bad status format");
-			return 0;
-	}
-	debug_printf("Version: %s\n", version);
-	debug_printf("Code: %s\n", code);
-	debug_printf("Describe: %s\n", describe);
-	if (!rule_check_digit(code, 100, 599, &ret_val)) {
-		debug_describe_P("Bad code");
-		return 0;
-	}
-	if (code) {
-		*ret_code = ret_val;
-	}
-	return 1;
-}
-
-static uint8_t ICACHE_FLASH_ATTR payload_check_header(Buffer_T buffer, uint8_t* chunked, uint32_t* len) {
-	Slash_T slash;
-	char* name;
-	char* value;
-	if (!buffer || !buffer_size(buffer)) {
-		return 0;
-	}
-	slash_init_delimeters(&slash, buffer_string(buffer), ": ");
-	if (!(name = slash_next(&slash)) ||
-		!(value = slash_current(&slash))) {
-			debug_describe_P("Bad header format");
-			return 0;
-	}
-	if (chunked && !strcasecmp(name, "Transfer-Encoding")) {
-		if (!strcmp(value, "chunked")) {
-			*chunked = 1;
-		}
-		return 1;
-	}
-	if (len && !strcasecmp(name, "Content-Length")) {
-		Item_T item;
-		if (!rule_check(&payload_rule_len, value, &item)) {
-			debug_describe_P("Rule lenght check error");
-			return 0;
-		}
-		*len = item.data_uint32;
-		return 1;
-	}
-	return 1;
+	payload_resp_delete(resp);
+	payload_action_put(pa);
 }
 
 /*
@@ -358,112 +335,45 @@ static const char* test_json =	"{"
 
 static uint8_t ICACHE_FLASH_ATTR payload_recv(void* owner, uint8_t* data, uint32_t len) {
 	struct Value_T values[__RESP_MAX];
-	Buffer_T buffer;
+	Payload_Resp_T resp;
 	Payload_Action_T pa;
-	Payload_T p;
-	Json_T json = NULL;
 	uint64_t utc_time;
-	uint32_t i;
-	uint8_t final = 0;
-	if (!(pa = owner) || !(p = pa->payload)) {
+	if (!(resp = owner) || !(pa = resp->pa)) {
 		return 0;
 	}
 	debug_printf("Payload recv: %uB\n", len);
-	if (!(buffer = payload_action_buffer(pa))) {
-		debug_describe_P("Can not create PA buffer");
+	trace_mark(TRACE_RESPONSE);
+	if (!payload_resp_arena(resp)) {
+		debug_describe_P("Can not get PA arena");
 		peri_set_white(0);
 		return 0;
 	}
-	for (i = 0; i < len; i++) {
-		if (!buffer_write(buffer, data[i])) {
-			final = 1;
-		}
-		if (pa->body) {
-			if (pa->chunked) {
-				if (pa->read) {
-					pa->read--;
-				}
-				if (!pa->read) {
-					if (buffer_equal_from_end_str(buffer, CRLF)) {
-						Item_T item;
-						if (buffer_size(buffer) == (pa->len + 2)) {
-							buffer_set_writer(buffer, buffer_size(buffer) - 2);
-							continue;
-						}
-						buffer_set_writer(buffer, buffer_size(buffer) - 2);
-						buffer_close(buffer);
-						if (!rule_check(&payload_rule_hex, (char*)buffer_data(buffer, pa->len), &item)) {
-							debug_describe_P("Rule chunk len check error");
-							debug_describe((char*)buffer_data(buffer, pa->len));
-							goto error;
-						}
-						buffer_set_writer(buffer, pa->len);
-						pa->read = item.data_uint32;
-						pa->len += pa->read;
-						if (!pa->read) {
-							debug_describe_P("End chunk");
-							final = 1;
-						}
-					}
-				}
-				continue;
-			}
-			if (buffer_size(buffer) >= pa->len) {
-				final = 1;
-			}
-			continue;
-		}
-		if (buffer_equal_from_end_str(buffer, CRLF)) {
-			if (buffer_size(buffer) == 2) {
-				if (pa->chunked && pa->len) {
-					goto error;
-				}
-				if (!pa->chunked && !pa->len) {
-					final = 1;
-				}
-				pa->body = 1;
-				debug_describe_P("Body");
-			} else {
-				buffer_set_writer(buffer, buffer_size(buffer) - 2);
-				if (!pa->headers) {
-					if (!payload_parse_status(buffer, &pa->code)) {
-						goto error;
-					}
-					pa->headers = 1;
-				} else {
-					debug_printf("Header: %s\n", buffer_string(buffer));
-					if (!payload_check_header(buffer, &pa->chunked, &pa->len)) {
-						debug_describe_P("Bad header");
-						goto error;
-					}
-				}
-			}
-			buffer_clear(buffer);
-		}
+	if (!payload_frame_feed(&resp->frame, data, len)) {
+		goto error;
 	}
-	if (!pa->body || !final) {
+	if (resp->frame.state != PAYLOAD_FRAME_DONE) {
 		return 1;
 	}
-	//buffer_set_writer(buffer, pa->len);
-	debug_describe(buffer_string(buffer));
-	if (payload_action_blink(pa, pa->code != 200)) {
+	resp->frame.arena[resp->frame.fill] = 0;
+	debug_describe(resp->frame.arena);
+	if (payload_action_result(pa, resp->frame.code != 200)) {
 		debug_describe_P("Local resp");
 		return 0;
 	}
-	if (pa->code != 200) {
+	if (resp->frame.code != 200) {
 		debug_describe_P("Bad code");
 		goto error1;
 	}
-	if (!buffer_size(buffer)) {
+	if (!resp->frame.fill) {
 		debug_describe_P("Empty resp");
 		goto error1;
 	}
-	if (!(json = json_parse(buffer_string(buffer), payload_resp_rule, __RESP_MAX))) {
-		debug_describe_P("Bad resp json");
+	if (resp->frame.overflow) {
+		debug_describe_P("Resp too long");
 		goto error1;
 	}
-	if (!json_to_values(json, values)) {
-		debug_describe_P("Invalid json");
+	if (!json_parse_values(resp->frame.arena, payload_resp_rule, __RESP_MAX, values)) {
+		debug_describe_P("Bad resp json");
 		goto error1;
 	}
 	if (rule_check_utc_time(values[RESP_TIME].string_value, &utc_time)) {
@@ -475,19 +385,15 @@ static uint8_t ICACHE_FLASH_ATTR payload_recv(void* owner, uint8_t* data, uint32
 		values[RESP_G].bool_value,
 		values[RESP_SPEED].uint_value,
 		values[RESP_REPEAT].uint_value);
-	json_delete(json);
 	return 0;
 error1:
-	if (pa->code != 200) {
+	if (resp->frame.code != 200) {
 		payload_action_peri_blink(pa, 1, 0, 0, 4, 1);
 	} else {
 		payload_action_peri_blink(pa, 0, 0, 1, 4, 1);
 	}
 error:
 	debug_describe_P("PA error response from server");
-	if (json) {
-		json_delete(json);
-	}
 	return 0;
 }
 
@@ -513,6 +419,8 @@ Payload_T ICACHE_FLASH_ATTR payload_new(void) {
 		return NULL;
 	}
 	ns_timeout(p->ns, 7500);
+	ns_slots(p->ns, PAYLOAD_NS_SLOTS);
+	ns_keep_alive(p->ns, 1);
 	return p;
 }
 
@@ -658,9 +566,60 @@ static uint8_t ICACHE_FLASH_ATTR payload_udp_action(Payload_T p, const char* mac
 	return 1;
 }
 
+static uint16_t ICACHE_FLASH_ATTR payload_send_plan(Payload_T p, Payload_Action_T pa, const uint8_t* plan, uint16_t len, const char* args) {
+	Payload_Resp_T resp;
+	uint16_t offset = 0;
+	uint16_t size;
+	uint16_t count = 0;
+	if (!p || !pa || !plan) {
+		return 0;
+	}
+	while ((size = ns_plan_next(plan, len, offset))) {
+		if (!(resp = payload_resp_new(pa))) {
+			break;
+		}
+		pa->items++;
+		if (!ns_plan_query(p->ns, plan + offset, size, args, resp, payload_recv, payload_done)) {
+			pa->items--;
+			payload_resp_delete(resp);
+			payload_action_result(pa, 1);
+			break;
+		}
+		offset += size;
+		count++;
+	}
+	return count;
+}
+
+static uint16_t ICACHE_FLASH_ATTR payload_send_url(Payload_T p, Payload_Action_T pa, char* url, const char* args) {
+	Payload_Resp_T resp;
+	char* part;
+	uint16_t count = 0;
+	if (!p || !pa || !url) {
+		return 0;
+	}
+	while ((part = ns_multi_next(&url))) {
+		if (!(resp = payload_resp_new(pa))) {
+			break;
+		}
+		pa->items++;
+		if (!ns_query(p->ns, part, args, resp, payload_recv, payload_done)) {
+			pa->items--;
+			payload_resp_delete(resp);
+			payload_action_result(pa, 1);
+			break;
+		}
+		count++;
+	}
+	return count;
+}
+
 static uint8_t ICACHE_FLASH_ATTR payload_send_ns_event(Payload_T p) {
 	Payload_Ns_Event_T event;
 	Payload_Action_T pa = NULL;
+	uint8_t* plan = NULL;
+	uint16_t len = 0;
+	uint8_t planned;
 	char* url = NULL;
 	uint16_t count = 0;
 	if (!p) {
@@ -670,35 +629,230 @@ static uint8_t ICACHE_FLASH_ATTR payload_send_ns_event(Payload_T p) {
 		return 0;
 	}
 	payload_udp_action(p, NULL, event.action, 0);
-	if (!(url = url_storage_read(&url_storage, event.type))) {
+	/*precompiled requests skip url parsing, fall back to the stored url*/
+	if (!(planned = action_plan_read(&action_plan, &url_storage, event.type, &plan, &len))) {
+		url = url_storage_read(&url_storage, event.type);
+	}
+	if (!plan && !url) {
 		goto error;
 	}
 	if (!(pa = payload_action_new(p, event.local, event.action))) {
 		debug_describe_P("Can not create PA");
 		goto error;
 	}
-	count = ns_multi_query(p->ns, url, event.args, pa, payload_recv, payload_done);
-	if (!count) {
-		goto error;
+	/*hold one item until all targets are queued, they may finish in parallel*/
+	pa->items = 1;
+	if (plan) {
+		count = payload_send_plan(p, pa, plan, len, event.args);
+	} else {
+		count = payload_send_url(p, pa, url, event.args);
 	}
-	payload_action_set_items_items_count(pa, count);
+	debug_value(count);
+	free(plan);
 	free(url);
 	free(event.args);
-	return 1;
+	if (!planned) {
+		/*url writes leave the plan stale, the first press after them rebuilds it*/
+		action_plan_update(&action_plan, &url_storage);
+	}
+	payload_action_put(pa);
+	return count ? 1 : 0;
 error:
 	free(event.args);
+	free(plan);
 	free(url);
 	payload_action_delete(pa);
 	list_remove(p->ns_queue, 0);
 	return payload_send_ns_event(p);
 }
 
+/*value of the wheel= param, at the start of args or after a '&'*/
+static const char* ICACHE_FLASH_ATTR payload_wheel_arg(const char* args) {
+	const char* pos = args;
+	while (pos) {
+		if (!strncmp(pos, "wheel=", 6)) {
+			return pos + 6;
+		}
+		if ((pos = strchr(pos, '&'))) {
+			pos++;
+		}
+	}
+	return NULL;
+}
+
+static char* ICACHE_FLASH_ATTR payload_wheel_args(const char* args, const char* wheel, int16_t sum) {
+	struct Buffer_T buffer;
+	const char* rest;
+	uint16_t capacity;
+	uint8_t* storage;
+	if (!(rest = strchr(wheel, '&'))) {
+		rest = wheel + strlen(wheel);
+	}
+	capacity = strlen(args) + 8;
+	if (!(storage = malloc(capacity))) {
+		return NULL;
+	}
+	buffer_init(&buffer, capacity, storage);
+	while (args < wheel) {
+		buffer_write(&buffer, *args++);
+	}
+	buffer_dec(&buffer, sum);
+	buffer_puts(&buffer, rest);
+	buffer_close(&buffer);
+	return (char*)storage;
+}
+
+static uint8_t ICACHE_FLASH_ATTR payload_has_key(const char* args, const char* param) {
+	const char* pos = args;
+	const char* end;
+	uint16_t len;
+	if (!(end = strchr(param, '='))) {
+		end = param + strlen(param);
+	}
+	len = end - param;
+	while (*pos) {
+		if (!strncmp(pos, param, len) && ((pos[len] == '=') || (pos[len] == '&') || !pos[len])) {
+			return 1;
+		}
+		if (!(pos = strchr(pos, '&'))) {
+			break;
+		}
+		pos++;
+	}
+	return 0;
+}
+
+static char* ICACHE_FLASH_ATTR payload_merge_args(const char* args, const char* add, const char* key) {
+	char* merged;
+	char* pos;
+	const char* end;
+	char param[64];
+	uint16_t len;
+	if (!args || !add || !key) {
+		return NULL;
+	}
+	if (!(merged = malloc(PAYLOAD_MERGE_MAX))) {
+		return NULL;
+	}
+	strncpy(merged, args, PAYLOAD_MERGE_MAX);
+	if (merged[PAYLOAD_MERGE_MAX - 1]) {
+		goto error;
+	}
+	pos = merged + strlen(merged);
+	while (*add) {
+		if (!(end = strchr(add, '&'))) {
+			end = add + strlen(add);
+		}
+		len = end - add;
+		if (len >= sizeof(param)) {
+			goto error;
+		}
+		memcpy(param, add, len);
+		param[len] = '\0';
+		if (len && (!strncmp(param, key, strlen(key)) || !payload_has_key(merged, param))) {
+			if ((pos - merged + len + 2) > PAYLOAD_MERGE_MAX) {
+				goto error;
+			}
+			*pos++ = '&';
+			memcpy(pos, param, len + 1);
+			pos += len;
+		}
+		add = *end ? end + 1 : end;
+	}
+	return merged;
+error:
+	free(merged);
+	return NULL;
+}
+
+/*returns 1 when the new wheel event was folded into one already queued*/
+static uint8_t ICACHE_FLASH_ATTR payload_coalesce_wheel(Payload_T p, Url_Storage_Type_T type,
+		const char* args, Btn_Action_T action) {
+	Payload_Ns_Event_T event;
+	const char* delta;
+	const char* queued;
+	char* merged;
+	int16_t sum;
+	uint16_t i;
+	if (((action != BTN_ACTION_WHEEL) && (action != BTN_ACTION_WHEEL_FINAL)) ||
+		!args || !(delta = payload_wheel_arg(args))) {
+		return 0;
+	}
+	/*the head of the queue is already handed to ns*/
+	for (i = list_size(p->ns_queue); i > 1; i--) {
+		if (!list_read(p->ns_queue, i - 1, &event) || (event.type != type)) {
+			continue;
+		}
+		/*a final event closes its gesture, anything else keeps the order*/
+		if ((event.action != BTN_ACTION_WHEEL) || !event.args ||
+			!(queued = payload_wheel_arg(event.args))) {
+			return 0;
+		}
+		sum = atoi(queued) + atoi(delta);
+		if ((sum < -128) || (sum > 127)) {
+			return 0;
+		}
+		/*the newer args carry fresh battery and action, only the delta adds up*/
+		if (!(merged = payload_wheel_args(args, delta, sum))) {
+			return 0;
+		}
+		free(event.args);
+		event.args = merged;
+		event.action = action;
+		list_write(p->ns_queue, i - 1, &event);
+		return 1;
+	}
+	return 0;
+}
+
+/*returns 1 when the new event was merged into the latest queued one of its type*/
+static uint8_t ICACHE_FLASH_ATTR payload_coalesce_merge(Payload_T p, Url_Storage_Type_T type,
+		const char* args, Btn_Action_T action) {
+	Payload_Ns_Event_T event;
+	uint16_t i;
+	char* merged;
+	if (!args || !payload_merge_key[type] || !(store.merge_types & (1 << type))) {
+		return 0;
+	}
+	/*the head of the queue is already handed to ns*/
+	for (i = list_size(p->ns_queue); i > 1; i--) {
+		if (!list_read(p->ns_queue, i - 1, &event) || (event.type != type)) {
+			continue;
+		}
+		if (!event.args ||
+			(event.action == BTN_ACTION_WHEEL) ||
+			(event.action == BTN_ACTION_WHEEL_FINAL)) {
+			return 0;
+		}
+		if (!(merged = payload_merge_args(event.args, args, payload_merge_key[type]))) {
+			return 0;
+		}
+		free(event.args);
+		event.args = merged;
+		list_write(p->ns_queue, i - 1, &event);
+		return 1;
+	}
+	return 0;
+}
+
+static uint8_t ICACHE_FLASH_ATTR payload_coalesce(Payload_T p, Url_Storage_Type_T type,
+		const char* args, Btn_Action_T action) {
+	if ((action == BTN_ACTION_WHEEL) || (action == BTN_ACTION_WHEEL_FINAL)) {
+		return payload_coalesce_wheel(p, type, args, action);
+	}
+	return payload_coalesce_merge(p, type, args, action);
+}
+
 static uint8_t ICACHE_FLASH_ATTR payload_add_ns_event(Payload_T p, Url_Storage_Type_T type,
 		const char* args, Btn_Action_T action, uint8_t local) {
 	Payload_Ns_Event_T event;
 	if (!p || (type >= __URL_TYPE_MAX)) {
 		return 0;
 	}
+	if (payload_coalesce(p, type, args, action)) {
+		debug_describe_P("Event coalesced");
+		return 1;
+	}
 	if (list_size(p->ns_queue) >= 5) {
 		debug_describe_P("Exceed queue limit");
 		return 0;
@@ -710,6 +864,7 @@ static uint8_t ICACHE_FLASH_ATTR payload_add_ns_event(Payload_T p, Url_Storage_T
 	}
 	event.action = action;
 	event.local = local;
+	p->warm = 0;
 	if (!list_add(p->ns_queue, &event)) {
 		free(event.args);
 		return 0;
@@ -720,6 +875,31 @@ static uint8_t ICACHE_FLASH_ATTR payload_add_ns_event(Payload_T p, Url_Storage_T
 	return 1;
 }
 
+static uint8_t ICACHE_FLASH_ATTR payload_warm(Payload_T p) {
+	uint32_t heads[3][NS_PLAN_HEAD_SIZE / sizeof(uint32_t)];
+	uint8_t* plans[3];
+	uint16_t lens[3];
+	uint8_t i;
+	if (!p) {
+		return 0;
+	}
+	if (!ns_connected(p->ns)) {
+		/*the press that woke the device, connect once wifi is up*/
+		p->warm = 1;
+		return 1;
+	}
+	p->warm = 0;
+	/*gesture is not known yet, any of these may follow the press*/
+	for (i = 0; i < ARRAY_SIZE(heads); i++) {
+		plans[i] = (uint8_t*)heads[i];
+		lens[i] = sizeof(heads[i]);
+		if (!action_plan_head(&action_plan, &url_storage, URL_TYPE_SINGLE + i, heads[i], &lens[i])) {
+			return 0;
+		}
+	}
+	return ns_warm(p->ns, plans, lens, ARRAY_SIZE(plans));
+}
+
 static uint8_t ICACHE_FLASH_ATTR payload_local_action(Payload_T p, const char* mac, Btn_Action_T action, uint16_t value) {
 	char args[32];
 	Url_Storage_Type_T type;
@@ -735,6 +915,8 @@ static uint8_t ICACHE_FLASH_ATTR payload_local_action(Payload_T p, const char* m
 		case BTN_ACTION_WHEEL:
 		case BTN_ACTION_WHEEL_FINAL:
 			break;
+		case BTN_ACTION_PRESS:
+			return payload_warm(p);
 		default:
 			return 0;
 	}
@@ -797,7 +979,7 @@ static uint8_t ICACHE_FLASH_ATTR payload_general_action(Payload_T p, const char*
 	buffer_puts(&buffer, mac);
 	buffer_puts(&buffer, "&action=");
 	buffer_dec(&buffer, action);
-	if (action == BTN_ACTION_WHEEL) {
+	if ((action == BTN_ACTION_WHEEL) || (action == BTN_ACTION_WHEEL_FINAL)) {
 		buffer_puts(&buffer, "&wheel=");
 		buffer_dec(&buffer, (char)(value & 0xFF));
 	}
@@ -822,6 +1004,18 @@ uint8_t ICACHE_FLASH_ATTR payload_action(Payload_T p, const char* mac, Btn_Actio
 	uint8_t ret_local;
 	uint8_t ret_general;
 	uint8_t ret_udp = 0;
+	switch (action) {
+		case BTN_ACTION_SHORT:
+		case BTN_ACTION_DOUBLE:
+		case BTN_ACTION_LONG:
+		case BTN_ACTION_TOUCH:
+		case BTN_ACTION_WHEEL_FINAL:
+			trace_mark(TRACE_ACTION);
+			break;
+
+		default:
+			break;
+	}
 	ret_local = payload_local_action(p, mac, action, value);
 	//ret_udp = payload_udp_action(p, mac, action, value);
 	ret_general = payload_general_action(p, mac, action, value);
@@ -844,6 +1038,7 @@ uint8_t ICACHE_FLASH_ATTR payload_action(Payload_T p, const char* mac, Btn_Actio
 
 uint8_t ICACHE_FLASH_ATTR payload_connect(Payload_T p, uint8_t yes) {
 	Udp_Event_T event;
+	uint8_t ret_val;
 	if (!p) {
 		return 0;
 	}
@@ -855,7 +1050,11 @@ uint8_t ICACHE_FLASH_ATTR payload_connect(Payload_T p, uint8_t yes) {
 		}
 		list_clear(p->udp_events);
 	}
-	return ns_connect(p->ns, yes);
+	ret_val = ns_connect(p->ns, yes);
+	if (p->connected && p->warm) {
+		payload_warm(p);
+	}
+	return ret_val;
 }
 
 uint16_t ICACHE_FLASH_ATTR payload_size(Payload_T p) {
@@ -865,6 +1064,21 @@ uint16_t ICACHE_FLASH_ATTR payload_size(Payload_T p) {
 	return ns_size(p->ns);
 }
 
+uint16_t ICACHE_FLASH_ATTR payload_pending(Payload_T p) {
+	if (!p) {
+		return 0;
+	}
+	/*events still waiting for their turn count as well*/
+	return ns_size(p->ns) + list_size(p->ns_queue);
+}
+
+uint32_t ICACHE_FLASH_ATTR payload_rtt(Payload_T p) {
+	if (!p) {
+		return 0;
+	}
+	return p->rtt;
+}
+
 uint8_t ICACHE_FLASH_ATTR payload_connected(Payload_T p) {
 	if (!p) {
 		return 0;
@@ -0,0 +1,258 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <osapi.h>
+#include <c_types.h>
+
+#include "payload_frame.h"
+#include "debug.h"
+#include "slash.h"
+#include "rule.h"
+
+#define PAYLOAD_LEN_MAX 65535
+
+static const Rule_T payload_rule_len ICACHE_RODATA_ATTR = {
+	.type = RULE_UNSIGNED_INT,
+	.detail = {
+			.unsigned_int = {
+					.min_val = 0,
+					.max_val = PAYLOAD_LEN_MAX
+			}
+	}
+};
+
+/*collects a line up to LF in the arena, overlong lines are cut*/
+static uint8_t ICACHE_FLASH_ATTR payload_frame_line(Payload_Frame_T* frame, uint8_t** data, uint32_t* len) {
+	uint8_t* end;
+	uint32_t part;
+	uint32_t copy;
+	end = memchr(*data, '\n', *len);
+	part = end ? (uint32_t)(end - *data) : *len;
+	copy = PAYLOAD_FRAME_ARENA_SIZE - 1 - frame->fill;
+	if (copy > part) {
+		copy = part;
+	}
+	memcpy(frame->arena + frame->fill, *data, copy);
+	frame->fill += copy;
+	*data += part;
+	*len -= part;
+	if (!end) {
+		return 0;
+	}
+	(*data)++;
+	(*len)--;
+	if (frame->fill && (frame->arena[frame->fill - 1] == '\r')) {
+		frame->fill--;
+	}
+	frame->arena[frame->fill] = 0;
+	frame->fill = 0;
+	return 1;
+}
+
+/*copies up to len bytes of body into the arena, the rest is counted but dropped*/
+static uint32_t ICACHE_FLASH_ATTR payload_frame_body(Payload_Frame_T* frame, uint8_t* data, uint32_t len) {
+	uint32_t i;
+	if (len > frame->len) {
+		len = frame->len;
+	}
+	for (i = 0; i < len; i++) {
+		if (frame->escaped) {
+			frame->escaped = 0;
+		} else if (data[i] == '"') {
+			frame->quoted = !frame->quoted;
+		} else if (frame->quoted) {
+			frame->escaped = (data[i] == '\\') ? 1 : 0;
+		} else if (isspace(data[i])) {
+			continue;
+		}
+		if (frame->fill >= (PAYLOAD_FRAME_ARENA_SIZE - 1)) {
+			frame->overflow = 1;
+			continue;
+		}
+		frame->arena[frame->fill++] = data[i];
+	}
+	frame->len -= len;
+	return len;
+}
+
+/*chunk size line, hex digits with optional extension up to LF*/
+static uint8_t ICACHE_FLASH_ATTR payload_frame_chunk_size(Payload_Frame_T* frame, uint8_t c) {
+	if (c == '\n') {
+		if (!frame->digits) {
+			return 0;
+		}
+		frame->digits = 0;
+		frame->extension = 0;
+		if (!frame->len) {
+			debug_describe_P("End chunk");
+			frame->state = PAYLOAD_FRAME_DONE;
+		} else {
+			frame->state = PAYLOAD_FRAME_CHUNK_DATA;
+		}
+		return 1;
+	}
+	if (frame->extension || (c == '\r')) {
+		return 1;
+	}
+	if (!isxdigit(c)) {
+		frame->extension = 1;
+		return 1;
+	}
+	if (++frame->digits > 8) {
+		return 0;
+	}
+	frame->len = (frame->len << 4) | ((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10));
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR payload_parse_status(char* line, uint16_t* ret_code) {
+	Slash_T slash;
+	char* version;
+	char* code;
+	char* describe;
+	int32_t ret_val;
+	if (!line) {
+		return 0;
+	}
+	if (!*line) {
+		debug_describe_P("Bad status size");
+		return 0;
+	}
+	slash_init(&slash, line, ' ');
+	if (!(version = slash_next(&slash)) ||
+		!(code = slash_next(&slash)) ||
+		!(describe = slash_current(&slash))) {
+			debug_describe_P("Bad status format");
+			return 0;
+	}
+	debug_printf("Version: %s\n", version);
+	debug_printf("Code: %s\n", code);
+	debug_printf("Describe: %s\n", describe);
+	if (!rule_check_digit(code, 100, 599, &ret_val)) {
+		debug_describe_P("Bad code");
+		return 0;
+	}
+	if (code) {
+		*ret_code = ret_val;
+	}
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR payload_check_header(char* line, uint8_t* chunked, uint32_t* len) {
+	Slash_T slash;
+	char* name;
+	char* value;
+	if (!line || !*line) {
+		return 0;
+	}
+	slash_init_delimeters(&slash, line, ": ");
+	if (!(name = slash_next(&slash)) ||
+		!(value = slash_current(&slash))) {
+			debug_describe_P("Bad header format");
+			return 0;
+	}
+	if (chunked && !strcasecmp(name, "Transfer-Encoding")) {
+		if (!strcmp(value, "chunked")) {
+			*chunked = 1;
+		}
+		return 1;
+	}
+	if (len && !strcasecmp(name, "Content-Length")) {
+		Item_T item;
+		if (!rule_check(&payload_rule_len, value, &item)) {
+			debug_describe_P("Rule lenght check error");
+			return 0;
+		}
+		*len = item.data_uint32;
+		return 1;
+	}
+	return 1;
+}
+
+void ICACHE_FLASH_ATTR payload_frame_init(Payload_Frame_T* frame, char* arena) {
+	memset(frame, 0, sizeof(Payload_Frame_T));
+	frame->arena = arena;
+}
+
+/*returns 0 on a malformed response, the state is PAYLOAD_FRAME_DONE once it is complete*/
+uint8_t ICACHE_FLASH_ATTR payload_frame_feed(Payload_Frame_T* frame, uint8_t* data, uint32_t len) {
+	while (len && (frame->state != PAYLOAD_FRAME_DONE)) {
+		switch (frame->state) {
+			case PAYLOAD_FRAME_STATUS:
+				if (!payload_frame_line(frame, &data, &len)) {
+					break;
+				}
+				if (!payload_parse_status(frame->arena, &frame->code)) {
+					return 0;
+				}
+				frame->state = PAYLOAD_FRAME_HEADER;
+				break;
+			case PAYLOAD_FRAME_HEADER:
+				if (!payload_frame_line(frame, &data, &len)) {
+					break;
+				}
+				if (*frame->arena) {
+					debug_printf("Header: %s\n", frame->arena);
+					if (!payload_check_header(frame->arena, &frame->chunked, &frame->len)) {
+						debug_describe_P("Bad header");
+						return 0;
+					}
+					break;
+				}
+				debug_describe_P("Body");
+				if (frame->chunked) {
+					if (frame->len) {
+						return 0;
+					}
+					frame->state = PAYLOAD_FRAME_CHUNK_SIZE;
+				} else {
+					frame->state = frame->len ? PAYLOAD_FRAME_BODY : PAYLOAD_FRAME_DONE;
+				}
+				break;
+			case PAYLOAD_FRAME_BODY:
+			case PAYLOAD_FRAME_CHUNK_DATA: {
+				uint32_t part = payload_frame_body(frame, data, len);
+				data += part;
+				len -= part;
+				if (!frame->len) {
+					frame->state = (frame->state == PAYLOAD_FRAME_BODY) ? PAYLOAD_FRAME_DONE : PAYLOAD_FRAME_CHUNK_END;
+				}
+				break;
+			}
+			case PAYLOAD_FRAME_CHUNK_SIZE:
+				if (!payload_frame_chunk_size(frame, *data)) {
+					debug_describe_P("Rule chunk len check error");
+					return 0;
+				}
+				data++;
+				len--;
+				break;
+			case PAYLOAD_FRAME_CHUNK_END:
+				if (*data == '\n') {
+					frame->state = PAYLOAD_FRAME_CHUNK_SIZE;
+				} else if (*data != '\r') {
+					return 0;
+				}
+				data++;
+				len--;
+				break;
+			default:
+				return 0;
+		}
+	}
+	return 1;
+}
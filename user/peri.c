@@ -23,6 +23,7 @@
 #include <ets_sys.h>
 #include <c_types.h>
 #include "peri.h"
+#include "peri_btn.h"
 #include "queue.h"
 #include "pin.h"
 #include "debug.h"
@@ -33,6 +34,7 @@
 #include "rtc.h"
 #include "url_storage.h"
 #include "rgb.h"
+#include "trace.h"
 #ifdef IQS
 #include "i2c.h"
 #include "IQS333.h"
@@ -54,11 +56,16 @@
 #define BATTERY_MIN 3700
 #endif
 
-#define BTN_PERIOD_DEBOUNCE (1)
-#define BTN_PERIOD_SHORT (400)
-#define BTN_PERIOD_LONG (1000)
-#define BTN_PERIOD_SERVICE (5000)
-#define BTN_PERIOD_RESET (10000)
+/*led patterns step every tick*/
+#define PERI_LED_TICK_MS (25)
+
+#ifndef IQS
+/*led duty is 12 bit, one pwm frame per ms*/
+#define PWM_DUTY_SHIFT (12)
+#define PWM_FRAME_US (1000)
+/*shortest one shot the nmi timer can take*/
+#define PWM_MIN_US (10)
+#endif
 
 enum {
 	LED_R = 0,
@@ -84,7 +91,11 @@ static uint8_t peri_charge = 0;
 static uint8_t peri_btn_press_on_start = 0;
 static uint8_t peri_white_enabled = 0;
 static uint8_t peri_white_locked = 0;
-static uint16_t peri_btn_was_pressed = 0;
+/*written by the gpio isr, consumed by the button clock*/
+static volatile uint8_t peri_btn_edge = 0;
+static volatile uint32_t peri_btn_edge_time = 0;
+static uint8_t peri_btn_force = 0;
+static Peri_Btn_T peri_btn;
 #ifdef IQS
 static struct I2C_T i2c;
 static Queue_T queue = NULL;
@@ -182,116 +193,101 @@ static const I2C_Inh_T i2c_inh = {
 };
 #endif
 
-static void peri_btn_action(Btn_Action_T action) {
+static void ICACHE_FLASH_ATTR peri_btn_action(Btn_Action_T action) {
 	if (peri_btn_event_fn) {
 		peri_btn_event_fn(action);
 	}
 }
 
-static uint8_t peri_btn_pin_get(void) {
-	static uint8_t reset = 0;
-	static uint8_t ret_val = 0;
-	if (peri_btn_was_pressed) {
-		peri_btn_was_pressed--;
-		return 0;
+static void ICACHE_FLASH_ATTR peri_check_button(void) {
+	uint32_t now = system_get_time();
+	#ifdef IQS
+	/*no gpio interrupt next to the i2c lines, the ms clock samples the pin*/
+	if (!peri_btn_edge && (pin_get(BTN_GPIO) != peri_btn.level)) {
+		peri_btn_edge_time = now;
+		peri_btn_edge = 1;
 	}
-	if (!reset) {
-		ret_val = pin_get(BTN_GPIO);
+	#endif
+	if (peri_btn_edge && ((now - peri_btn_edge_time) >= (BTN_PERIOD_DEBOUNCE * 1000))) {
+		if (peri_btn_force) {
+			/*pressed before boot, read the real level once debounced*/
+			peri_btn_force = 0;
+			peri_btn_gesture(&peri_btn, 0, peri_btn_edge_time);
+			peri_btn_edge_time = now;
+		} else {
+			peri_btn_edge = 0;
+			peri_btn_gesture(&peri_btn, pin_get(BTN_GPIO), peri_btn_edge_time);
+		}
+	}
+	if (peri_btn_pending(&peri_btn)) {
+		peri_btn_timeout(&peri_btn, now);
 	}
-	pin_set(BTN_GPIO, reset);
-	reset = 1 - reset;
-	return ret_val;
 }
 
-static void peri_check_button(void) {
-	static uint32_t press_period = 0;
-	static uint32_t release_period = 0;
-	static uint32_t debounce_cunter = 0;
-	static uint32_t last = 1;
-	static uint32_t wait_next = 0;
-	uint32_t cur;
+#ifndef IQS
+/*an edge is pending or the gesture still runs on the clock*/
+static uint8_t ICACHE_FLASH_ATTR peri_btn_busy(void) {
+	return peri_btn_edge || peri_btn_force || peri_btn_pending(&peri_btn);
+}
 
-	cur = peri_btn_pin_get();
-	if (cur != last) {
-		debounce_cunter = 0;
+/*other pins keep their status bits for their own handlers*/
+static void peri_btn_isr(void* arg) {
+	uint32_t status = GPIO_REG_READ(GPIO_STATUS_ADDRESS);
+	if (!(status & BIT(BTN_GPIO))) {
+		return;
 	}
-	last = cur;
-	if (debounce_cunter < (BTN_PERIOD_DEBOUNCE - 1)) {
-		debounce_cunter++;
-		if (debounce_cunter < (BTN_PERIOD_DEBOUNCE - 1)) {
-			return;
-		}
-	}
-	if (cur) {
-		/*release*/
-		if (press_period) {
-			peri_btn_action(BTN_ACTION_RELEASE);
-			if (press_period < BTN_PERIOD_LONG) {
-				/*short press wait for next press*/
-				if (wait_next) {
-					/*double short press*/
-					peri_btn_action(BTN_ACTION_DOUBLE);
-					wait_next = 0;
-				} else {
-					wait_next = 1;
-				}
-			} else {
-				wait_next = 0;
-			}
-			if ((press_period >= BTN_PERIOD_SERVICE) &&
-				(press_period <= (BTN_PERIOD_SERVICE + 2500))) {
-				peri_btn_action(BTN_ACTION_SERVICE);
-			}
-		}
-		if (wait_next) {
-			if (release_period >= BTN_PERIOD_SHORT) {
-				/*single short press*/
-				peri_btn_action(BTN_ACTION_SHORT);
-				wait_next = 0;
-			}
-		}
-		if (release_period < 0xFFFFFFFF) {
-			release_period++;
-		}
-		press_period = 0;
-	} else {
-		/*press*/
-		if (!press_period) {
-			peri_btn_action(BTN_ACTION_PRESS);
-		} else {
-			if (press_period == BTN_PERIOD_LONG) {
-				peri_btn_action(BTN_ACTION_LONG);
-			}
-			if (press_period == BTN_PERIOD_RESET) {
-				peri_btn_action(BTN_ACTION_RESET);
-			}
-		}
-		if (wait_next) {
-			if (press_period >= BTN_PERIOD_LONG) {
-				peri_btn_action(BTN_ACTION_SHORT);
-				wait_next = 0;
-			}
-		}
-		if (press_period < 0xFFFFFFFF) {
-			press_period++;
-		}
-		release_period = 0;
+	GPIO_REG_WRITE(GPIO_STATUS_W1TC_ADDRESS, BIT(BTN_GPIO));
+	if (!peri_btn_edge) {
+		peri_btn_edge_time = system_get_time();
+		peri_btn_edge = 1;
 	}
 }
+#endif
 
 static void ICACHE_FLASH_ATTR peri_btn_event(uint32_t period) {
 	debug_printf("BTN press, period %u\n", period);
 }
 
+#ifndef IQS
+static uint16_t peri_pwm_edge(uint16_t duty) {
+	uint32_t edge;
+	if (!duty) {
+		return 0;
+	}
+	edge = ((uint32_t)duty * PWM_FRAME_US) >> PWM_DUTY_SHIFT;
+	if (edge < PWM_MIN_US) {
+		return PWM_MIN_US;
+	}
+	if (edge > (PWM_FRAME_US - PWM_MIN_US)) {
+		/*never switched off within the frame*/
+		return PWM_FRAME_US;
+	}
+	return edge;
+}
+#endif
+
 static void peri_tick_clk(void) {
 	#ifndef IQS
-	static uint32_t counter = 0;
-	static uint32_t div = 0;
-	if (!peri_pwm_lock) {
-		pin_set(LED_R_GPIO, (counter >= peri_pwm_duty[PWM_R_CH]) ? 1 : 0);
-		pin_set(LED_W_GPIO, (counter >= peri_pwm_duty[PWM_W_CH]) ? 1 : 0);
-		pin_set(LED_G_ACU_GPIO, (counter >= peri_pwm_duty[PWM_G_CH]) ? 1 : 0);
-		if (!peri_pwm_duty[2]) {
+	/*one shot timer scheduled to the next led edge instead of a fixed 50 us tick*/
+	static const uint8_t gpio[PERI_LED_COUNT] = {
+		[PWM_R_CH] = LED_R_GPIO,
+		[PWM_W_CH] = LED_W_GPIO,
+		[PWM_G_CH] = LED_G_ACU_GPIO
+	};
+	static uint16_t edge[PERI_LED_COUNT] = {0, 0, 0};
+	static uint16_t elapsed = 0;
+	uint16_t next = PWM_FRAME_US;
+	uint8_t i;
+	if (!elapsed) {
+		if (!peri_pwm_lock) {
+			for (i = 0; i < PERI_LED_COUNT; i++) {
+				edge[i] = peri_pwm_edge(peri_pwm_duty[i]);
+			}
+		}
+		for (i = 0; i < PERI_LED_COUNT; i++) {
+			pin_set(gpio[i], edge[i] ? 0 : 1);
+		}
+		if (!edge[PWM_G_CH]) {
 			/*pin set to logic one*/
 			/*check pin status*/
 			if (!pin_get(LED_G_ACU_GPIO)) {
@@ -300,33 +296,53 @@ static void peri_tick_clk(void) {
 				peri_charge = 0;
 			}
 		}
-		counter++;
-		counter %= PWM_LEVELS;
-	}
-	if (!div) {
 		timer_ticks++;
-		peri_check_button();
+	} else {
+		for (i = 0; i < PERI_LED_COUNT; i++) {
+			if (edge[i] && (edge[i] < (elapsed + PWM_MIN_US))) {
+				pin_set(gpio[i], 1);
+			}
+		}
 	}
-	div++;
-	div %= 20;
+	for (i = 0; i < PERI_LED_COUNT; i++) {
+		if ((edge[i] >= (elapsed + PWM_MIN_US)) && (edge[i] < next)) {
+			next = edge[i];
+		}
+	}
+	hw_timer_arm(next - elapsed);
+	elapsed = (next < PWM_FRAME_US) ? next : 0;
 	#else
 	timer_ticks++;
 	#endif
 }
 
+/*button events are raised here and not from the nmi tick, so callbacks may arm os timers*/
 static void ICACHE_FLASH_ATTR peri_clk(void* owner) {
-	static uint16_t div = 0;
-	if (!div) {
+	static uint32_t led_time = 0;
+	#ifndef IQS
+	uint32_t elapsed;
+	#endif
+	uint32_t wait = 1;
+	if ((system_get_time() - led_time) >= (PERI_LED_TICK_MS * 1000)) {
+		led_time = system_get_time();
 		peri_led_clk(owner);
 	}
-	div++;
-	div %= 25;
 	#ifdef IQS
+	/*i2c orders are clocked every ms*/
 	peri_i2c_clk(owner);
+	#else
+	peri_check_button();
+	if (!peri_btn_busy()) {
+		/*idle button, sleep to the next led tick*/
+		elapsed = (system_get_time() - led_time) / 1000;
+		if (elapsed < PERI_LED_TICK_MS) {
+			wait = PERI_LED_TICK_MS - elapsed;
+		}
+	}
 	#endif
 	os_timer_disarm(&rdy_timer);
 	os_timer_setfn(&rdy_timer, peri_clk, NULL);
-	os_timer_arm(&rdy_timer, 1, 0);
+	os_timer_arm(&rdy_timer, wait, 0);
 }
 
 static void ICACHE_FLASH_ATTR peri_led_clk(void* owner) {
@@ -339,7 +355,9 @@ static void ICACHE_FLASH_ATTR peri_led_clk(void* owner) {
 	uint8_t set_any = 0;
 	for (i = 0; i < ARRAY_SIZE(rgb_leds); i++) {
 		set_any |= led_clk(&rgb_leds[i], &set_val[i]);
+		#ifdef IQS
 		set_val[i] /= 128;
+		#endif
 	}
 	if (set_any) {
 		/*os_printf_plus("%u,%u,%u\n", (uint32_t)set_val[0], (uint32_t)set_val[1], (uint32_t)set_val[2]);*/
@@ -611,6 +629,7 @@ void ICACHE_FLASH_ATTR peri_set_is_charge_cb(void (*charge_event)(uint8_t is_cha
 
 void ICACHE_FLASH_ATTR peri_pre_init(void) {
 	RTC_GPIO_T rtc_gpio;
+	trace_mark(TRACE_WAKE);
 	//pin_init(BTN_GPIO, PIN_MODE_IN, PIN_OTYPE_PP, PIN_PUPD_NOPULL, 0);
 	pin_init(BTN_GPIO, PIN_MODE_OUT, PIN_OTYPE_OD, PIN_PUPD_NOPULL, 1);
 	if (!pin_get(BTN_GPIO)) {
@@ -630,7 +649,6 @@ uint8_t ICACHE_FLASH_ATTR peri_init(void) {
 	uint32_t magic;
 	uint8_t i;
 	peri_pre_init();
-	peri_btn_was_pressed = peri_btn_press_on_start ? BTN_PERIOD_DEBOUNCE : 0;
 	for (i = 0; i < ARRAY_SIZE(rgb_leds); i++) {
 		led_init(&rgb_leds[i], i);
 	}
@@ -646,13 +664,15 @@ uint8_t ICACHE_FLASH_ATTR peri_init(void) {
 	if (magic == RTC_MAGIC) {
 		event_mode = 1;
 	}
-	hw_timer_init(NMI_SOURCE, 1);
 	hw_timer_set_func(peri_tick_clk);
 
 #ifdef IQS
+	hw_timer_init(NMI_SOURCE, 1);
 	hw_timer_arm(1000);
 #else
-	hw_timer_arm(50);
+	/*peri_tick_clk rearms for every led edge, at least once per ms*/
+	hw_timer_init(NMI_SOURCE, 0);
+	hw_timer_arm(PWM_FRAME_US);
 #endif
 
 #ifdef IQS
@@ -664,6 +684,20 @@ uint8_t ICACHE_FLASH_ATTR peri_init(void) {
 	pin_init(LED_W_GPIO, PIN_MODE_OUT, PIN_OTYPE_PP, PIN_PUPD_NOPULL, 1);
 	pin_init(LED_G_ACU_GPIO, PIN_MODE_OUT, PIN_OTYPE_OD, PIN_PUPD_NOPULL, 1);
 #endif
+	peri_btn_init(&peri_btn, peri_btn_action);
+	if (peri_btn_press_on_start) {
+		peri_btn_force = 1;
+		peri_btn_edge_time = system_get_time();
+		peri_btn_edge = 1;
+	}
+#ifndef IQS
+	/*button stays released, edges are timestamped in peri_btn_isr*/
+	ETS_GPIO_INTR_DISABLE();
+	ETS_GPIO_INTR_ATTACH(peri_btn_isr, NULL);
+	gpio_pin_intr_state_set(GPIO_ID_PIN(BTN_GPIO), GPIO_PIN_INTR_ANYEDGE);
+	GPIO_REG_WRITE(GPIO_STATUS_W1TC_ADDRESS, BIT(BTN_GPIO));
+	ETS_GPIO_INTR_ENABLE();
+#endif
 
 	os_timer_disarm(&rdy_timer);
 	os_timer_setfn(&rdy_timer, peri_clk, NULL);
@@ -683,6 +717,9 @@ static void ICACHE_FLASH_ATTR hw_timer_deinit(void) {
 void ICACHE_FLASH_ATTR peri_deinit(void) {
 	hw_timer_deinit();
 	os_timer_disarm(&rdy_timer);
+	#ifndef IQS
+	gpio_pin_intr_state_set(GPIO_ID_PIN(BTN_GPIO), GPIO_PIN_INTR_DISABLE);
+	#endif
 	#ifdef IQS
 	if (queue) {
 		I2C_Order_T item;
@@ -0,0 +1,98 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <string.h>
+#include <osapi.h>
+#include <c_types.h>
+
+#include "peri_btn.h"
+
+static void ICACHE_FLASH_ATTR peri_btn_action(Peri_Btn_T* btn, Btn_Action_T action) {
+	if (btn->action) {
+		btn->action(action);
+	}
+}
+
+void ICACHE_FLASH_ATTR peri_btn_init(Peri_Btn_T* btn, void (*action)(Btn_Action_T action)) {
+	memset(btn, 0, sizeof(*btn));
+	btn->action = action;
+	btn->level = 1;
+}
+
+/*gestures are classified from edge timestamps in us, periods are in ms*/
+void ICACHE_FLASH_ATTR peri_btn_gesture(Peri_Btn_T* btn, uint8_t level, uint32_t time) {
+	uint32_t period;
+	level = level ? 1 : 0;
+	if (level == btn->level) {
+		return;
+	}
+	btn->level = level;
+	if (level) {
+		/*release*/
+		period = time - btn->press_time;
+		peri_btn_action(btn, BTN_ACTION_RELEASE);
+		if (period < (BTN_PERIOD_LONG * 1000)) {
+			/*short press wait for next press*/
+			if (btn->wait_next) {
+				/*double short press*/
+				peri_btn_action(btn, BTN_ACTION_DOUBLE);
+				btn->wait_next = 0;
+			} else {
+				btn->wait_next = 1;
+			}
+		} else {
+			btn->wait_next = 0;
+		}
+		if ((period >= (BTN_PERIOD_SERVICE * 1000)) &&
+			(period <= ((BTN_PERIOD_SERVICE + 2500) * 1000))) {
+			peri_btn_action(btn, BTN_ACTION_SERVICE);
+		}
+		btn->release_time = time;
+	} else {
+		/*press*/
+		btn->press_time = time;
+		btn->held_long = 0;
+		btn->held_reset = 0;
+		peri_btn_action(btn, BTN_ACTION_PRESS);
+	}
+}
+
+void ICACHE_FLASH_ATTR peri_btn_timeout(Peri_Btn_T* btn, uint32_t now) {
+	uint32_t period;
+	if (!btn->level) {
+		period = now - btn->press_time;
+		if (!btn->held_long && (period >= (BTN_PERIOD_LONG * 1000))) {
+			btn->held_long = 1;
+			peri_btn_action(btn, BTN_ACTION_LONG);
+		}
+		if (!btn->held_reset && (period >= (BTN_PERIOD_RESET * 1000))) {
+			btn->held_reset = 1;
+			peri_btn_action(btn, BTN_ACTION_RESET);
+		}
+		if (btn->wait_next && (period >= (BTN_PERIOD_LONG * 1000))) {
+			peri_btn_action(btn, BTN_ACTION_SHORT);
+			btn->wait_next = 0;
+		}
+	} else if (btn->wait_next) {
+		if ((now - btn->release_time) >= (BTN_PERIOD_SHORT * 1000)) {
+			/*single short press*/
+			peri_btn_action(btn, BTN_ACTION_SHORT);
+			btn->wait_next = 0;
+		}
+	}
+}
+
+/*held or waiting for a second press, peri_btn_timeout still has to run*/
+uint8_t ICACHE_FLASH_ATTR peri_btn_pending(Peri_Btn_T* btn) {
+	return !btn->level || btn->wait_next;
+}
@@ -0,0 +1,78 @@
+// Copyright 2016-2019 myStrom AG
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <string.h>
+#include <osapi.h>
+#include <c_types.h>
+
+#include "user_config.h"
+#include "peri_wheel.h"
+
+void ICACHE_FLASH_ATTR peri_wheel_init(Peri_Wheel_T* wheel) {
+	memset(wheel, 0, sizeof(*wheel));
+}
+
+/*motion during a request in flight is summed and sent next*/
+void ICACHE_FLASH_ATTR peri_wheel_add(Peri_Wheel_T* wheel, uint16_t count, int16_t diff) {
+	wheel->count += count;
+	wheel->diff += diff;
+}
+
+/*motion under a step stays for the next one*/
+uint8_t ICACHE_FLASH_ATTR peri_wheel_pending(Peri_Wheel_T* wheel) {
+	return ((wheel->diff <= -16) || (wheel->diff >= 16)) ? 1 : 0;
+}
+
+/*encodes as much of the accumulated motion as one event carries*/
+uint16_t ICACHE_FLASH_ATTR peri_wheel_take(Peri_Wheel_T* wheel) {
+	int32_t diff;
+	uint32_t count;
+	count = wheel->count / 16;
+	if (count > 255) {
+		count = 255;
+	}
+	diff = -wheel->diff / 16;
+	if (diff > 127) {
+		diff = 127;
+	} else {
+		if (diff < -127) {
+			diff = -127;
+		}
+	}
+	wheel->count = 0;
+	wheel->diff += diff * 16;
+	return (count << 8) | (diff & 0xFF);
+}
+
+uint16_t ICACHE_FLASH_ATTR peri_wheel_send(Peri_Wheel_T* wheel, uint32_t now) {
+	wheel->sent = now;
+	return peri_wheel_take(wheel);
+}
+
+/*ms between sends, rtt of the target in ms stretches it when adaptive, 0 keeps the minimum*/
+uint32_t ICACHE_FLASH_ATTR peri_wheel_pace(uint32_t rtt) {
+	uint32_t pace = WHEEL_MIN_INTERVAL;
+	if (rtt > pace) {
+		pace = rtt;
+	}
+	if (pace > WHEEL_MAX_INTERVAL) {
+		pace = WHEEL_MAX_INTERVAL;
+	}
+	return pace;
+}
+
+/*ms until the next send is paced, 0 when due, now in us*/
+uint32_t ICACHE_FLASH_ATTR peri_wheel_wait(Peri_Wheel_T* wheel, uint32_t now, uint32_t pace) {
+	uint32_t elapsed = (now - wheel->sent) / 1000;
+	return (elapsed < pace) ? (pace - elapsed) : 0;
+}
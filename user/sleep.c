@@ -32,9 +32,14 @@
 
 #define SLEEP_US_BASE ((uint32_t)1000000)
 #define MIN_SLEEP_TIME 10
+/*without RTC calibration*/
 #define MAX_SLEEP_PERIOD 3600
+/*deep sleep takes at most 2^31 RTC ticks, part left for clock drift*/
+#define SLEEP_MAX_TICKS ((uint32_t)0x78000000)
+/*wake this close to periodic report counts as the report*/
+#define SLEEP_WAKE_MARGIN 10
 
-static RWC_T wc = {0, 0, 0, 0};
+static RWC_T wc = {0, 0, 0, 0, 0, 0, 0};
 static os_timer_t sleep_timer;
 static os_timer_t work_timer;
 static uint32_t sleep_cause = 0;
@@ -46,16 +51,48 @@ static uint32_t sleep_time_to = 0;
 static uint32_t inhibit_time = 0;
 static uint8_t inhibit_count = 0;
 static uint8_t restart_req = 0;
+static uint8_t wc_pass = 0;
 
 static void ICACHE_FLASH_ATTR sleep_inc_worktime(void* owner) {
 	working_time++;
 }
 
+/*cali is RTC tick period in us with 12 fractional bits*/
+static uint32_t ICACHE_FLASH_ATTR sleep_max_period(uint32_t cali) {
+	if (!cali) {
+		return MAX_SLEEP_PERIOD;
+	}
+	return (((uint64_t)SLEEP_MAX_TICKS * cali) >> 12) / SLEEP_US_BASE;
+}
+
+/*time really spent in deep sleep, RTC counter keeps running over it*/
+static uint32_t ICACHE_FLASH_ATTR sleep_wc_slept(void) {
+	uint32_t slept;
+	if (!wc.rtc_cali) {
+		return wc.sleep_period;
+	}
+	/*rounded, truncating lost half a second on every wake*/
+	slept = ((((uint64_t)(system_get_rtc_time() - wc.rtc_ticks) * wc.rtc_cali) >> 12) + SLEEP_US_BASE / 2) / SLEEP_US_BASE;
+	/*counter was reset*/
+	if ((slept < (wc.sleep_period - wc.sleep_period / 8)) || (slept > (wc.sleep_period + wc.sleep_period / 8))) {
+		return wc.sleep_period;
+	}
+	return slept;
+}
+
+static void ICACHE_FLASH_ATTR sleep_wc_drift(uint32_t slept) {
+	wc.drift += (int32_t)(slept - wc.sleep_period);
+	debug_value(wc.drift);
+}
+
 /*return sleep period*/
 static uint32_t ICACHE_FLASH_ATTR sleep_wc_save(void) {
 	uint32_t time_from_begin;
 	uint32_t time_to_wakeup;
+	uint32_t max_period;
 
+	wc.rtc_cali = system_rtc_clock_cali_proc();
+	max_period = sleep_max_period(wc.rtc_cali);
 	wc.sleep_timestamp = sleep_get_current_timestamp();
 	if (!wc.begin_timestamp) {
 		wc.begin_timestamp = wc.sleep_timestamp;
@@ -73,8 +110,8 @@ static uint32_t ICACHE_FLASH_ATTR sleep_wc_save(void) {
 	} else {
 		time_to_wakeup = (uint32_t)WAKEUP_PERIOD_S - time_from_begin;
 		debug_value(time_to_wakeup);
-		if (time_to_wakeup >= MAX_SLEEP_PERIOD) {
-			wc.sleep_period = MAX_SLEEP_PERIOD;
+		if (time_to_wakeup >= max_period) {
+			wc.sleep_period = max_period;
 		} else {
 			if (time_to_wakeup < MIN_SLEEP_TIME) {
 				wc.sleep_period = MIN_SLEEP_TIME;
@@ -83,6 +120,7 @@ static uint32_t ICACHE_FLASH_ATTR sleep_wc_save(void) {
 			}
 		}
 	}
+	wc.rtc_ticks = system_get_rtc_time();
 	if (rtc_write(RTC_WC_OFFSET, &wc, sizeof(wc))) {
 		debug_describe_P("WC save");
 	}
@@ -104,7 +142,7 @@ static void ICACHE_FLASH_ATTR sleep_iqs_power_done(I2C_Order_T order, I2C_Result
 	system_deep_sleep_set_option(2);
 	if (wifi_is_save()) {
 		//system_deep_sleep(SLEEP_US_BASE * 60);
-		system_deep_sleep(SLEEP_US_BASE * sleep_wc_save());
+		system_deep_sleep((uint64_t)SLEEP_US_BASE * sleep_wc_save());
 	} else {
 		system_deep_sleep(0);
 	}
@@ -148,7 +186,7 @@ static void ICACHE_FLASH_ATTR sleep_task(void* owner) {
 	if (!restart_req) {
 		system_deep_sleep_set_option(2);
 		if (wifi_is_save()) {
-			system_deep_sleep(SLEEP_US_BASE * sleep_wc_save());
+			system_deep_sleep((uint64_t)SLEEP_US_BASE * sleep_wc_save());
 		} else {
 			system_deep_sleep(0);
 		}
@@ -204,12 +242,46 @@ void ICACHE_FLASH_ATTR sleep_set_time_to_sleep(uint32_t time_to_sleep) {
 	sleep_time_to = time_to_sleep;
 }
 
+/*call from user_rf_pre_init, timer wake before periodic report runs without RF*/
+uint8_t ICACHE_FLASH_ATTR sleep_wc_pre_init(void) {
+	if (peri_hold_on_start() || (peri_rst_reason() != REASON_DEEP_SLEEP_AWAKE)) {
+		return 0;
+	}
+	if (!rtc_read(RTC_WC_OFFSET, &wc, sizeof(wc))) {
+		return 0;
+	}
+	if ((wc.sleep_timestamp + sleep_wc_slept() + SLEEP_WAKE_MARGIN - wc.begin_timestamp) >= WAKEUP_PERIOD_S) {
+		return 0;
+	}
+	system_phy_set_rfoption(4);
+	wc_pass = 1;
+	return 1;
+}
+
+/*call first in user_init, return 1 when wake went back to sleep*/
+uint8_t ICACHE_FLASH_ATTR sleep_wc_pass(void) {
+	uint32_t slept;
+	if (!wc_pass) {
+		return 0;
+	}
+	slept = sleep_wc_slept();
+	sleep_wc_drift(slept);
+	sleep_update_timestamp(wc.sleep_timestamp + slept);
+	system_deep_sleep_set_option(2);
+	system_deep_sleep((uint64_t)SLEEP_US_BASE * sleep_wc_save());
+	return 1;
+}
+
 uint8_t ICACHE_FLASH_ATTR sleep_wc_event(uint8_t timer) {
+	uint32_t slept;
 	uint8_t ret_val = 0;
 	if (timer) {
-		sleep_update_timestamp(sleep_get_current_timestamp() + wc.sleep_period);
+		slept = sleep_wc_slept();
+		sleep_wc_drift(slept);
+		sleep_update_timestamp(sleep_get_current_timestamp() + slept);
 		if (sleep_get_current_timestamp() >= wc.begin_timestamp) {
-			if ((sleep_get_current_timestamp() - wc.begin_timestamp) >= WAKEUP_PERIOD_S) {
+			/*same margin as sleep_wc_pre_init, a wake it let through must report*/
+			if ((sleep_get_current_timestamp() + SLEEP_WAKE_MARGIN - wc.begin_timestamp) >= WAKEUP_PERIOD_S) {
 				wc.begin_timestamp = sleep_get_current_timestamp();
 				ret_val = 1;
 			}
@@ -20,23 +20,51 @@
 #include <user_interface.h>
 #include "url_storage.h"
 #include "crc.h"
+#include "rtc.h"
+#include "array_size.h"
 #include "debug.h"
 
 #define URL_CRC_POLY 0x741B8CD7
+#define URL_BLOCK_SIZE 256
 
-static uint8_t ICACHE_FLASH_ATTR url_storage_check_crc(Url_Storage_T* url, uint32_t stored_crc, uint32_t sector) {
+/*crc over the sector behind the crc word read in blocks, lengths of the*/
+/*stored strings are counted on the way*/
+static uint8_t ICACHE_FLASH_ATTR url_storage_check_crc(Url_Storage_T* url, uint32_t stored_crc, uint32_t sector, uint16_t* len) {
+	uint32_t block[URL_BLOCK_SIZE / sizeof(uint32_t)];
+	uint8_t done[__URL_TYPE_MAX];
+	const uint8_t* data;
 	Crc_T crc;
-	uint32_t value;
+	uint32_t offset;
+	uint32_t type;
 	uint32_t i;
-	if (!url) {
+	uint32_t j;
+	if (!url || !len) {
 		return 0;
 	}
+	memset(done, 0, sizeof(done));
+	memset(len, 0, sizeof(uint16_t) * __URL_TYPE_MAX);
 	crc_init(&crc, URL_CRC_POLY, 0);
-	for (i = 1; i < (SPI_FLASH_SEC_SIZE / sizeof(value)); i++) {
-		if (spi_flash_read((sector * SPI_FLASH_SEC_SIZE) + (i * sizeof(value)), &value, sizeof(value)) != SPI_FLASH_RESULT_OK) {
+	for (offset = 0; offset < SPI_FLASH_SEC_SIZE; offset += sizeof(block)) {
+		if (spi_flash_read((sector * SPI_FLASH_SEC_SIZE) + offset, block, sizeof(block)) != SPI_FLASH_RESULT_OK) {
 			return 0;
 		}
-		crc_calculate(&crc, value);
+		i = offset ? 0 : 1;
+		crc_check_words(&crc, &block[i], ARRAY_SIZE(block) - i);
+		data = (const uint8_t*)block;
+		for (j = 0; j < sizeof(block); j++) {
+			if ((offset + j) < sizeof(Url_Storage_Herader_T)) {
+				continue;
+			}
+			type = (offset + j - sizeof(Url_Storage_Herader_T)) / URL_MAX_SIZE;
+			if ((type >= __URL_TYPE_MAX) || done[type]) {
+				continue;
+			}
+			if (!data[j] || (data[j] == 0xFF)) {
+				done[type] = 1;
+			} else {
+				len[type]++;
+			}
+		}
 	}
 	if ((crc_last(&crc) & 0xFFFFFFFF) != stored_crc) {
 		return 0;
@@ -44,27 +72,113 @@ static uint8_t ICACHE_FLASH_ATTR url_storage_check_crc(Url_Storage_T* url, uint3
 	return 1;
 }
 
-static uint8_t ICACHE_FLASH_ATTR url_storage_get_write_sector(Url_Storage_T* url, uint32_t* sector, uint32_t* counter) {
+static uint8_t ICACHE_FLASH_ATTR url_storage_read_headers(Url_Storage_T* url, Url_Storage_Herader_T* header) {
+	uint32_t i;
+	for (i = 0; i < 2; i++) {
+		if (spi_flash_read((url->base_sector + i) * SPI_FLASH_SEC_SIZE, (uint32_t*)&header[i], sizeof(Url_Storage_Herader_T)) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*index kept over deep sleep, trusted while both headers are unchanged*/
+static uint8_t ICACHE_FLASH_ATTR url_storage_index_restore(Url_Storage_T* url) {
 	Url_Storage_Herader_T header[2];
+	RTC_URL_T rtc;
 	uint32_t i;
-	uint8_t valid[2] = {0, 0};
-	if (!url || !sector || !counter) {
+	if (!rtc_read(RTC_URL_OFFSET, &rtc, sizeof(rtc))) {
+		return 0;
+	}
+	if (!url_storage_read_headers(url, header)) {
 		return 0;
 	}
 	for (i = 0; i < 2; i++) {
-		if (spi_flash_read((url->base_sector + i) * SPI_FLASH_SEC_SIZE, (uint32_t*)&header[i], sizeof(Url_Storage_Herader_T)) != SPI_FLASH_RESULT_OK) {
+		if ((header[i].crc != rtc.crc[i]) || (header[i].counter != rtc.counter[i])) {
 			return 0;
 		}
-		valid[i] = url_storage_check_crc(url, header[i].crc, url->base_sector + i);
-		debug_value(valid[i]);
 	}
-	if (!valid[0] || !valid[1]) {
-		if (!valid[0] && !valid[1]) {
+	memcpy(url->index.header, header, sizeof(header));
+	memcpy(url->index.len, rtc.len, sizeof(url->index.len));
+	url->index.valid = rtc.valid;
+	url->index.sector = rtc.sector;
+	return 1;
+}
+
+static void ICACHE_FLASH_ATTR url_storage_index_save(Url_Storage_T* url) {
+	RTC_URL_T rtc;
+	uint32_t i;
+	memset(&rtc, 0, sizeof(rtc));
+	for (i = 0; i < 2; i++) {
+		rtc.crc[i] = url->index.header[i].crc;
+		rtc.counter[i] = url->index.header[i].counter;
+	}
+	memcpy(rtc.len, url->index.len, sizeof(url->index.len));
+	rtc.valid = url->index.valid;
+	rtc.sector = url->index.sector;
+	rtc_write(RTC_URL_OFFSET, &rtc, sizeof(rtc));
+}
+
+static void ICACHE_FLASH_ATTR url_storage_index_drop(Url_Storage_T* url) {
+	RTC_URL_T rtc;
+	url->indexed = 0;
+	rtc_erase(RTC_URL_OFFSET, &rtc, sizeof(rtc));
+}
+
+static uint8_t ICACHE_FLASH_ATTR url_storage_index(Url_Storage_T* url) {
+	uint16_t len[2][__URL_TYPE_MAX];
+	Url_Storage_Index_T* index;
+	uint32_t i;
+	if (!url) {
+		return 0;
+	}
+	if (url->indexed) {
+		return 1;
+	}
+	index = &url->index;
+	memset(index, 0, sizeof(Url_Storage_Index_T));
+	if (url_storage_index_restore(url)) {
+		url->indexed = 1;
+		return 1;
+	}
+	if (!url_storage_read_headers(url, index->header)) {
+		return 0;
+	}
+	for (i = 0; i < 2; i++) {
+		if (url_storage_check_crc(url, index->header[i].crc, url->base_sector + i, len[i])) {
+			index->valid |= (1 << i);
+		}
+		debug_value(index->valid & (1 << i));
+	}
+	if (index->valid == 3) {
+		index->sector = (index->header[0].counter < index->header[1].counter) ? 1 : 0;
+	} else {
+		index->sector = (index->valid == 2) ? 1 : 0;
+	}
+	memcpy(index->len, len[index->sector], sizeof(index->len));
+	url->indexed = 1;
+	url_storage_index_save(url);
+	return 1;
+}
+
+static uint8_t ICACHE_FLASH_ATTR url_storage_get_write_sector(Url_Storage_T* url, uint32_t* sector, uint32_t* counter) {
+	Url_Storage_Herader_T* header;
+	uint8_t* valid;
+	if (!url || !sector || !counter) {
+		return 0;
+	}
+	if (!url_storage_index(url)) {
+		return 0;
+	}
+	header = url->index.header;
+	valid = &url->index.valid;
+	if (!(*valid & 1) || !(*valid & 2)) {
+		if (!(*valid & 1) && !(*valid & 2)) {
 			*sector = 0;
 			*counter = 0;
 			return 1;
 		}
-		if (!valid[0]) {
+		if (!(*valid & 1)) {
 			*sector = 0;
 			*counter = header[1].counter + 1;
 			return 1;
@@ -84,34 +198,13 @@ static uint8_t ICACHE_FLASH_ATTR url_storage_get_write_sector(Url_Storage_T* url
 }
 
 static uint8_t ICACHE_FLASH_ATTR url_storage_get_read_sector(Url_Storage_T* url, uint32_t* sector) {
-	Url_Storage_Herader_T header[2];
-	uint32_t i;
-	uint8_t valid[2] = {0, 0};
 	if (!url || !sector) {
 		return 0;
 	}
-	for (i = 0; i < 2; i++) {
-		if (spi_flash_read((url->base_sector + i) * SPI_FLASH_SEC_SIZE, (uint32_t*)&header[i], sizeof(Url_Storage_Herader_T)) != SPI_FLASH_RESULT_OK) {
-			return 0;
-		}
-		valid[i] = url_storage_check_crc(url, header[i].crc, url->base_sector + i);
-	}
-	if (!valid[0] || !valid[1]) {
-		if (!valid[0] && !valid[1]) {
-			return 0;
-		}
-		if (!valid[0]) {
-			*sector = 1;
-			return 1;
-		}
-		*sector = 0;
-		return 1;
-	}
-	if (header[0].counter < header[1].counter) {
-		*sector = 1;
-		return 1;
+	if (!url_storage_index(url) || !url->index.valid) {
+		return 0;
 	}
-	*sector = 0;
+	*sector = url->index.sector;
 	return 1;
 }
 
@@ -149,6 +242,7 @@ uint8_t ICACHE_FLASH_ATTR url_storage_write(Url_Storage_T* url, Url_Storage_Type
 	}
 	debug_value(sector);
 	debug_value(counter);
+	url_storage_index_drop(url);
 	if (spi_flash_erase_sector(url->base_sector + sector) != SPI_FLASH_RESULT_OK) {
 		return 0;
 	}
@@ -201,11 +295,7 @@ uint8_t ICACHE_FLASH_ATTR url_storage_write(Url_Storage_T* url, Url_Storage_Type
 
 char* ICACHE_FLASH_ATTR url_storage_read(Url_Storage_T* url, Url_Storage_Type_T type) {
 	uint32_t sector = 0;
-	uint32_t in_range_start = 0;
-	uint32_t in_range_end = 0;
-	uint32_t len = 0;
-	uint32_t i;
-	uint8_t data[4];
+	uint32_t len;
 	char* res = NULL;
 	if (!url || (type >= __URL_TYPE_MAX)) {
 		return NULL;
@@ -213,28 +303,13 @@ char* ICACHE_FLASH_ATTR url_storage_read(Url_Storage_T* url, Url_Storage_Type_T
 	if (!url_storage_get_read_sector(url, &sector)) {
 		return NULL;
 	}
-	in_range_start = sizeof(Url_Storage_Herader_T) + ((uint32_t)URL_MAX_SIZE * type);
-	in_range_end = sizeof(Url_Storage_Herader_T) + ((uint32_t)URL_MAX_SIZE * (type + 1));
-	for (i = in_range_start; i < in_range_end; i++) {
-		if (!(i % sizeof(data))) {
-			if (spi_flash_read(((url->base_sector + sector) * SPI_FLASH_SEC_SIZE) + i, (uint32_t*)data, sizeof(data)) != SPI_FLASH_RESULT_OK) {
-				return 0;
-			}
-		}
-		if (((data[i % sizeof(data)]) != 0) &&
-			((data[i % sizeof(data)]) != 0xFF)) {
-			len++;
-		} else {
-			break;
-		}
-	}
-	if (!len) {
+	if (!(len = url->index.len[type])) {
 		return NULL;
 	}
 	if (!(res = calloc(1, len + 5))) {
 		return NULL;
 	}
-	if (spi_flash_read(((url->base_sector + sector) * SPI_FLASH_SEC_SIZE) + in_range_start, (uint32_t*)res, len) != SPI_FLASH_RESULT_OK) {
+	if (spi_flash_read(((url->base_sector + sector) * SPI_FLASH_SEC_SIZE) + sizeof(Url_Storage_Herader_T) + ((uint32_t)URL_MAX_SIZE * type), (uint32_t*)res, len) != SPI_FLASH_RESULT_OK) {
 		free(res);
 		return NULL;
 	}
@@ -242,10 +317,34 @@ char* ICACHE_FLASH_ATTR url_storage_read(Url_Storage_T* url, Url_Storage_Type_T
 	return res;
 }
 
+uint8_t ICACHE_FLASH_ATTR url_storage_counter(Url_Storage_T* url, uint32_t* counter) {
+	Url_Storage_Herader_T header;
+	uint32_t i;
+	uint8_t found = 0;
+	if (!url || !counter) {
+		return 0;
+	}
+	*counter = 0;
+	for (i = 0; i < 2; i++) {
+		if (spi_flash_read((url->base_sector + i) * SPI_FLASH_SEC_SIZE, (uint32_t*)&header, sizeof(Url_Storage_Herader_T)) != SPI_FLASH_RESULT_OK) {
+			return 0;
+		}
+		if (header.counter == 0xFFFFFFFF) {
+			continue;
+		}
+		if (!found || (header.counter > *counter)) {
+			*counter = header.counter;
+		}
+		found = 1;
+	}
+	return found;
+}
+
 void url_storage_erase_all(Url_Storage_T* storage) {
 	if (!storage) {
 		return;
 	}
+	url_storage_index_drop(storage);
 	spi_flash_erase_sector(storage->base_sector + 0);
 	spi_flash_erase_sector(storage->base_sector + 1);
 }
@@ -30,6 +30,7 @@
 #include <mem.h>
 #include <espconn.h>
 #include <ip_addr.h>
+#include <ping.h>
 #include "debug.h"
 #include "http.h"
 #include "crc.h"
@@ -37,6 +38,7 @@
 #include "collect.h"
 #include "peri.h"
 #include "IQS333.h"
+#include "peri_wheel.h"
 #include "store.h"
 #include "ns.h"
 #include "color.h"
@@ -50,10 +52,14 @@
 #include "queue.h"
 #include "timer.h"
 #include "url_storage.h"
+#include "action_plan.h"
 #include "version.h"
+#include "trace.h"
+#include "boot.h"
 
 extern struct Store_T store;
 Url_Storage_T url_storage;
+Action_Plan_T action_plan;
 Collect_T collect = NULL;
 Ns_T ns = NULL;
 char own_mac[13];
@@ -71,7 +77,10 @@ static struct Timer_T ap_blink;
 static struct Timer_T reset_blink;
 static struct Timer_T reset_timer;
 static struct Timer_T service_timer;
-static os_timer_t general_timer;
+#ifdef IQS
+static struct Timer_T wheel_timer;
+#endif
+static struct Timer_Group_T timers;
 static uint8_t reboot_req = 0;
 static uint8_t factory_restore = 0;
 static uint8_t service_mode = 0;
@@ -80,9 +89,13 @@ static uint8_t cold_start = 0;
 static uint8_t conn_limit = TRY_CONN_LIMIT;
 static uint8_t press = 0;
 static uint8_t hold = 0;
+static uint8_t conn_gate = 0;
+static uint32_t conn_gate_begin = 0;
+static struct ping_option conn_gate_ping;
 #ifdef IQS
 static uint8_t iqs_inhibit = 0;
 static uint8_t iqs_wheel_inhibit = 0;
+static Peri_Wheel_T iqs_wheel_motion;
 #endif
 
 static void ICACHE_FLASH_ATTR timer_run_task(os_timer_t* timer, void (*func)(void*), void* owner, uint32_t time);
@@ -121,7 +134,7 @@ static void ICACHE_FLASH_ATTR user_wakeup(uint8_t timer, uint8_t status) {
 			}
 		}
 		sleep_lock(SLEEP_WIFI);
-		timer_restart(&action_timer);
+		timer_notify(&action_timer);
 		timer_notify(&reconn_timer);
 	} else {
 		/*to any release required*/
@@ -131,6 +144,43 @@ static void ICACHE_FLASH_ATTR user_wakeup(uint8_t timer, uint8_t status) {
 }
 
 #ifdef IQS
+/*the flush timer stops once the motion is drained*/
+static uint16_t ICACHE_FLASH_ATTR iqs_wheel_take(void) {
+	uint16_t value = peri_wheel_take(&iqs_wheel_motion);
+	if (!peri_wheel_pending(&iqs_wheel_motion)) {
+		timer_stop(&wheel_timer);
+	}
+	return value;
+}
+
+static void ICACHE_FLASH_ATTR iqs_wheel_flush(void) {
+	uint32_t wait;
+	uint32_t pace;
+	if (!peri_wheel_pending(&iqs_wheel_motion)) {
+		timer_stop(&wheel_timer);
+		return;
+	}
+	if (factory_restore) {
+		iqs_wheel_take();
+		return;
+	}
+	pace = peri_wheel_pace(WHEEL_PACE_ADAPTIVE ? payload_rtt(payload) : 0);
+	wait = peri_wheel_wait(&iqs_wheel_motion, system_get_time(), pace);
+	if (payload_pending(payload) || wait) {
+		/*retry once paced, or poll until the request in flight is done*/
+		timer_set(&wheel_timer, (wait ? wait : WHEEL_MIN_INTERVAL) / 10 + 1);
+		timer_restart(&wheel_timer);
+		return;
+	}
+	payload_action(payload, own_mac, BTN_ACTION_WHEEL, peri_wheel_send(&iqs_wheel_motion, system_get_time()));
+	if (peri_wheel_pending(&iqs_wheel_motion)) {
+		timer_set(&wheel_timer, pace / 10 + 1);
+		timer_restart(&wheel_timer);
+	} else {
+		timer_stop(&wheel_timer);
+	}
+}
+
 static void ICACHE_FLASH_ATTR iqs_release(uint8_t busy) {
 	if (busy && !iqs_wheel_inhibit) {
 		peri_set_white(0);
@@ -144,7 +194,7 @@ static void ICACHE_FLASH_ATTR iqs_release(uint8_t busy) {
 	if (iqs_wheel_inhibit) {
 		debug_describe_P(COLOR_GREEN "@@@WHEEL" COLOR_END);
 		if (!factory_restore) {
-			payload_action(payload, own_mac, BTN_ACTION_WHEEL_FINAL, 0);
+			payload_action(payload, own_mac, BTN_ACTION_WHEEL_FINAL, iqs_wheel_take());
 		} else {
 			peri_set_white(0);
 		}
@@ -161,26 +211,10 @@ static void ICACHE_FLASH_ATTR iqs_press(void) {
 }
 
 static uint8_t ICACHE_FLASH_ATTR iqs_wheel(uint16_t count, int16_t diff) {
-	if (!iqs_inhibit && !hold && !press && !payload_size(payload)) {
-		uint16_t result;
-		count /= 16;
-		if (count > 255) {
-			count = 255;
-		}
-		diff *= -1;
-		diff /= 16;
-		if (diff > 127) {
-			diff = 127;
-		} else {
-			if (diff < -127) {
-				diff = -127;
-			}
-		}
-		result = (count << 8) | (diff & 0xFF);
-		if (!factory_restore) {
-			payload_action(payload, own_mac, BTN_ACTION_WHEEL, result);
-		}
+	if (!iqs_inhibit && !hold && !press) {
+		peri_wheel_add(&iqs_wheel_motion, count, diff);
 		iqs_wheel_inhibit = 1;
+		iqs_wheel_flush();
 		return 1;
 	}
 	return 0;
@@ -214,6 +248,7 @@ static void ICACHE_FLASH_ATTR user_factory_reset(void) {
 	rtc_erase_all();
 	store_erase();
 	url_storage_erase_all(&url_storage);
+	action_plan_erase(&action_plan);
 	system_restore();
 	sleep_restart();
 	sleep_unlock(SLEEP_CHARGE);
@@ -225,11 +260,13 @@ static void ICACHE_FLASH_ATTR user_factory_reset(void) {
 }
 
 
-static void btn_action(Btn_Action_T action) {
+/*raised from the peri clock, the action timer fires once to drain the queue*/
+static void ICACHE_FLASH_ATTR btn_action(Btn_Action_T action) {
 	if (!queue) {
 		return;
 	}
 	queue_write(queue, &action);
+	timer_notify(&action_timer);
 }
 
 static void ICACHE_FLASH_ATTR user_reset_timeout(void* owner) {
@@ -298,12 +335,17 @@ static uint8_t ICACHE_FLASH_ATTR btn_action_flash(Btn_Action_T action) {
 				user_factory_reset();
 			} else {
 				peri_set_white(1);
+				if (!factory_restore) {
+					payload_action(payload, own_mac, BTN_ACTION_PRESS, 0);
+				}
 			}
 #ifdef IQS
 			if (iqs_wheel_inhibit) {
 				iqs_wheel_cancel();
 				if (!factory_restore) {
-					payload_action(payload, own_mac, BTN_ACTION_WHEEL_FINAL, 0);
+					payload_action(payload, own_mac, BTN_ACTION_WHEEL_FINAL, iqs_wheel_take());
+				} else {
+					iqs_wheel_take();
 				}
 				iqs_wheel_inhibit = 0;
 			}
@@ -384,6 +426,7 @@ static void ICACHE_FLASH_ATTR timer_run_task(os_timer_t* timer, void (*func)(voi
 
 static void ICACHE_FLASH_ATTR user_wifi_disconn(void) {
 	debug_describe_P("!!!!DISCONN");
+	conn_gate = 0;
 	sleep_lock(SLEEP_WIFI);
 	sleep_unlock(SLEEP_DHCP);
 	sleep_unlock(SLEEP_DELAY);
@@ -447,6 +490,7 @@ static void ICACHE_FLASH_ATTR user_wifi_reconn(uint32_t time_ms) {
 
 static void ICACHE_FLASH_ATTR user_on_conn(void* owner) {
 	uint8_t is_charge = peri_is_charge();
+	trace_mark(TRACE_CONN);
 	if (timer_is_start(&ap_blink)) {
 		timer_stop(&ap_blink);
 		peri_lock_white(0);
@@ -473,9 +517,37 @@ static void ICACHE_FLASH_ATTR user_on_conn(void* owner) {
 	sleep_unlock(SLEEP_DELAY);
 }
 
+/*gateway answered, so the station can reach it without waiting for conn_timer*/
+static void ICACHE_FLASH_ATTR user_conn_gate_cb(void* arg, void* data) {
+	struct ping_resp* resp = data;
+	if (!conn_gate || !resp || resp->ping_err) {
+		return;
+	}
+	conn_gate = 0;
+	debug_printf("Conn gate open after %u us\n", system_get_time() - conn_gate_begin);
+	if (timer_is_start(&conn_timer)) {
+		timer_stop(&conn_timer);
+		user_on_conn(NULL);
+	}
+}
+
+static void ICACHE_FLASH_ATTR user_conn_gate(uint32_t gw) {
+	if (!gw) {
+		return;
+	}
+	memset(&conn_gate_ping, 0, sizeof(conn_gate_ping));
+	conn_gate_ping.count = 1;
+	conn_gate_ping.ip = gw;
+	conn_gate_ping.coarse_time = 1;
+	conn_gate_ping.recv_function = user_conn_gate_cb;
+	conn_gate_begin = system_get_time();
+	conn_gate = ping_start(&conn_gate_ping) ? 1 : 0;
+}
+
 static void ICACHE_FLASH_ATTR user_wifi_dhcp(void) {
 	struct ip_info info;
 	debug_describe_P("!!!!DHCP SUCCESS");
+	trace_mark(TRACE_DHCP);
 	timer_stop(&dhcp_timer);
 	memset(&info, 0, sizeof(info));
 	if (wifi_get_ip_info(STATION_IF, &info)) {
@@ -491,7 +563,9 @@ static void ICACHE_FLASH_ATTR user_wifi_dhcp(void) {
 	}
 		sleep_lock(SLEEP_DELAY);
 		if (peri_rst_reason() == REASON_DEEP_SLEEP_AWAKE) {
+			/*conn_timer stays as the fallback if the gateway does not answer*/
 			timer_restart(&conn_timer);
+			user_conn_gate(info.gw.addr);
 		} else {
 			timer_notify(&conn_timer);
 		}
@@ -583,6 +657,8 @@ static void ICACHE_FLASH_ATTR user_reboot_cb(void) {
 static uint8_t ICACHE_FLASH_ATTR user_sleep_final(uint8_t final) {
 	debug_printf(COLOR_MAGENTA "Sleep final %d\n" COLOR_END, (int)final);
 	if (final) {
+		/*kept alive connections live until the wake ends, not through idle gaps*/
+		ns_pool_close(ns);
 		user_reboot_cb();
 		wifi_inhibit();
 		user_timers_deinit();
@@ -610,6 +686,9 @@ static void ICACHE_FLASH_ATTR handle_rst(void) {
 void ICACHE_FLASH_ATTR user_rf_pre_init(void) {
 	system_phy_freq_trace_enable(0);
 	peri_pre_init();
+#ifndef IQS
+	sleep_wc_pre_init();
+#endif
 }
 
 /******************************************************************************
@@ -669,22 +748,12 @@ static void ICACHE_FLASH_ATTR user_print_version(const char* own_mac) {
 
 static void ICACHE_FLASH_ATTR user_timers_clk(void* owner) {
 #ifdef DEBUG_PRINTF
-	static uint32_t div = 0;
-	if (!div) {
+	static uint32_t heap_time = 0;
+	if ((system_get_time() - heap_time) >= 5000000) {
+		heap_time = system_get_time();
 		debug_value(system_get_free_heap_size());
 	}
-	div++;
-	div %= 500;
 #endif
-	timer_clk(&reconn_timer);
-	timer_clk(&conn_timer);
-	timer_clk(&action_timer);
-	timer_clk(&dhcp_timer);
-	timer_clk(&ap_blink);
-	timer_clk(&reset_blink);
-	timer_clk(&reset_timer);
-	timer_clk(&service_timer);
-
 	if (timer_event(&reconn_timer)) {
 		if (!periodic_wakeup && !store.bssid_enable) {
 			wifi_set_immediate_connect(1);
@@ -692,6 +761,10 @@ static void ICACHE_FLASH_ATTR user_timers_clk(void* owner) {
 		wifi_connect(NULL);
 	}
 	if (timer_event(&conn_timer)) {
+		if (conn_gate) {
+			conn_gate = 0;
+			debug_describe_P("Conn gate timeout");
+		}
 		user_on_conn(NULL);
 	}
 	if (timer_event(&action_timer)) {
@@ -699,6 +772,7 @@ static void ICACHE_FLASH_ATTR user_timers_clk(void* owner) {
 		while (queue_read(queue, &action)) {
 			btn_action_flash(action);
 		}
+		timer_stop(&action_timer);
 	}
 	if (timer_event(&dhcp_timer)) {
 		user_dhcp_timeout(NULL);
@@ -718,13 +792,17 @@ static void ICACHE_FLASH_ATTR user_timers_clk(void* owner) {
 		rgb_set_pattern(RGB_SERVICE_MODE, 0);
 		timer_restart(&service_timer);
 	}
+#ifdef IQS
+	if (timer_event(&wheel_timer)) {
+		iqs_wheel_flush();
+	}
+#endif
 }
 
 static void ICACHE_FLASH_ATTR user_timers_init(void) {
 	timer_init(&reconn_timer, 50, NULL, NULL);
 	timer_init(&conn_timer, 51, NULL, NULL);
 	timer_init(&action_timer, 1, NULL, NULL);
-	timer_repeat(&action_timer, 1);
 	timer_init(&dhcp_timer, DHCP_TIMEOUT / 10, NULL, NULL);
 	timer_init(&ap_blink, AP_BLINK_PERIOD / 10, NULL, NULL);
 	timer_repeat(&ap_blink, 1);
@@ -732,14 +810,27 @@ static void ICACHE_FLASH_ATTR user_timers_init(void) {
 	timer_repeat(&reset_blink, 1);
 	timer_init(&reset_timer, 500, NULL, NULL);
 	timer_init(&service_timer, 500, NULL, NULL);
+#ifdef IQS
+	timer_init(&wheel_timer, WHEEL_MIN_INTERVAL / 10, NULL, NULL);
+	peri_wheel_init(&iqs_wheel_motion);
+#endif
 
-	os_timer_disarm(&general_timer);
-	os_timer_setfn(&general_timer, user_timers_clk, NULL);
-	os_timer_arm(&general_timer, 10, 1);
+	/*one os_timer armed for the nearest deadline instead of a 10 ms poll*/
+	timer_group_init(&timers, 10, NULL, user_timers_clk);
+	timer_group_add(&timers, &reconn_timer);
+	timer_group_add(&timers, &conn_timer);
+	timer_group_add(&timers, &action_timer);
+	timer_group_add(&timers, &dhcp_timer);
+	timer_group_add(&timers, &ap_blink);
+	timer_group_add(&timers, &reset_blink);
+	timer_group_add(&timers, &reset_timer);
+	timer_group_add(&timers, &service_timer);
+#ifdef IQS
+	timer_group_add(&timers, &wheel_timer);
+#endif
 }
 
 static void ICACHE_FLASH_ATTR user_timers_deinit(void) {
-	os_timer_disarm(&general_timer);
 	timer_stop(&reconn_timer);
 	timer_stop(&conn_timer);
 	timer_stop(&action_timer);
@@ -748,13 +839,23 @@ static void ICACHE_FLASH_ATTR user_timers_deinit(void) {
 	timer_stop(&reset_blink);
 	timer_stop(&reset_timer);
 	timer_stop(&service_timer);
+#ifdef IQS
+	timer_stop(&wheel_timer);
+#endif
+	timer_group_stop(&timers);
 }
 
 void ICACHE_FLASH_ATTR user_init(void) {
 	uint8_t mac[6];
+#ifndef IQS
+	if (sleep_wc_pass()) {
+		return;
+	}
+#endif
 	handle_rst();
 	hold = peri_hold_on_start();
-	url_storage_init(&url_storage, 0xF8);
+	url_storage_init(&url_storage, URL_STORAGE_SECTOR);
+	action_plan_init(&action_plan, ACTION_PLAN_SECTOR);
 	store_init();
 	debug_describe_P("Program start...");
 	debug_value(hold);
@@ -807,7 +908,7 @@ void ICACHE_FLASH_ATTR user_init(void) {
 		sleep_reset();
 		sleep_lock(SLEEP_WIFI);
 		timer_restart(&reconn_timer);
-		timer_restart(&action_timer);
+		timer_notify(&action_timer);
 	} else {
 #ifndef IQS
 		user_wakeup(peri_rst_reason() == REASON_DEEP_SLEEP_AWAKE, 0);
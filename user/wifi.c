@@ -32,6 +32,8 @@
 #include "version.h"
 #include "rgb.h"
 #include "utils.h"
+#include "notify.h"
+#include "trace.h"
 
 extern struct Store_T store;
 extern char own_mac[13];
@@ -272,21 +274,21 @@ error:
 	http_req_close(scan_req);
 }
 
-static Parser_State_T ICACHE_FLASH_ATTR wifi_scan_exec(Buffer_T* buffer, Item_T* args, Value_T query, Buffer_T content) {
+static Parser_State_T ICACHE_FLASH_ATTR wifi_scan_start(Value_T ssid, Value_T callback) {
 	debug_describe_P("Scan exec");
 	if (scan_req) {
 		return Parser_State_Internal_Server_Error_500;
 	}
 	memset(scan_ssid, 0, sizeof(scan_ssid));
 	memset(jsonp_callback, 0, sizeof(jsonp_callback));
-	if (query && query[0].present) {
-		strncpy(scan_ssid, query[0].string_value, sizeof(scan_ssid) - 1);
+	if (ssid && ssid->present) {
+		strncpy(scan_ssid, ssid->string_value, sizeof(scan_ssid) - 1);
 		debug_printf("Scan for: %s" CRLF, scan_ssid);
 	} else {
 		debug_describe_P("SSID not present");
 	}
-	if (query && query[1].present) {
-		strncpy(jsonp_callback, query[1].string_value, sizeof(jsonp_callback) - 1);
+	if (callback && callback->present) {
+		strncpy(jsonp_callback, callback->string_value, sizeof(jsonp_callback) - 1);
 		debug_printf("JPCB: %s" CRLF, jsonp_callback);
 	} else {
 		debug_describe_P("JSONP callback undefine");
@@ -294,6 +296,15 @@ static Parser_State_T ICACHE_FLASH_ATTR wifi_scan_exec(Buffer_T* buffer, Item_T*
 	return Parser_State_OK_200;
 }
 
+/*query holds as many items as the page has rules, the json page only the ssid*/
+static Parser_State_T ICACHE_FLASH_ATTR wifi_scan_exec(Buffer_T* buffer, Item_T* args, Value_T query, Buffer_T content) {
+	return wifi_scan_start(query, NULL);
+}
+
+static Parser_State_T ICACHE_FLASH_ATTR wifi_scanp_exec(Buffer_T* buffer, Item_T* args, Value_T query, Buffer_T content) {
+	return wifi_scan_start(query, query ? &query[1] : NULL);
+}
+
 static void ICACHE_FLASH_ATTR wifi_scan_run(Http_Request_T req) {
 	static struct scan_config scan_conf;
 	if (scan_req) {
@@ -363,7 +374,7 @@ static const struct Http_Page_T wifi_scanp_page ICACHE_RODATA_ATTR = {
 	.path = "api",
 	.content = NULL,
 	.type = "application/javascript",
-	.exec = wifi_scan_exec,
+	.exec = wifi_scanp_exec,
 	.header_cb = wifi_scan_run,
 	.close_cb = wifi_scan_close,
 	.send_cb = wifi_scan_send,
@@ -380,7 +391,6 @@ static const struct Http_Page_T wifi_scanp_page ICACHE_RODATA_ATTR = {
 
 static Parser_State_T ICACHE_FLASH_ATTR wifi_connect_exec(Buffer_T* buffer, Item_T* args, Value_T query_path, Buffer_T content) {
 	struct Value_T query[ARRAY_SIZE(device_network_rule)];
-	Json_T json = NULL;
 	config_set = 0;
 	if (manual_connect || new_station) {
 		goto error;
@@ -388,10 +398,7 @@ static Parser_State_T ICACHE_FLASH_ATTR wifi_connect_exec(Buffer_T* buffer, Item
 	if (!content || !buffer_size(content)) {
 		goto error;
 	}
-	if (!(json = json_parse(buffer_string(content), device_network_rule, ARRAY_SIZE(device_network_rule)))) {
-		goto error;
-	}
-	if (!json_to_values(json, query)) {
+	if (!json_parse_values(buffer_string(content), device_network_rule, ARRAY_SIZE(device_network_rule), query)) {
 		goto error;
 	}
 	if (!query[0].present || !query[1].present) {
@@ -413,14 +420,10 @@ static Parser_State_T ICACHE_FLASH_ATTR wifi_connect_exec(Buffer_T* buffer, Item
 			goto error;
 		}
 	}
-	json_delete(json);
 	config_set = 1;
 	return Parser_State_OK_200;
 error:
 	config_set = 0;
-	if (json) {
-		json_delete(json);
-	}
 	return Parser_State_Bad_Request_400;
 }
 
@@ -459,10 +462,13 @@ static const struct Http_Page_T wifi_connect_page ICACHE_RODATA_ATTR = {
 	.panel = 1
 };
 
-static Parser_State_T ICACHE_FLASH_ATTR wifi_info_exec(Buffer_T* buffer, Item_T* args, Value_T query_path, Buffer_T content) {
+static Parser_State_T ICACHE_FLASH_ATTR wifi_info_exec(Json_T* json, Item_T* args, Value_T query_path, Buffer_T content) {
 	WiFi_Config_T config;
 	char ssid[33];
+	uint32_t handshakes;
+	uint32_t reused;
 	Json_T resp;
+	Json_T tls;
 	if (!(resp = json_new())) {
 		return Parser_State_Internal_Server_Error_500;
 	}
@@ -495,17 +501,21 @@ static Parser_State_T ICACHE_FLASH_ATTR wifi_info_exec(Buffer_T* buffer, Item_T*
 		json_add_bool(resp, "connected", 0);
 	}
 	json_add_int(resp, "signal", wifi_dbm_to_percentage(wifi_station_get_rssi()));
-	if ((*buffer = json_to_buffer(resp))) {
-		return Parser_State_OK_200;
+	notify_tls_stats(&handshakes, &reused);
+	if ((tls = json_new())) {
+		json_add_int(tls, "handshakes", handshakes);
+		json_add_int(tls, "reused", reused);
+		json_add_obj(resp, "tls", tls);
 	}
-	return Parser_State_Internal_Server_Error_500;
+	*json = resp;
+	return Parser_State_OK_200;
 }
 
 static const struct Http_Page_T wifi_info_page ICACHE_RODATA_ATTR = {
 	.path = "api",
 	.content = NULL,
 	.type = "application/json",
-	.exec = wifi_info_exec,
+	.exec_json = wifi_info_exec,
 	.close_cb = NULL,
 	.len = 0,
 	.dynamic = 1,
@@ -920,6 +930,7 @@ static void ICACHE_FLASH_ATTR wifi_handle_event_cb(System_Event_t* evt) {
 						evt->event_info.connected.ssid,
 						(int)evt->event_info.connected.channel,
 						MAC2STR(evt->event_info.connected.bssid));
+			trace_mark(TRACE_WIFI);
 			wifi_station_set_reconnect_policy(0);
 			if (wifi_station_get_auto_connect()) {
 				wifi_station_set_auto_connect(0);